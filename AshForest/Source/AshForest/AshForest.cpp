@@ -2,5 +2,131 @@
 
 #include "AshForest.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/UObjectGlobals.h"
+#include "AshForestGameMode.h"
+#include "AshForestDebugDraw.h"
+#include "AshForestMemory.h"
+#include "AshForestFrameScratch.h"
+#include "AshForestDamageQueue.h"
+#include "AshForestJobQueue.h"
+#include "AshForestPlayerVolumes.h"
+#include "AshForestUnstableFloor.h"
+#include "AshForestSaveSystem.h"
+#include "AshForestInterfaceDispatch.h"
+#include "Misc/CoreDelegates.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, AshForest, "AshForest" );
+IMPLEMENT_PRIMARY_GAME_MODULE( FAshForestModule, AshForest, "AshForest" );
+
+DEFINE_LOG_CATEGORY(LogAshForest);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Time To First Playable (s)"), STAT_AshTimeToFirstPlayable, STATGROUP_AshForest);
+
+FAshForestModule::FAshForestModule()
+	: MapLoadStartTime(0.0), bWaitingForFirstPlayable(false), bHadFirstPlayable(false)
+{
+}
+
+void FAshForestModule::StartupModule()
+{
+	FDefaultGameModuleImpl::StartupModule();
+
+	UAshForestMemoryLibrary::RegisterLLMTags();
+
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FAshForestModule::OnWorldPostActorTick);
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddRaw(this, &FAshForestModule::OnPreLoadMap);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FAshForestModule::OnEndFrame);
+	PostWorldInitializationHandle = FWorldDelegates::OnPostWorldInitialization.AddLambda([](UWorld* World, const UWorld::InitializationValues IVS)
+	{
+		FAshInterfaceDispatch::ClearCache();
+	});
+
+#if WITH_EDITOR
+	ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([](const TMap<UObject*, UObject*>& ReplacementMap)
+	{
+		FAshInterfaceDispatch::ClearCache();
+	});
+#endif
+}
+
+void FAshForestModule::ShutdownModule()
+{
+	FAshSaveSystem::Get().Flush();
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FWorldDelegates::OnPostWorldInitialization.Remove(PostWorldInitializationHandle);
+
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+#endif
+
+	FDefaultGameModuleImpl::ShutdownModule();
+}
+
+void FAshForestModule::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (!World || !World->IsGameWorld())
+		return;
+
+	//AS: Player volumes see where movement left the player this frame
+	FAshPlayerVolumes::Get().Update(World);
+	FAshUnstableFloors::Get().Update(World, DeltaSeconds);
+
+	//AS: Damage first so deaths and lock-on reselection are settled before anything below looks at the world
+	FAshDamageQueue::Get().Resolve(World);
+	FAshJobQueue::Get().Drain(World);
+
+	//AS: After the job queue, which is where checkpoint saves are requested
+	FAshSaveSystem::Get().Update(World);
+
+	if (bWaitingForFirstPlayable)
+		CheckFirstPlayableFrame(World);
+
+#if ASH_DEBUG_DRAW_ENABLED
+	FAshDebugDraw::Render(World, DeltaSeconds);
+#endif
+}
+
+void FAshForestModule::OnEndFrame()
+{
+	FAshFrameScratch::Get().EndFrame();
+}
+
+void FAshForestModule::OnPreLoadMap(const FString& MapName)
+{
+	LoadingMapName = MapName;
+	MapLoadStartTime = FPlatformTime::Seconds();
+	bWaitingForFirstPlayable = true;
+
+	//AS: Read the save while the map itself loads, it's applied once the new world has a player
+	FAshSaveSystem::Get().BeginLoad(MapName);
+}
+
+void FAshForestModule::CheckFirstPlayableFrame(UWorld* World)
+{
+	auto playerController = World->GetFirstPlayerController();
+	if (!playerController || !playerController->GetPawn())
+		return;
+
+	auto gameMode = World->GetAuthGameMode<AAshForestGameMode>();
+	if (gameMode && !gameMode->HasFinishedPreloading())
+		return;
+
+	bWaitingForFirstPlayable = false;
+
+	const double now = FPlatformTime::Seconds();
+	const double sinceMapLoad = now - MapLoadStartTime;
+
+	SET_FLOAT_STAT(STAT_AshTimeToFirstPlayable, sinceMapLoad);
+
+	//AS: The very first map also reports time since launch, which is what cold startup comparisons want
+	if (!bHadFirstPlayable)
+		UE_LOG(LogAshForest, Log, TEXT("First playable frame for %s: %.3fs after map load started, %.3fs after launch"), *LoadingMapName, sinceMapLoad, now - GStartTime);
+	else
+		UE_LOG(LogAshForest, Log, TEXT("First playable frame for %s: %.3fs after map load started"), *LoadingMapName, sinceMapLoad);
+
+	bHadFirstPlayable = true;
+}
@@ -3,3 +3,42 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+#include "Modules/ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogAshForest, Log, All);
+DECLARE_STATS_GROUP(TEXT("AshForest"), STATGROUP_AshForest, STATCAT_Advanced);
+
+class UWorld;
+
+class FAshForestModule : public FDefaultGameModuleImpl
+{
+public:
+	FAshForestModule();
+
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	/** Single per-world hook for gameplay systems that need to run once after all actors have ticked */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** Time to first playable frame: from the start of a map load until a frame has a possessed pawn and the game mode's preloads are done */
+	void OnPreLoadMap(const FString& MapName);
+	void CheckFirstPlayableFrame(UWorld* World);
+
+	void OnEndFrame();
+
+	FDelegateHandle WorldPostActorTickHandle;
+
+	/** Class caches keyed by UClass go stale when a Blueprint is recompiled, they're dropped per world and on reinstancing */
+	FDelegateHandle PostWorldInitializationHandle;
+	FDelegateHandle ObjectsReplacedHandle;
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle EndFrameHandle;
+
+	FString LoadingMapName;
+	double MapLoadStartTime;
+	bool bWaitingForFirstPlayable;
+	bool bHadFirstPlayable;
+};
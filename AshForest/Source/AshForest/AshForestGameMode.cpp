@@ -1,15 +1,90 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "AshForestGameMode.h"
+#include "AshForest.h"
 #include "AshForestCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "AshForestPreloadList.h"
+#include "Engine/AssetManager.h"
 
 AAshForestGameMode::AAshForestGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPersonCPP/Blueprints/ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != NULL)
-	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
-	}
+	//AS: SoftDefaultPawnClass is set in the game mode Blueprint, DefaultPawnClass is used while it's null
+	PreloadStartTime = 0.0;
+	bPreloadFinished = false;
+	bSoftDefaultPawnClassFailed = false;
+}
+
+void AAshForestGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	PreloadStartTime = FPlatformTime::Seconds();
+	bPreloadFinished = false;
+
+	//AS: The pawn and the list itself go first, the list's contents follow once we know what they are
+	TArray<FSoftObjectPath> paths;
+
+	if (!SoftDefaultPawnClass.IsNull())
+		paths.Add(SoftDefaultPawnClass.ToSoftObjectPath());
+
+	if (!PreloadList.IsNull())
+		paths.Add(PreloadList.ToSoftObjectPath());
+
+	if (paths.Num() > 0)
+		PreloadListHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(paths, FStreamableDelegate::CreateUObject(this, &AAshForestGameMode::OnPreloadListLoaded), FStreamableManager::AsyncLoadHighPriority);
+	else
+		OnPreloadAssetsLoaded();
+}
+
+void AAshForestGameMode::OnPreloadListLoaded()
+{
+	TArray<FSoftObjectPath> paths;
+
+	if (auto list = PreloadList.Get())
+		list->GatherAssetPaths(paths);
+
+	if (paths.Num() > 0)
+		PreloadAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(paths, FStreamableDelegate::CreateUObject(this, &AAshForestGameMode::OnPreloadAssetsLoaded), FStreamableManager::AsyncLoadHighPriority);
+	else
+		OnPreloadAssetsLoaded();
+}
+
+void AAshForestGameMode::OnPreloadAssetsLoaded()
+{
+	bPreloadFinished = true;
+
+	UE_LOG(LogAshForest, Log, TEXT("Preload finished in %.3fs (%d assets)"), FPlatformTime::Seconds() - PreloadStartTime, PreloadList.Get() ? PreloadList.Get()->Classes.Num() + PreloadList.Get()->Assets.Num() : 0);
+}
+
+UClass* AAshForestGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	if (SoftDefaultPawnClass.IsNull() || bSoftDefaultPawnClassFailed)
+		return Super::GetDefaultPawnClassForController_Implementation(InController);
+
+	//AS: Normally resident by the time the first player spawns, this only blocks if the preload was too slow
+	if (SoftDefaultPawnClass.IsPending())
+		UE_LOG(LogAshForest, Warning, TEXT("Default pawn %s not preloaded yet, loading synchronously"), *SoftDefaultPawnClass.ToString());
+
+	if (UClass* pawnClass = SoftDefaultPawnClass.LoadSynchronous())
+		return pawnClass;
+
+	//AS: A bad path in the Blueprint, report it once and stop retrying the load for every spawn
+	UE_LOG(LogAshForest, Error, TEXT("%s: SoftDefaultPawnClass %s failed to load, using DefaultPawnClass instead"), *GetClass()->GetName(), *SoftDefaultPawnClass.ToString());
+	bSoftDefaultPawnClassFailed = true;
+
+	return Super::GetDefaultPawnClassForController_Implementation(InController);
+}
+
+void AAshForestGameMode::CaptureCheckpointSnapshot()
+{
+	CheckpointSnapshot.Capture(GetWorld());
+}
+
+bool AAshForestGameMode::RestoreCheckpointSnapshot()
+{
+	if (!CheckpointSnapshot.IsValid())
+		return false;
+
+	CheckpointSnapshot.Restore(GetWorld());
+	return true;
 }
@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "Engine/StreamableManager.h"
+#include "AshForestLevelSnapshot.h"
 #include "AshForestGameMode.generated.h"
 
+class UAshForestPreloadList;
+
 UCLASS(minimalapi)
 class AAshForestGameMode : public AGameModeBase
 {
@@ -13,4 +17,43 @@ class AAshForestGameMode : public AGameModeBase
 
 public:
 	AAshForestGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+	/** Records the level state to go back to on retry, called when the player reaches a new checkpoint */
+	UFUNCTION(BlueprintCallable, Category = "Respawning")
+		void CaptureCheckpointSnapshot();
+
+	/** Puts the level back to how it was at the latest checkpoint, returns false if nothing has been captured yet */
+	UFUNCTION(BlueprintCallable, Category = "Respawning")
+		bool RestoreCheckpointSnapshot();
+
+	/** The save system copies this when writing progress and fills it back in when loading it */
+	FORCEINLINE FAshForestLevelSnapshot& GetCheckpointSnapshot() { return CheckpointSnapshot; }
+
+	UFUNCTION(BlueprintPure, Category = "Preloading") FORCEINLINE
+		bool HasFinishedPreloading() const { return bPreloadFinished; };
+
+protected:
+	FAshForestLevelSnapshot CheckpointSnapshot;
+
+	/** Soft replacement for DefaultPawnClass, streamed in with the preload list instead of being loaded with the game mode. Set in Blueprint, DefaultPawnClass is used while null */
+	UPROPERTY(EditDefaultsOnly, Category = "Classes")
+		TSoftClassPtr<APawn> SoftDefaultPawnClass;
+
+	/** Set once SoftDefaultPawnClass failed to load, so the error is reported once and later spawns go straight to DefaultPawnClass */
+	bool bSoftDefaultPawnClassFailed;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Preloading")
+		TSoftObjectPtr<UAshForestPreloadList> PreloadList;
+
+	TSharedPtr<FStreamableHandle> PreloadListHandle;
+	TSharedPtr<FStreamableHandle> PreloadAssetsHandle;
+
+	double PreloadStartTime;
+	bool bPreloadFinished;
+
+	void OnPreloadListLoaded();
+	void OnPreloadAssetsLoaded();
 };
@@ -1,6 +1,9 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AshForestActivateableActor.h"
+#include "AshForestNetPolicy.h"
+#include "AshForestMoverComponent.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 AAshForestActivateableActor::AAshForestActivateableActor()
@@ -10,6 +13,11 @@ AAshForestActivateableActor::AAshForestActivateableActor()
 
 	RootComp = CreateOptionalDefaultSubobject<USceneComponent>("RootComponent");
 	if (RootComp) RootComponent = RootComp;
+
+	Mover = NULL;
+
+	bReplicates = true;
+	FAshNetPolicy::InitStaticActor(this);
 }
 
 // Called when the game starts or when spawned
@@ -17,6 +25,28 @@ void AAshForestActivateableActor::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	FAshNetPolicy::ApplyLevelRelevancy(this);
+
+	//AS: Opt-in, only Blueprints that dropped their own Timeline add a mover
+	Mover = FindComponentByClass<UAshForestMoverComponent>();
+}
+
+void AAshForestActivateableActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AAshForestActivateableActor, bIsActivated);
+}
+
+bool AAshForestActivateableActor::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	FAshNetPolicy::NoteConsidered(this);
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+void AAshForestActivateableActor::OnRep_IsActivated()
+{
+	OnActivationStateReplicated(bIsActivated);
 }
 
 bool AAshForestActivateableActor::AllowsActivationState_Implementation(const AActor* ByActivator, const bool NewActivationState)
@@ -26,16 +56,45 @@ bool AAshForestActivateableActor::AllowsActivationState_Implementation(const AAc
 
 void AAshForestActivateableActor::Activate_Implementation(const AActor* Activator)
 {
+	FAshNetPolicy::Flush(this);
+	bIsActivated = true;
 
+	if (Mover && Mover->bDriveFromActivation)
+		Mover->Open();
 }
 
 void AAshForestActivateableActor::Deactivate_Implementation(const AActor* Deactivator)
 {
+	FAshNetPolicy::Flush(this);
+	bIsActivated = false;
 
+	if (Mover && Mover->bDriveFromActivation)
+		Mover->Close();
 }
 
 void AAshForestActivateableActor::ToggleActive_Implementation(const AActor* Activator)
 {
+	if (bIsActivated)
+		IActivateableInterface::Execute_Deactivate(this, Activator);
+	else
+		IActivateableInterface::Execute_Activate(this, Activator);
+}
 
+void AAshForestActivateableActor::OnActivationStateRestored_Implementation(const bool bActivated)
+{
+	if (Mover && Mover->bDriveFromActivation)
+		Mover->SnapTo(bActivated);
 }
 
+
+void AAshForestActivateableActor::OnActivationStateReplicated_Implementation(const bool bActivated)
+{
+	//AS: Clients see the same move the server makes, snapping is only for checkpoint restores
+	if (Mover && Mover->bDriveFromActivation)
+	{
+		if (bActivated)
+			Mover->Open();
+		else
+			Mover->Close();
+	}
+}
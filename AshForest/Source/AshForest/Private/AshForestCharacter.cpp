@@ -8,17 +8,38 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
-#include "DrawDebugHelpers.h"
 #include "Engine.h"
+#include "AshForestDebugDraw.h"
+#include "AshForestMemory.h"
 #include "AshForestCheckpoint.h"
 #include "AshForestProjectile.h"
 #include "FocusPointTrigger.h"
+#include "AshForestGameMode.h"
+#include "AshForestInterfaceDispatch.h"
+#include "AshForestFrameScratch.h"
+#include "AshForestDamageQueue.h"
+#include "AshForestJobQueue.h"
+#include "AshForestSaveSystem.h"
+#include "AshForestMoverComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "GameFramework/GameStateBase.h"
+
+static TAutoConsoleVariable<int32> CVarAshInputLatency(
+	TEXT("ash.InputLatency"),
+	0,
+	TEXT("1 logs the frames and milliseconds from each dash press until the movement component changes velocity"),
+	ECVF_Cheat);
+
+static const float CharacterRewindInterval = 1.f / 30.f;
 
 //////////////////////////////////////////////////////////////////////////
 // AAshForestCharacter
 
-AAshForestCharacter::AAshForestCharacter()
+AAshForestCharacter::AAshForestCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UAshForestCharacterMovement>(ACharacter::CharacterMovementComponentName))
 {
+	ASH_LLM_SCOPE(CHARACTERS);
+
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
 	PrimaryActorTick.SetTickFunctionEnable(true);
@@ -65,6 +86,10 @@ AAshForestCharacter::AAshForestCharacter()
 	DashSpeed = 9000.f;
 	DashDuration_MAX = .3f;
 	DashCharges_MAX = 6;
+	MaxDeflectRewindTime = .3f;
+	DeflectRewindTolerance = 50.f;
+	ReplicatedMoveState = EAshCustomMoveState::EAshMove_NONE;
+	ReplicatedDashState = 0;
 	DashChargeReloadInterval = 1.f;
 	AllowedDashesWhileFalling = 1;
 	DashDistance_MAX = 750.f;
@@ -89,6 +114,12 @@ AAshForestCharacter::AAshForestCharacter()
 	LockedOnInterpCameraSocketOffsetSpeed_IN = 2.5f;
 	LockedOnInterpCameraSocketOffsetSpeed_OUT = 4.f;
 	AllowSwitchLockOnTargetInterval = .5f;
+	LockOnVisibility_MaxAge = .25f;
+	LockOnVisibility_MoveTolerance = 50.f;
+	LockOnVisibility_RefreshPerFrame = 2;
+	LockOnRing_RefreshInterval = .25f;
+	LastLockOnRingRefreshTime = -1.f;
+	bHasPendingKilledTarget = false;
 
 	CameraArmLength_MAX = 500.f;
 	CameraArmLengthInterpSpeeds.Set(5.f, 2.f);
@@ -103,6 +134,13 @@ AAshForestCharacter::AAshForestCharacter()
 	MaxHealth = 100.f;
 
 	LatestCheckpointIndex = -1;
+
+	bForcingDebugDraw = false;
+
+	InputBufferWindow = .15f;
+	LatencyPressTime = 0.0;
+	LatencyPressFrame = 0;
+	bMeasuringInputLatency = false;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -117,11 +155,10 @@ void AAshForestCharacter::SetupPlayerInputComponent(class UInputComponent* Playe
 
 	//AS: Custom Actions
 	PlayerInputComponent->BindAction("Dash", IE_Pressed, this, &AAshForestCharacter::OnDashPressed);
-	PlayerInputComponent->BindAction("Dash", IE_Released, this, &AAshForestCharacter::OnDashReleased);
 	PlayerInputComponent->BindAction("LockOn", IE_Pressed, this, &AAshForestCharacter::OnLockOnPressed);
-	PlayerInputComponent->BindAction("LockOn", IE_Released, this, &AAshForestCharacter::OnLockOnReleased);
 	PlayerInputComponent->BindAction("SwitchTarget_Left", IE_Pressed, this, &AAshForestCharacter::SwitchLockOnTarget_Left);
 	PlayerInputComponent->BindAction("SwitchTarget_Right", IE_Pressed, this, &AAshForestCharacter::SwitchLockOnTarget_Right);
+	PlayerInputComponent->BindAction("CycleTarget", IE_Pressed, this, &AAshForestCharacter::CycleLockOnTarget);
 	PlayerInputComponent->BindAction("Focus", IE_Pressed, this, &AAshForestCharacter::StartFocusing);
 	PlayerInputComponent->BindAction("Focus", IE_Released, this, &AAshForestCharacter::StopFocusing);
 
@@ -219,9 +256,138 @@ void AAshForestCharacter::OnMouseWheelScroll(float Rate)
 	}
 }
 
+FVector AAshForestCharacter::SampleMoveInputDirection() const
+{
+	if (!InputComponent)
+		return FVector::ZeroVector;
+
+	const float forward = InputComponent->GetAxisValue(TEXT("MoveForward"));
+	const float right = InputComponent->GetAxisValue(TEXT("MoveRight"));
+
+	if (forward == 0.f && right == 0.f)
+		return FVector::ZeroVector;
+
+	//AS: Same basis as MoveForward/MoveRight
+	FRotator rotation = GetControlRotation();
+
+	if (LockOnTarget_Current != NULL)
+		rotation = (LockOnTarget_Current->GetComponentLocation() - GetActorLocation()).GetSafeNormal2D().Rotation();
+
+	const FRotationMatrix yawMatrix(FRotator(0, rotation.Yaw, 0));
+	return ((yawMatrix.GetUnitAxis(EAxis::X) * forward) + (yawMatrix.GetUnitAxis(EAxis::Y) * right)).GetSafeNormal();
+}
+
+void AAshForestCharacter::BufferAction(const EAshInputAction::Type Action, const int32 Dir /*= 0*/)
+{
+	auto& action = BufferedActions[BufferedActions.AddDefaulted()];
+	action.Action = Action;
+	action.PressTime = FPlatformTime::Seconds();
+	action.PressFrame = GFrameCounter;
+	action.MoveInputDir = SampleMoveInputDirection();
+	action.Dir = Dir;
+
+	if (Action == EAshInputAction::EAshInput_DASH && CVarAshInputLatency.GetValueOnGameThread() > 0 && !bMeasuringInputLatency)
+	{
+		bMeasuringInputLatency = true;
+		LatencyPressTime = action.PressTime;
+		LatencyPressFrame = action.PressFrame;
+		LatencyPressVelocity = GetVelocity();
+
+		OnCharacterMovementUpdated.AddUniqueDynamic(this, &AAshForestCharacter::OnMovementUpdated_MeasureLatency);
+	}
+
+	ProcessBufferedActions();
+}
+
+void AAshForestCharacter::ProcessBufferedActions()
+{
+	const double now = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < BufferedActions.Num(); i++)
+	{
+		const FAshBufferedAction action = BufferedActions[i];
+		bool bConsumed = true;
+
+		switch (action.Action)
+		{
+		case EAshInputAction::EAshInput_DASH:
+			bConsumed = TryDashInDirection(action.MoveInputDir);
+			break;
+		case EAshInputAction::EAshInput_LOCK_ON:
+			TryLockOn();
+			break;
+		case EAshInputAction::EAshInput_SWITCH_TARGET:
+			bConsumed = !IsLockedOn() || TrySwitchLockOnTarget((float)action.Dir);
+			break;
+		default:
+			break;
+		}
+
+		if (bConsumed || now - action.PressTime > InputBufferWindow)
+			BufferedActions.RemoveAt(i--, 1, false);
+	}
+
+	bWantsToDash = BufferedActions.ContainsByPredicate([](const FAshBufferedAction& Action) { return Action.Action == EAshInputAction::EAshInput_DASH; });
+}
+
+void AAshForestCharacter::OnMovementUpdated_MeasureLatency(float DeltaSeconds, FVector OldLocation, FVector OldVelocity)
+{
+	const uint64 frames = GFrameCounter - LatencyPressFrame;
+	const bool bChanged = !GetVelocity().Equals(LatencyPressVelocity, 1.f);
+
+	if (!bChanged && frames < 30)
+		return;
+
+	if (bChanged)
+		UE_LOG(LogAshForest, Log, TEXT("Input latency: dash press to velocity change %llu frames, %.2fms"), frames, (FPlatformTime::Seconds() - LatencyPressTime) * 1000.0);
+	else
+		UE_LOG(LogAshForest, Log, TEXT("Input latency: dash press didn't change velocity within %llu frames (cooldown or no charges)"), frames);
+
+	bMeasuringInputLatency = false;
+	OnCharacterMovementUpdated.RemoveDynamic(this, &AAshForestCharacter::OnMovementUpdated_MeasureLatency);
+}
+
+void AAshForestCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	//AS: Controller (input) -> pawn -> movement within one frame, so presses and anything Tick starts move us the same frame.
+	//AS: Runs wherever the pawn is locally controlled (client, listen server, standalone), a remote player's controller has no input to wait for
+	SetInputTickController(IsLocallyControlled() ? GetController() : NULL);
+}
+
+void AAshForestCharacter::UnPossessed()
+{
+	SetInputTickController(NULL);
+
+	Super::UnPossessed();
+}
+
+void AAshForestCharacter::SetInputTickController(AController* NewController)
+{
+	if (InputTickController.Get() == NewController)
+		return;
+
+	//AS: Locally controlled movement also waits for the world's movers, so a platform we stand on has already moved this frame
+	if (InputTickController.IsValid())
+	{
+		RemoveTickPrerequisiteActor(InputTickController.Get());
+		FAshMovers::Get().RemoveRider(GetCharacterMovement());
+	}
+
+	InputTickController = NewController;
+
+	if (NewController)
+	{
+		AddTickPrerequisiteActor(NewController);
+		FAshMovers::Get().AddRider(GetCharacterMovement());
+	}
+}
+
 void AAshForestCharacter::BeginPlay() 
 {
 	DashCharges_Current = DashCharges_MAX;
+	OnDashChargesChanged.Broadcast(DashCharges_Current, DashCharges_MAX);
 
 	MyInitialMovementVars.InitialGravityScale = GetCharacterMovement()->GravityScale;
 	MyInitialMovementVars.InitialGroundFriction = GetCharacterMovement()->GroundFriction;
@@ -229,6 +395,9 @@ void AAshForestCharacter::BeginPlay()
 	MyInitialMovementVars.InitialFallingLateralFriction = .05f;//GetCharacterMovement()->FallingLateralFriction;
 	MyInitialMovementVars.InitialAirControl = GetCharacterMovement()->AirControl;
 
+	//AS: Dashes and wall jumps no longer touch the movement settings (see UAshForestCharacterMovement), so this is set once
+	GetCharacterMovement()->FallingLateralFriction = MyInitialMovementVars.InitialFallingLateralFriction;
+
 	CameraArmLength_Default = CameraBoom->TargetArmLength;
 
 	if (GetController())
@@ -243,33 +412,82 @@ void AAshForestCharacter::BeginPlay()
 
 	ResetMeshTransform();
 
+	LockOnVisibility.MaxAge = LockOnVisibility_MaxAge;
+	LockOnVisibility.MoveTolerance = LockOnVisibility_MoveTolerance;
+	LockOnVisibility.RefreshPerFrame = LockOnVisibility_RefreshPerFrame;
+
+	//AS: Every query the character makes ignores itself, so the params are built once and shared
+	SelfQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(AshCharacterQuery), false, this);
+
+	LockOnObjectParams = FCollisionObjectQueryParams();
+	LockOnObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Pawn);
+	LockOnObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+
+	DashHits.Reserve(16);
+	LockOnOverlaps.Reserve(32);
+	LockOnScratchTargets.Reserve(16);
+	TargetableCompsScratch.Reserve(4);
+
+	//AS: Dashes started (or ended) in Tick get integrated by the movement component in the same frame
+	GetCharacterMovement()->PrimaryComponentTick.AddPrerequisite(this, PrimaryActorTick);
+
+	UpdateDebugDrawOverride();
+
 	Super::BeginPlay();
 }
 
+void AAshForestCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+#if ASH_DEBUG_DRAW_ENABLED
+	//AS: Give back the force-all request so later worlds and PIE sessions draw only what their cvars ask for
+	if (bForcingDebugDraw)
+	{
+		bForcingDebugDraw = false;
+		FAshDebugDraw::PopForceAllCategories();
+	}
+#endif
+
+	SetInputTickController(NULL);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAshForestCharacter::UpdateDebugDrawOverride()
+{
+#if ASH_DEBUG_DRAW_ENABLED
+	//AS: Legacy per-character toggle, turns on every ash.Debug.* category for as long as it is set
+	if (bDebugAshMovement == bForcingDebugDraw)
+		return;
+
+	bForcingDebugDraw = bDebugAshMovement;
+
+	if (bForcingDebugDraw)
+		FAshDebugDraw::PushForceAllCategories();
+	else
+		FAshDebugDraw::PopForceAllCategories();
+#endif
+}
+
 void AAshForestCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateDebugDrawOverride();
+
 	Tick_UpdateHealth(DeltaTime);
 
-	if (bWantsToDash)
+	//AS: Proxies only mirror the replicated move state, the dash/climb state machine runs on the owning client and the server
+	if (Role == ROLE_SimulatedProxy)
 	{
-		bWantsToDash = false;
-		TryDash();
-	}
+		if (bIsMeshTransformInterpolating)
+			Tick_MeshInterp(DeltaTime);
 
-	if (bWantsToLockOn)
-	{
-		bWantsToLockOn = false;
-		TryLockOn();
+		return;
 	}
 
-	if (WantsToSwitchLockOnTargetDir != 0)
-	{
-		WantsToSwitchLockOnTargetDir = FMath::Clamp(WantsToSwitchLockOnTargetDir, -1, 1);
-		TrySwitchLockOnTarget((float)WantsToSwitchLockOnTargetDir);
-		WantsToSwitchLockOnTargetDir = 0;
-	}
+	//AS: New presses were already tried in their input callbacks, this retries the ones still buffered
+	if (BufferedActions.Num() > 0)
+		ProcessBufferedActions();
 
 	switch (AshMoveState_Current)
 	{
@@ -304,14 +522,55 @@ void AAshForestCharacter::Tick(float DeltaTime)
 			DashChargeReloadDurationCurrent = DashChargeReloadInterval;
 
 			OnDashRecharge();
+			OnDashChargesChanged.Broadcast(DashCharges_Current, DashCharges_MAX);
 		}
 	}
 
-	//AS: Restore Air Control after wall jumping
-	if (GetCharacterMovement()->FallingLateralFriction == 0.f && GetWorld()->TimeSince(LastWallJumpTime) > DashCooldownTime_AfterWallJump)
+	if (Role == ROLE_Authority)
 	{
-		GetCharacterMovement()->AirControl = MyInitialMovementVars.InitialAirControl;
-		GetCharacterMovement()->FallingLateralFriction = MyInitialMovementVars.InitialFallingLateralFriction;
+		UpdateReplicatedMoveState();
+
+		//AS: Only needed to validate clients' deflections
+		if (GetNetMode() != NM_Standalone)
+			RecordRewindSample();
+	}
+}
+
+void AAshForestCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AAshForestCharacter, ReplicatedMoveState, COND_SimulatedOnly);
+	DOREPLIFETIME_CONDITION(AAshForestCharacter, ReplicatedDashState, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(AAshForestCharacter, CurrentSmolMoniez, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(AAshForestCharacter, CurrentBigUnitMoniez, COND_OwnerOnly);
+}
+
+void AAshForestCharacter::UpdateReplicatedMoveState()
+{
+	//AS: Only changes are sent, so writing these every frame costs nothing while they hold still
+	ReplicatedMoveState = (uint8)AshMoveState_Current;
+	ReplicatedDashState = (uint8)(FMath::Clamp(DashCharges_Current, 0, 15) | (FMath::Clamp(DashesWhileFalling_Current, 0, 15) << 4));
+}
+
+void AAshForestCharacter::OnRep_ReplicatedMoveState()
+{
+	SetAshCustomMoveState((EAshCustomMoveState::Type)ReplicatedMoveState);
+}
+
+void AAshForestCharacter::OnRep_ReplicatedDashState()
+{
+	//AS: A dash the server hasn't acknowledged yet would be undone by the older server value, wait for the next update instead
+	if (GetAshMovement()->HasUnacknowledgedDashMoves())
+		return;
+
+	const int32 serverCharges = ReplicatedDashState & 0x0F;
+	DashesWhileFalling_Current = ReplicatedDashState >> 4;
+
+	if (serverCharges != DashCharges_Current)
+	{
+		DashCharges_Current = serverCharges;
+		OnDashChargesChanged.Broadcast(DashCharges_Current, DashCharges_MAX);
 	}
 }
 
@@ -330,7 +589,6 @@ void AAshForestCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode,
 	if (GetCharacterMovement()->IsWalking())
 	{
 		DashesWhileFalling_Current = 0;
-		GetCharacterMovement()->FallingLateralFriction = MyInitialMovementVars.InitialFallingLateralFriction;
 		GetCharacterMovement()->bUseSeparateBrakingFriction = true;
 	}
 	else
@@ -343,6 +601,7 @@ void AAshForestCharacter::SetAshCustomMoveState(TEnumAsByte<EAshCustomMoveState:
 	{
 		AshMoveState_Previous = AshMoveState_Current;
 		AshMoveState_Current = NewMoveState;
+		GetAshMovement()->SetAshMoveState((uint8)NewMoveState);
 
 		OnAshCustomMoveStateChanged();
 	}
@@ -350,7 +609,7 @@ void AAshForestCharacter::SetAshCustomMoveState(TEnumAsByte<EAshCustomMoveState:
 
 void AAshForestCharacter::OnAshCustomMoveStateChanged()
 {
-	if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Purple, FString::Printf(TEXT("New Move State [%i]"), (uint8)AshMoveState_Current));
+	ASH_DEBUG_MESSAGE(Dash, FColor::Purple, TEXT("New Move State [%i]"), (uint8)AshMoveState_Current);
 
 	switch (AshMoveState_Current)
 	{
@@ -367,30 +626,31 @@ void AAshForestCharacter::OnAshCustomMoveStateChanged()
 
 void AAshForestCharacter::AAshForestCharacter::OnDashPressed()
 {
-	bWantsToDash = true;
+	BufferAction(EAshInputAction::EAshInput_DASH);
 }
 
-void AAshForestCharacter::AAshForestCharacter::OnDashReleased()
+void AAshForestCharacter::TryDash()
 {
-	bWantsToDash = false;
+	TryDashInDirection(SampleMoveInputDirection());
 }
 
-void AAshForestCharacter::TryDash()
+bool AAshForestCharacter::TryDashInDirection(FVector Dir)
 {
-	if (CanDash(true))
+	if (!CanDash(true))
+		return false;
+
+	//AS: Set the dash dir to the look vector if the player wasn't pressing any movement inputs
+	if (Dir == FVector::ZeroVector)
 	{
-		auto dir = GetLastMovementInputVector();
+		const FRotator rotation = LockOnTarget_Current != nullptr ? (LockOnTarget_Current->GetComponentLocation() - GetActorLocation()).GetSafeNormal2D().Rotation() : GetControlRotation();
+		Dir = FRotator(0, rotation.Yaw, 0).Vector();
+	}
 
-		//AS: Set the dash dir to the look vector if the player wasn't pressing any movement inputs
-		if (dir == FVector::ZeroVector)
-		{
-			const FRotator rotation = LockOnTarget_Current != nullptr ? (LockOnTarget_Current->GetComponentLocation() - GetActorLocation()).GetSafeNormal2D().Rotation() : GetControlRotation();
-			dir = FRotator(0, rotation.Yaw, 0).Vector();
-		}
+	if (Dir == FVector::ZeroVector)
+		return false;
 
-		if (dir != FVector::ZeroVector)
-			StartDash(dir);
-	}
+	StartDash(Dir);
+	return true;
 }
 
 bool AAshForestCharacter::CanDash(const bool bIsForStart /*= false*/) const
@@ -422,18 +682,18 @@ void AAshForestCharacter::StartDash(FVector & DashDir)
 	LastDashStartTime = GetWorld()->GetTimeSeconds();
 	DashCooldownTime_Current = DashCooldownTime_Normal;
 
-	GetCharacterMovement()->GravityScale = 0.f;
-	GetCharacterMovement()->MaxWalkSpeed = DashSpeed;
-	GetCharacterMovement()->GroundFriction = 0.f;
-	GetCharacterMovement()->FallingLateralFriction = 0.f;
-	GetCharacterMovement()->bUseSeparateBrakingFriction = false;
+	//AS: No gravity, DashSpeed as max speed and no friction come from the dashing move state itself, the timer ends it per move
+	GetAshMovement()->StartDashTimer(DashDuration_MAX);
 
 	DashDamagedActors.Empty();
 
 	SetActorRotation(FRotator(0.f, CurrentDashDir.Rotation().Yaw, 0.f));
 
-	auto newVel = CurrentDashDir * DashSpeed;
-	((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+	GetAshMovement()->SetCustomStateVelocity(CurrentDashDir * DashSpeed);
+
+	//AS: The owning client predicts the dash, the start goes to the server with the next saved move
+	if (IsLocallyControlled() && Role == ROLE_AutonomousProxy)
+		GetAshMovement()->bDashStartPending = true;
 
 	DashCharges_Current--;
 
@@ -441,6 +701,7 @@ void AAshForestCharacter::StartDash(FVector & DashDir)
 		DashesWhileFalling_Current++;
 
 	OnDash();
+	OnDashChargesChanged.Broadcast(DashCharges_Current, DashCharges_MAX);
 }
 
 void AAshForestCharacter::Tick_Dash(float DeltaTime)
@@ -448,21 +709,13 @@ void AAshForestCharacter::Tick_Dash(float DeltaTime)
 	if (!CanDash())
 		return;
 
-	//AS: Check to see if we have gone past our max allowed dashing time
-	if (GetWorld()->TimeSince(LastDashStartTime) > DashDuration_MAX)
-	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END DASH (REACHED MAX TIME)")));
-
-		EndDash();  
-		return;
-	}
-
+	//AS: Running out of dash time is checked per move by UAshForestCharacterMovement
 	DashDistance_Current -= (GetActorLocation() - PrevDashLoc).Size2D();
 
 	//AS: Check to see if we have gone past our max allowed dashing distance
 	if (DashDistance_Current <= 0.f ||  (GetActorLocation() - OriginalDashStartLocation).Size2D() > DashDistance_MAX)
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END DASH (REACHED MAX DISTANCE)")));
+		ASH_DEBUG_MESSAGE(Dash, FColor::Orange, TEXT("END DASH (REACHED MAX DISTANCE)"));
 
 		EndDash();
 		return;
@@ -488,31 +741,23 @@ void AAshForestCharacter::Tick_Dash(float DeltaTime)
 
 			OriginalDashDir = FRotator(0.f, deltaAngle, 0.f).UnrotateVector(OriginalDashDir);
 
-			if (bDebugAshMovement)
-				DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + (OriginalDashDir * 100.f), FColor::Blue, false, 5.f, 0, 5.f);
+			ASH_DEBUG_LINE(Dash, GetWorld(), GetActorLocation(), GetActorLocation() + (OriginalDashDir * 100.f), FColor::Blue, 5.f, 5.f);
 		}
 	}
 
 	CurrentDashDir = OriginalDashDir;
 
-	FCollisionQueryParams params;
-	params.AddIgnoredActor(this);
-
 	const FVector traceStart = GetActorLocation();
 	const FVector traceEnd = GetActorLocation() + (OriginalDashDir * DashDistance_Current);
-	TArray<FHitResult> dashHits;
-	const bool bFoundHit = GetWorld()->SweepMultiByChannel(dashHits, traceStart, traceEnd, GetActorRotation().Quaternion(), ECollisionChannel::ECC_Visibility, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), params);
+	const bool bFoundHit = GetWorld()->SweepMultiByChannel(DashHits, traceStart, traceEnd, GetActorRotation().Quaternion(), ECollisionChannel::ECC_Visibility, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), SelfQueryParams);
 	
-	if (bDebugAshMovement)
-	{
-		DrawDebugCapsule(GetWorld(), traceStart, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bFoundHit ? FColor::Orange : FColor::Green, false, -1.f, 0, 3.f);
-		DrawDebugLine(GetWorld(), traceStart, traceEnd, bFoundHit ? FColor::Orange : FColor::Green, false, -1.f, 0, 3.f);
-		DrawDebugCapsule(GetWorld(), traceEnd, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bFoundHit ? FColor::Orange : FColor::Green, false, -1.f, 0, 3.f);
-	}
+	ASH_DEBUG_CAPSULE(Dash, GetWorld(), traceStart, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bFoundHit ? FColor::Orange : FColor::Green, 0.f, 3.f);
+	ASH_DEBUG_LINE(Dash, GetWorld(), traceStart, traceEnd, bFoundHit ? FColor::Orange : FColor::Green, 0.f, 3.f);
+	ASH_DEBUG_CAPSULE(Dash, GetWorld(), traceEnd, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bFoundHit ? FColor::Orange : FColor::Green, 0.f, 3.f);
 	
 	if (bFoundHit)
 	{
-		for (auto dashHit : dashHits)
+		for (const FHitResult& dashHit : DashHits)
 		{
 			if (dashHit.Actor == NULL)
 				continue;
@@ -528,27 +773,25 @@ void AAshForestCharacter::Tick_Dash(float DeltaTime)
 				continue;
 			}
 
-			if (!DashDamagedActors.Contains(dashHit.Actor.Get()) && dashHit.Actor->GetClass()->ImplementsInterface(UTargetableInterface::StaticClass()))
+			if (!DashDamagedActors.Contains(dashHit.Actor.Get()) && FAshInterfaceDispatch::IsTargetable(dashHit.Actor.Get()))
 			{
-				if (ITargetableInterface::Execute_CanBeDamaged(dashHit.Actor.Get(), this, dashHit))
+				if (FAshInterfaceDispatch::CanBeDamaged(dashHit.Actor.Get(), this, dashHit))
 				{
-					if (bDebugAshMovement)
-						DrawDebugSphere(GetWorld(), dashHit.ImpactPoint, 75.f, 32, FColor::Yellow, false, 5.f, 0, 5.f);
+					ASH_DEBUG_SPHERE(Dash, GetWorld(), dashHit.ImpactPoint, 75.f, FColor::Yellow, 5.f, 5.f);
 
-					ITargetableInterface::Execute_TakeDamage(dashHit.Actor.Get(), this, DashDamage, dashHit);
+					//AS: Applied after movement by the damage queue, so the actor is still alive for the rest of this loop. Damage is the server's call
+					if (Role == ROLE_Authority)
+						FAshDamageQueue::Get().Enqueue(dashHit.Actor.Get(), this, DashDamage, dashHit);
 
-					if (dashHit.Actor != NULL)
+					if(FAshInterfaceDispatch::IgnoresCollisionWithDamager(dashHit.Actor.Get(), this, dashHit))
+						GetCapsuleComponent()->IgnoreActorWhenMoving(dashHit.Actor.Get(), true);
+					
+					DashDamagedActors.Add(dashHit.Actor.Get());
+					
+					if (auto hitChar = Cast<ADamageableCharacter>(dashHit.Actor.Get()))
 					{
-						if(ITargetableInterface::Execute_IgnoresCollisionWithDamager(dashHit.Actor.Get(), this, dashHit))
-							GetCapsuleComponent()->IgnoreActorWhenMoving(dashHit.Actor.Get(), true);
-						
-						DashDamagedActors.Add(dashHit.Actor.Get());
-						
-						if (auto hitChar = Cast<ADamageableCharacter>(dashHit.Actor.Get()))
-						{
-							auto dashImpulse = ((CurrentDashDir + FVector(0.f, 0.f, .25f)) * .5f) * 5000.f;
-							hitChar->GetCharacterMovement()->AddImpulse(dashImpulse, true);
-						}
+						auto dashImpulse = ((CurrentDashDir + FVector(0.f, 0.f, .25f)) * .5f) * 5000.f;
+						hitChar->GetCharacterMovement()->AddImpulse(dashImpulse, true);
 					}
 				}
 			}
@@ -565,31 +808,25 @@ void AAshForestCharacter::Tick_Dash(float DeltaTime)
 					{
 						CurrentDashDir = FVector::VectorPlaneProject(OriginalDashDir, dashHit.ImpactNormal);
 
-						if (bDebugAshMovement)
-							DrawDebugLine(GetWorld(), dashHit.Location, dashHit.Location + (CurrentDashDir * 50.f), FColor::Magenta, false, 5.f, 0, 5.f);
+						ASH_DEBUG_LINE(Dash, GetWorld(), dashHit.Location, dashHit.Location + (CurrentDashDir * 50.f), FColor::Magenta, 5.f, 5.f);
 					}
 					else
 					{
 						EndDashWithHit(dashHit);
 
-						if (bDebugAshMovement)
-						{
-							DrawDebugLine(GetWorld(), dashHit.ImpactPoint, dashHit.ImpactPoint + (dashHit.ImpactNormal * 50.f), FColor::Red, false, 5.f, 0, 8.f);
-							if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END DASH (HIT WALL)")));
-						}
+						ASH_DEBUG_LINE(Dash, GetWorld(), dashHit.ImpactPoint, dashHit.ImpactPoint + (dashHit.ImpactNormal * 50.f), FColor::Red, 5.f, 8.f);
+						ASH_DEBUG_MESSAGE(Dash, FColor::Orange, TEXT("END DASH (HIT WALL)"));
 
 						return;
 					}
 
-					if (bDebugAshMovement)
-						DrawDebugLine(GetWorld(), dashHit.ImpactPoint, dashHit.ImpactPoint + (dashHit.ImpactNormal * 50.f), FColor::Yellow, false, 5.f, 0, 5.f);
+					ASH_DEBUG_LINE(Dash, GetWorld(), dashHit.ImpactPoint, dashHit.ImpactPoint + (dashHit.ImpactNormal * 50.f), FColor::Yellow, 5.f, 5.f);
 				}
 			}
 		}
 	}
 
-	auto newVel = CurrentDashDir * DashSpeed;
-	((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+	GetAshMovement()->SetCustomStateVelocity(CurrentDashDir * DashSpeed);
 
 	PrevDashLoc = GetActorLocation();
 }
@@ -603,12 +840,6 @@ void AAshForestCharacter::EndDash()
 
 	LastDashEndTime = GetWorld()->GetTimeSeconds();
 
-	GetCharacterMovement()->GravityScale = MyInitialMovementVars.InitialGravityScale;
-	GetCharacterMovement()->GroundFriction = MyInitialMovementVars.InitialGroundFriction;
-	GetCharacterMovement()->MaxWalkSpeed = MyInitialMovementVars.InitialMaxWalkSpeed;
-	GetCharacterMovement()->FallingLateralFriction = MyInitialMovementVars.InitialFallingLateralFriction;
-	GetCharacterMovement()->AirControl = MyInitialMovementVars.InitialAirControl;
-
 	//AS: Un-ignore actors we dashed through
 	for (auto currActor : DashDamagedActors)
 	{
@@ -620,10 +851,9 @@ void AAshForestCharacter::EndDash()
 
 	//AS: Make sure that we can't go extra distance due to large tick delta times
 	if ((GetActorLocation() - OriginalDashStartLocation).Size() > DashDistance_MAX)
-		SetActorLocation(OriginalDashStartLocation + ((GetActorLocation() - OriginalDashStartLocation).GetSafeNormal() * DashDistance_MAX));
+		GetAshMovement()->SetPendingLocation(OriginalDashStartLocation + ((GetActorLocation() - OriginalDashStartLocation).GetSafeNormal() * DashDistance_MAX));
 
-	auto newVel = GetVelocity().GetSafeNormal2D() * (GetCharacterMovement()->MaxWalkSpeed * 2.f);
-	((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+	GetAshMovement()->SetPendingVelocity(GetVelocity().GetSafeNormal2D() * (GetCharacterMovement()->MaxWalkSpeed * 2.f));
 }
 
 void AAshForestCharacter::EndDashWithHit(const FHitResult & EndHit)
@@ -682,8 +912,7 @@ void AAshForestCharacter::StartClimbing(const FHitResult & ClimbingSurfaceHit)
 
 	((UCharacterMovementComponent*)GetMovementComponent())->SetMovementMode(MOVE_Falling);
 
-	auto newVel = CurrentClimbingDir * ClimbingSpeed_Current;
-	((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+	GetAshMovement()->SetCustomStateVelocity(CurrentClimbingDir * ClimbingSpeed_Current);
 
 	//DashesWhileFalling_Current = AllowedDashesWhileFalling;
 }
@@ -692,7 +921,7 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 {
 	if (GetWorld()->TimeSince(LastStartClimbingTime) > (bIsWallRunning ? WallRunDuration_MAX : ClimbingDuration_MAX))
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (REACHED MAX TIME)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (REACHED MAX TIME)"));
 
 		EndClimbing();
 		return;
@@ -701,7 +930,7 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 	FVector ledgeLoc;
 	if (CheckForLedge(ledgeLoc))
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (FOUND LEDGE)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (FOUND LEDGE)"));
 
 		EndClimbing(true, ledgeLoc);
 		return;
@@ -711,11 +940,8 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 	float capHalfHeight;
 	GetCapsuleComponent()->GetScaledCapsuleSize(capRadius, capHalfHeight);
 
-	FCollisionQueryParams params;
-	params.AddIgnoredActor(this);
-
 	FHitResult climbingHit;
-	auto bFoundSurface = GetWorld()->SweepSingleByChannel(climbingHit, GetActorLocation(), GetActorLocation() + (CurrentDirToClimbingSurface * (capRadius + 100.f)), FQuat::Identity, ECC_Camera, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), params);
+	auto bFoundSurface = GetWorld()->SweepSingleByChannel(climbingHit, GetActorLocation(), GetActorLocation() + (CurrentDirToClimbingSurface * (capRadius + 100.f)), FQuat::Identity, ECC_Camera, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), SelfQueryParams);
 	
 	if (bFoundSurface && !CanClimbHitSurface(false, climbingHit))
 		bFoundSurface = false;
@@ -729,7 +955,7 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 
 	if (projectedClimbDir == FVector::ZeroVector)
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (VELOCITY PROJECTION FAILED)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (VELOCITY PROJECTION FAILED)"));
 
 		EndClimbing();
 		return;
@@ -740,12 +966,12 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 		CurrentClimbingNormal = climbingHit.ImpactNormal;
 		CurrentDirToClimbingSurface = (climbingHit.ImpactPoint - GetActorLocation()).GetSafeNormal();
 
-		SoftSetActorLocation(FMath::VInterpTo(climbingHit.Location, GetActorLocation(), DeltaTime, 5.f), true);
+		GetAshMovement()->SetPendingLocation(FMath::VInterpTo(climbingHit.Location, GetActorLocation(), DeltaTime, 5.f), true);
 		SetActorRotation(FRotator(0.f, (bIsWallRunning ? GetVelocity().GetSafeNormal() : CurrentDirToClimbingSurface).Rotation().Yaw, 0.f));
 	}
 	else //AS: If we have run out of wall to climb
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (NO VALID SURFACE FOUND)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (NO VALID SURFACE FOUND)"));
 
 		EndClimbing();
 		return;
@@ -754,20 +980,19 @@ void AAshForestCharacter::Tick_Climbing(float DeltaTime)
 	//AS: If the player basically hasn't moved since the last frame
 	if (PrevClimbingLocation != FVector::ZeroVector && (GetActorLocation() - PrevClimbingLocation).SizeSquared() <= FMath::Square(2.f))
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (STUCK ON GEO)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (STUCK ON GEO)"));
 
 		EndClimbing();
 		return;
 	}
 
-	auto newVel = projectedClimbDir * ClimbingSpeed_Current;
-	((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+	GetAshMovement()->SetCustomStateVelocity(projectedClimbDir * ClimbingSpeed_Current);
 
 	ClimbingSpeed_Current -= (DeltaTime * (bIsWallRunning ? WallRunSpeed_DecayRate : ClimbingSpeed_DecayRate));
 
 	if (ClimbingSpeed_Current <= 0.f)
 	{
-		if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Orange, FString::Printf(TEXT("END CLIMBING (RAN OUT OF SPEED)")));
+		ASH_DEBUG_MESSAGE(Climb, FColor::Orange, TEXT("END CLIMBING (RAN OUT OF SPEED)"));
 
 		EndClimbing();
 		return;
@@ -792,8 +1017,7 @@ void AAshForestCharacter::EndClimbing(const bool bDoClimbOver /*= false*/, const
 		}
 		else
 		{
-			FVector endWallRunVel = CurrentClimbingDir * ClimbingSpeed_Current;
-			((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(endWallRunVel);
+			GetAshMovement()->SetPendingVelocity(CurrentClimbingDir * ClimbingSpeed_Current);
 		}
 	}
 
@@ -821,23 +1045,21 @@ void AAshForestCharacter::DoWallJump()
 	{
 		FVector wallJumpImpulse = CurrentClimbingNormal * ClimbingJumpImpulseAxisSizes.X;
 		wallJumpImpulse.Z = ClimbingJumpImpulseAxisSizes.Y;
-		((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(wallJumpImpulse);
-
-		GetCharacterMovement()->AirControl = 0.f;
+		GetAshMovement()->SetPendingVelocity(wallJumpImpulse);
 	}
 	else
 	{
-		FVector wallJumpVel = (((CurrentClimbingDir * 2.f) + CurrentClimbingNormal) / 2.f).GetSafeNormal() * ((UCharacterMovementComponent*)GetMovementComponent())->MaxWalkSpeed;
+		FVector wallJumpVel = (((CurrentClimbingDir * 2.f) + CurrentClimbingNormal) / 2.f).GetSafeNormal() * GetCharacterMovement()->MaxWalkSpeed;
 		wallJumpVel.Z = WallRunJumpVelocityZ;
-		((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(wallJumpVel);
-
-		bIsWallRunning = false;	
+		GetAshMovement()->SetPendingVelocity(wallJumpVel);
 	}
 
-	EndClimbing();
+	//AS: No falling friction until the dash cooldown is over (or we land), and no air control either off a climbing wall
+	GetAshMovement()->StartAirLock(DashCooldownTime_AfterWallJump, !bIsWallRunning);
 
-	GetCharacterMovement()->FallingLateralFriction = 0.f;
-	GetCharacterMovement()->bUseSeparateBrakingFriction = false;
+	bIsWallRunning = false;
+
+	EndClimbing();
 
 	OnWallJump();
 }
@@ -893,40 +1115,32 @@ bool AAshForestCharacter::CheckForLedge(FVector & FoundLedgeLocation)
 
 	bLastGrabLedgeSideLeft = !bLastGrabLedgeSideLeft;
 
-	FCollisionQueryParams params;
-	params.AddIgnoredActor(this);
-
 	//AS: Ledge Trace Lambda
 	auto DoLedgeTrace = [&](FHitResult & FillHitResult, bool & bFoundLedge, const FVector TraceOrigin, FVector TraceStart, FVector TraceEnd)
 	{
-		bFoundLedge = GetWorld()->LineTraceSingleByChannel(FillHitResult, TraceOrigin, TraceStart, ECC_Camera, params);
+		bFoundLedge = GetWorld()->LineTraceSingleByChannel(FillHitResult, TraceOrigin, TraceStart, ECC_Camera, SelfQueryParams);
 
-		if (bDebugAshMovement)
-			DrawDebugLine(GetWorld(), TraceOrigin, TraceStart, !bFoundLedge ? FColor::Green : FColor::Yellow, false, 5.f, 0, 5.f);
+		ASH_DEBUG_LINE(Ledge, GetWorld(), TraceOrigin, TraceStart, !bFoundLedge ? FColor::Green : FColor::Yellow, 5.f, 5.f);
 
 		if (bFoundLedge)
 		{
-			if (bDebugAshMovement)
-				DrawDebugSphere(GetWorld(), FillHitResult.ImpactPoint, 20.f, 16, FColor::Orange, false, 5.f, 0, 3.f);
+			ASH_DEBUG_SPHERE(Ledge, GetWorld(), FillHitResult.ImpactPoint, 20.f, FColor::Orange, 5.f, 3.f);
 
 			TraceStart = FillHitResult.ImpactPoint + FillHitResult.ImpactNormal * .1f;
 		}
 
-		bFoundLedge = GetWorld()->LineTraceSingleByChannel(FillHitResult, TraceStart, TraceEnd, ECC_Camera, params);
+		bFoundLedge = GetWorld()->LineTraceSingleByChannel(FillHitResult, TraceStart, TraceEnd, ECC_Camera, SelfQueryParams);
 
-		if (bDebugAshMovement)
-			DrawDebugLine(GetWorld(), TraceStart, TraceEnd, bFoundLedge ? FColor::Green : FColor::Red, false, 5.f, 0, 5.f);
+		ASH_DEBUG_LINE(Ledge, GetWorld(), TraceStart, TraceEnd, bFoundLedge ? FColor::Green : FColor::Red, 5.f, 5.f);
 
 		if (bFoundLedge && !IsValidLedgeHit(FillHitResult))
 			bFoundLedge = false;
 
-		if (bDebugAshMovement)
-			DrawDebugLine(GetWorld(), TraceStart, TraceEnd, bFoundLedge ? FColor::Green : FColor::Red, false, 5.f, 0, 5.f);
+		ASH_DEBUG_LINE(Ledge, GetWorld(), TraceStart, TraceEnd, bFoundLedge ? FColor::Green : FColor::Red, 5.f, 5.f);
 
 		if (bFoundLedge)
 		{
-			if (bDebugAshMovement)
-				DrawDebugSphere(GetWorld(), FillHitResult.ImpactPoint, 20.f, 16, FColor::Cyan, false, 5.f, 0, 3.f);
+			ASH_DEBUG_SPHERE(Ledge, GetWorld(), FillHitResult.ImpactPoint, 20.f, FColor::Cyan, 5.f, 3.f);
 		}
 	};
 
@@ -953,18 +1167,16 @@ bool AAshForestCharacter::CheckForLedge(FVector & FoundLedgeLocation)
 	auto traceEnd_center = traceStart_center + (-FVector::UpVector * 200.f);
 
 	FHitResult ledgeHit_Center;
-	auto bFoundLedge_Center = GetWorld()->LineTraceSingleByChannel(ledgeHit_Center, traceStart_center, traceEnd_center, ECC_Camera, params);
+	auto bFoundLedge_Center = GetWorld()->LineTraceSingleByChannel(ledgeHit_Center, traceStart_center, traceEnd_center, ECC_Camera, SelfQueryParams);
 
 	if (bFoundLedge_Center && !IsValidLedgeHit(ledgeHit_Center))
 		bFoundLedge_Center = false;
 
-	if (bDebugAshMovement)
-		DrawDebugLine(GetWorld(), traceStart_Second, traceEnd_Second, bFoundLedge_Center ? FColor::Green : FColor::Red, false, 5.f, 0, 5.f);
+	ASH_DEBUG_LINE(Ledge, GetWorld(), traceStart_Second, traceEnd_Second, bFoundLedge_Center ? FColor::Green : FColor::Red, 5.f, 5.f);
 
 	if (bFoundLedge_Center)
 	{
-		if (bDebugAshMovement)
-			DrawDebugSphere(GetWorld(), ledgeHit_Center.ImpactPoint, 20.f, 16, FColor::Green, false, 5.f, 0, 3.f);
+		ASH_DEBUG_SPHERE(Ledge, GetWorld(), ledgeHit_Center.ImpactPoint, 20.f, FColor::Green, 5.f, 3.f);
 	}
 	else
 		return false;
@@ -986,25 +1198,21 @@ bool AAshForestCharacter::ClimbOverLedge(const FVector & FoundLedgeLocation)
 	float capHalfHeight;
 	GetCapsuleComponent()->GetScaledCapsuleSize(capRadius, capHalfHeight);
 
-	FCollisionQueryParams params;
-	params.AddIgnoredActor(this);
-
 	auto wantsLocation = FoundLedgeLocation + (FVector::UpVector * (capHalfHeight - capRadius));
 
 	//AS: Make sure there is enough space for the player capsule on top of the ledge
-	auto bEnoughSpace = !GetWorld()->OverlapAnyTestByChannel(wantsLocation, GetActorRotation().Quaternion(), ECC_Camera, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), params);
+	auto bEnoughSpace = !GetWorld()->OverlapAnyTestByChannel(wantsLocation, GetActorRotation().Quaternion(), ECC_Camera, FCollisionShape::MakeCapsule(capRadius, capHalfHeight), SelfQueryParams);
 
-	if (bDebugAshMovement)
-		DrawDebugCapsule(GetWorld(), wantsLocation, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bEnoughSpace ? FColor::Green : FColor::Red, false, 5.f, 0, 3.f);
+	ASH_DEBUG_CAPSULE(Ledge, GetWorld(), wantsLocation, capHalfHeight, capRadius, GetActorRotation().Quaternion(), bEnoughSpace ? FColor::Green : FColor::Red, 5.f, 3.f);
 
 	if (bEnoughSpace)
 	{
 		ResetMeshTransform();
-		SoftSetActorLocation(wantsLocation);
+		GetAshMovement()->SetPendingLocation(wantsLocation);
 
 		auto newVel = GetVelocity();
 		newVel.Z = FMath::Min(newVel.Z, 0.f);
-		((UCharacterMovementComponent*)GetMovementComponent())->OverrideVelocity(newVel);
+		GetAshMovement()->SetPendingVelocity(newVel);
 
 		return true;
 	}
@@ -1014,18 +1222,13 @@ bool AAshForestCharacter::ClimbOverLedge(const FVector & FoundLedgeLocation)
 
 void AAshForestCharacter::OnLockOnPressed()
 {
-	bWantsToLockOn = true;
-}
-
-void AAshForestCharacter::OnLockOnReleased()
-{
-	bWantsToLockOn = false;
+	BufferAction(EAshInputAction::EAshInput_LOCK_ON);
 }
 
 void AAshForestCharacter::OnLockOnSwitchInput(float Dir)
 {
-	if (IsLockedOn())
-		WantsToSwitchLockOnTargetDir = Dir;
+	if (IsLockedOn() && Dir != 0.f)
+		BufferAction(EAshInputAction::EAshInput_SWITCH_TARGET, Dir > 0.f ? 1 : -1);
 }
 
 void AAshForestCharacter::TryLockOn()
@@ -1038,26 +1241,16 @@ void AAshForestCharacter::TryLockOn()
 
 USceneComponent* AAshForestCharacter::FindLockOnTarget(const bool bIgnorePreviousTarget/* = false*/, const FRotator OverrideViewRot /*= FRotator::ZeroRotator*/)
 {
-	TArray<USceneComponent*> temp;
-	return GetPotentialLockOnTargets(temp, bIgnorePreviousTarget, OverrideViewRot);
+	return GetPotentialLockOnTargets(LockOnScratchTargets, bIgnorePreviousTarget, OverrideViewRot);
 }
 
 USceneComponent* AAshForestCharacter::GetPotentialLockOnTargets(TArray<USceneComponent*> & PotentialTargets, const bool bIgnorePreviousTarget /*= false*/, const FRotator OverrideViewRot /*= FRotator::ZeroRotator*/)
 {
-	PotentialTargets.Empty();
-
-	FCollisionObjectQueryParams objectParams;
-	objectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Pawn);
-	objectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+	PotentialTargets.Reset();
 
-	FCollisionQueryParams queryParams;
-	queryParams.AddIgnoredActor(this);
+	GetWorld()->OverlapMultiByObjectType(LockOnOverlaps, GetActorLocation(), FQuat::Identity, LockOnObjectParams, FCollisionShape::MakeSphere(LockOnFindTarget_Radius), SelfQueryParams);
 
-	TArray<FOverlapResult> potentialTargets;
-	GetWorld()->OverlapMultiByObjectType(potentialTargets, GetActorLocation(), FQuat::Identity, objectParams, FCollisionShape::MakeSphere(LockOnFindTarget_Radius), queryParams);
-
-	if (bDebugAshMovement)
-		DrawDebugSphere(GetWorld(), GetActorLocation(), LockOnFindTarget_Radius, 32, FColor::Purple, false, 5.f, 0, 3.f);
+	ASH_DEBUG_SPHERE(LockOn, GetWorld(), GetActorLocation(), LockOnFindTarget_Radius, FColor::Purple, 5.f, 3.f);
 
 	FRotator rotation = GetControlRotation();
 
@@ -1068,81 +1261,77 @@ USceneComponent* AAshForestCharacter::GetPotentialLockOnTargets(TArray<USceneCom
 
 	auto YawRotationVec = FRotator(0, rotation.Yaw, 0).Vector();
 	USceneComponent* retTarget = NULL;
-	TArray<USceneComponent*> currPotentialTargetsArray;
 	USceneComponent* currPotentialTarget = NULL;
-	auto dirToTarget = FVector::ZeroVector;
-	auto angleToTarget_curr = 0.f;
-	auto angleToTarget_best = 400.f;
 	auto bIsValidTarget = false;
 
-	if (potentialTargets.Num() > 0)
+	if (LockOnOverlaps.Num() > 0)
 	{
-		FHitResult blockingHit;
-		FCollisionQueryParams params;
-		params.AddIgnoredActor(this);
-
 		FVector viewLoc;
 		FRotator viewRot;
 		GetController()->GetPlayerViewPoint(viewLoc, viewRot);
 
-		for (FOverlapResult currTarget : potentialTargets)
-		{
-			if (currTarget.Actor == NULL || currTarget.Actor == this || !currTarget.Actor->GetClass()->ImplementsInterface(UTargetableInterface::StaticClass()) || !ITargetableInterface::Execute_CanBeTargeted(currTarget.Actor.Get(), this))
-				continue;
+		LockOnBatch.Reset();
+		LockOnBatchTargets.Reset();
+		LockOnBatchLocations.Reset();
 
+		//AS: Filter first, then run the cone test for every remaining candidate as one batch
+		for (const FOverlapResult& currTarget : LockOnOverlaps)
+		{
 			//AS: Don't switch to non-enemy targets if your current target is a damageable character
-			if (LockOnTarget_Current != NULL && LockOnTarget_Current->GetOwner()->IsA(ADamageableCharacter::StaticClass()) && !currTarget.Actor->IsA(ADamageableCharacter::StaticClass()))
+			if (LockOnTarget_Current != NULL && LockOnTarget_Current->GetOwner()->IsA(ADamageableCharacter::StaticClass()) && currTarget.Actor.IsValid() && !currTarget.Actor->IsA(ADamageableCharacter::StaticClass()))
 				continue;
 
-			if (ITargetableInterface::Execute_GetTargetableComponents(currTarget.Actor.Get(), currPotentialTargetsArray))
-			{
-				if (currPotentialTargetsArray.Num() == 1)
-					currPotentialTarget = currPotentialTargetsArray[0];
-				else
-					continue;
-			}
-			else
+			currPotentialTarget = GetLockOnCandidateComponent(currTarget.Actor.Get());
+			if (!currPotentialTarget)
 				continue;
 
 			//AS: Code to ignore previous target
 			if ((LockOnTarget_Current != NULL && currPotentialTarget == LockOnTarget_Current)
 				|| (bIgnorePreviousTarget && currPotentialTarget == LockOnTarget_Previous)
-				|| PotentialTargets.Contains(currPotentialTarget))
+				|| LockOnBatchTargets.Contains(currPotentialTarget))
+				continue;
+
+			const FVector targetLoc = currPotentialTarget->GetComponentLocation();
+			LockOnBatch.Add(targetLoc);
+			LockOnBatchTargets.Add(currPotentialTarget);
+			LockOnBatchLocations.Add(targetLoc);
+		}
+
+		FAshLockOnKernel::Evaluate(LockOnBatch, viewLoc, YawRotationVec);
+
+		const float coneKey = FAshLockOnKernel::ConeKey(LockOnFindTarget_WithinLookDirAngleDelta);
+		float bestKey = -MAX_FLT;
+
+		for (int32 i = 0; i < LockOnBatch.Num; i++)
+		{
+			if (LockOnBatch.Key[i] < coneKey)
 				continue;
 
+			currPotentialTarget = LockOnBatchTargets[i];
+			const FVector& targetLoc = LockOnBatchLocations[i];
 			bIsValidTarget = false;
 
-			angleToTarget_curr = FMath::Abs(FMath::Acos(FVector::DotProduct((currPotentialTarget->GetComponentLocation() - viewLoc).GetSafeNormal2D(), YawRotationVec)) * (180.f / PI));
-			
-			if (angleToTarget_curr <= LockOnFindTarget_WithinLookDirAngleDelta)
+			if (LockOnVisibility.IsVisible(GetWorld(), currPotentialTarget, targetLoc, viewLoc, SelfQueryParams))
 			{
-				auto bPathClear = !GetWorld()->LineTraceSingleByChannel(blockingHit, viewLoc, currPotentialTarget->GetComponentLocation(), ECC_Camera, params);
+				PotentialTargets.Add(currPotentialTarget);
 
-				if (!bPathClear && blockingHit.Actor != NULL && blockingHit.Actor == currTarget.Actor)
-					bPathClear = true;
+				ASH_DEBUG_MESSAGE(LockOn, FColor::Yellow, TEXT("Found target[%i]: %s [%3.2f] "), PotentialTargets.Num(), *currPotentialTarget->GetName(), FAshLockOnKernel::KeyToDegrees(LockOnBatch.Key[i]));
 
-				if (bPathClear)
+				//AS: Larger key is a smaller angle
+				if (LockOnBatch.Key[i] > bestKey)
 				{
-					PotentialTargets.AddUnique(currPotentialTarget);
-
-					if (bDebugAshMovement && GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Yellow, FString::Printf(TEXT("Found target[%i]: %s [%3.2f] "), PotentialTargets.Num(), *currPotentialTarget->GetName(), angleToTarget_curr));
+					bestKey = LockOnBatch.Key[i];
+					retTarget = currPotentialTarget;
 
-					if (angleToTarget_curr < angleToTarget_best)
-					{
-						angleToTarget_best = angleToTarget_curr;
-						retTarget = currPotentialTarget;
-
-						bIsValidTarget = true;
-					}
+					bIsValidTarget = true;
 				}
-
-				if (bDebugAshMovement)
-					DrawDebugLine(GetWorld(), GetActorLocation(), currPotentialTarget->GetComponentLocation(), bIsValidTarget ? FColor::Yellow : FColor::Red, false, 5.f, 0, 3.f);
 			}
+
+			ASH_DEBUG_LINE(LockOn, GetWorld(), GetActorLocation(), targetLoc, bIsValidTarget ? FColor::Yellow : FColor::Red, 5.f, 3.f);
 		}
 
-		if (bDebugAshMovement && retTarget)
-			DrawDebugLine(GetWorld(), GetActorLocation(), retTarget->GetComponentLocation(), FColor::Green, false, 5.f, 0, 6.f);
+		if (retTarget)
+			ASH_DEBUG_LINE(LockOn, GetWorld(), GetActorLocation(), retTarget->GetComponentLocation(), FColor::Green, 5.f, 6.f);
 	}
 
 	return retTarget;
@@ -1157,6 +1346,7 @@ void AAshForestCharacter::SetLockOnTarget(USceneComponent* NewLockOnTarget_Curre
 
 		LockOnTarget_Current = NewLockOnTarget_Current;
 		OnLockOnTargetUpdated();
+		OnLockOnTargetChanged.Broadcast(LockOnTarget_Current.Get(), LockOnTarget_Previous.Get());
 	}
 }
 
@@ -1170,7 +1360,24 @@ bool AAshForestCharacter::TrySwitchLockOnTarget(const float & RightInput)
 	if (RightInput == 0.f || LockOnTarget_Current == NULL || GetWorld()->TimeSince(LastSwitchLockOnTargetTime) < AllowSwitchLockOnTargetInterval)
 		return false;
 
-	TArray<USceneComponent*> potentialTargets;
+	//AS: Normally a neighbor lookup in the angular ordering, the full query below only runs if the current target isn't in it
+	if (GetWorld()->TimeSince(LastLockOnRingRefreshTime) > LockOnRing_RefreshInterval)
+		RefreshLockOnRing();
+
+	if (LockOnRing.Find(LockOnTarget_Current.Get()) != INDEX_NONE)
+	{
+		if (auto ringTarget = FindLockOnRingNeighbor(LockOnTarget_Current.Get(), RightInput > 0.f ? 1 : -1, true))
+		{
+			LastSwitchLockOnTargetTime = GetWorld()->GetTimeSeconds();
+
+			SetLockOnTarget(ringTarget);
+			return true;
+		}
+
+		return false;
+	}
+
+	TArray<USceneComponent*>& potentialTargets = LockOnScratchTargets;
 	GetPotentialLockOnTargets(potentialTargets);
 
 	FVector viewLoc;
@@ -1178,34 +1385,19 @@ bool AAshForestCharacter::TrySwitchLockOnTarget(const float & RightInput)
 	GetController()->GetPlayerViewPoint(viewLoc, viewRot);
 
 	auto dirToCurrentTarget = (LockOnTarget_Current->GetComponentLocation() - viewLoc).GetSafeNormal2D();
-	auto YawRotationVec = FRotator(0, Controller->GetControlRotation().Yaw, 0).Vector();
-	
-	USceneComponent* bestTarget = NULL;
-	auto dirToTarget = FVector::ZeroVector;
-	auto angleToTarget_curr = 0.f;
-	auto angleToTarget_best = 400.f;
-	auto bIsValidTarget = false;
 
-	for (USceneComponent* currTarget : potentialTargets)
-	{
-		if (currTarget == LockOnTarget_Current)
-			continue;
+	LockOnBatch.Reset();
 
-		dirToTarget = (currTarget->GetComponentLocation() - viewLoc).GetSafeNormal2D();
- 		angleToTarget_curr = FMath::Acos(FVector::DotProduct(dirToCurrentTarget, dirToTarget)) * (180.f / PI);
+	for (USceneComponent* currTarget : potentialTargets)
+		LockOnBatch.Add(currTarget->GetComponentLocation());
 
-		if (FVector::CrossProduct(dirToCurrentTarget, dirToTarget).Z < 0.f)
-			angleToTarget_curr *= -1.f;
+	//AS: Nearest candidate on each side of the current target in one pass, then take the side that was asked for
+	int32 bestLeft, bestRight;
+	FAshLockOnKernel::Evaluate(LockOnBatch, viewLoc, dirToCurrentTarget);
+	FAshLockOnKernel::PickSwitchTargets(LockOnBatch, potentialTargets.IndexOfByKey(LockOnTarget_Current.Get()), bestLeft, bestRight);
 
-		if (FMath::Sign(RightInput) == FMath::Sign(angleToTarget_curr))
-		{
-			if (FMath::Abs(angleToTarget_curr) < FMath::Abs(angleToTarget_best))
-			{
-				bestTarget = currTarget;
-				angleToTarget_best = angleToTarget_curr;
-			}
-		}
-	}
+	const int32 bestIndex = RightInput > 0.f ? bestRight : bestLeft;
+	USceneComponent* bestTarget = bestIndex != INDEX_NONE ? potentialTargets[bestIndex] : NULL;
 
 	if (bestTarget)
 	{
@@ -1218,16 +1410,121 @@ bool AAshForestCharacter::TrySwitchLockOnTarget(const float & RightInput)
 	return false;
 }
 
+USceneComponent* AAshForestCharacter::GetLockOnCandidateComponent(AActor* Actor)
+{
+	if (Actor == NULL || Actor == this || !FAshInterfaceDispatch::IsTargetable(Actor) || !FAshInterfaceDispatch::CanBeTargeted(Actor, this))
+		return NULL;
+
+	if (FAshInterfaceDispatch::GetTargetableComponents(Actor, TargetableCompsScratch) && TargetableCompsScratch.Num() == 1)
+		return TargetableCompsScratch[0];
+
+	return NULL;
+}
+
+void AAshForestCharacter::RefreshLockOnRing()
+{
+	LastLockOnRingRefreshTime = GetWorld()->GetTimeSeconds();
+
+	GetWorld()->OverlapMultiByObjectType(LockOnOverlaps, GetActorLocation(), FQuat::Identity, LockOnObjectParams, FCollisionShape::MakeSphere(LockOnFindTarget_Radius), SelfQueryParams);
+
+	TArray<USceneComponent*, TAshScratchAllocator<>> targets;
+	targets.Reserve(LockOnOverlaps.Num() + 1);
+
+	for (const FOverlapResult& currOverlap : LockOnOverlaps)
+	{
+		if (auto targetComp = GetLockOnCandidateComponent(currOverlap.Actor.Get()))
+			targets.AddUnique(targetComp);
+	}
+
+	//AS: The current target stays in even if it drifted out of the sphere, it's what every lookup starts from
+	if (LockOnTarget_Current != NULL)
+		targets.AddUnique(LockOnTarget_Current.Get());
+
+	FVector viewLoc;
+	FRotator viewRot;
+	GetController()->GetPlayerViewPoint(viewLoc, viewRot);
+
+	LockOnRing.Rebuild(targets, viewLoc);
+}
+
+USceneComponent* AAshForestCharacter::FindLockOnRingNeighbor(USceneComponent* From, const int32 Dir, const bool bLimitToCone, float* OutKey /*= NULL*/)
+{
+	const int32 fromIndex = LockOnRing.Find(From);
+
+	if (fromIndex == INDEX_NONE || LockOnRing.Num() < 2)
+		return NULL;
+
+	const FVector viewLoc = LockOnRing.GetOrigin();
+	const FVector fromDir = (From->GetComponentLocation() - viewLoc).GetSafeNormal2D();
+	const float coneKey = FAshLockOnKernel::ConeKey(LockOnFindTarget_WithinLookDirAngleDelta);
+	const bool bFromIsDamageable = From->GetOwner() && From->GetOwner()->IsA(ADamageableCharacter::StaticClass());
+
+	for (int32 step = 1; step < LockOnRing.Num(); step++)
+	{
+		const auto& entry = LockOnRing.GetWrapped(fromIndex + (step * Dir));
+		USceneComponent* candidate = entry.Target.Get();
+
+		if (!candidate || candidate == From)
+			continue;
+
+		const FVector candidateDir = (entry.Location - viewLoc).GetSafeNormal2D();
+		const float key = FAshLockOnKernel::CosineKey(FVector::DotProduct(candidateDir, fromDir));
+
+		if (bLimitToCone)
+		{
+			//AS: Entries are in angular order, so walking Dir's way they only get further from From until the walk
+			//	  swings round to From's other side. Stop at the first one outside the cone or on the wrong side, a
+			//	  switch never wraps round to a target on the opposite side like the old search
+			const float side = FVector::CrossProduct(fromDir, candidateDir).Z;
+
+			if (key < coneKey || side * Dir < 0.f)
+				break;
+
+			if (side == 0.f)
+				continue;
+		}
+
+		//AS: Don't switch to non-enemy targets if your current target is a damageable character
+		if (bFromIsDamageable && !candidate->GetOwner()->IsA(ADamageableCharacter::StaticClass()))
+			continue;
+
+		if (GetLockOnCandidateComponent(candidate->GetOwner()) != candidate || !LockOnVisibility.IsVisible(GetWorld(), candidate, entry.Location, viewLoc, SelfQueryParams))
+			continue;
+
+		if (OutKey)
+			*OutKey = key;
+
+		return candidate;
+	}
+
+	return NULL;
+}
+
+void AAshForestCharacter::CycleLockOnTarget()
+{
+	if (LockOnTarget_Current == NULL)
+		return;
+
+	if (GetWorld()->TimeSince(LastLockOnRingRefreshTime) > LockOnRing_RefreshInterval)
+		RefreshLockOnRing();
+
+	if (auto nextTarget = FindLockOnRingNeighbor(LockOnTarget_Current.Get(), 1, false))
+	{
+		LastSwitchLockOnTargetTime = GetWorld()->GetTimeSeconds();
+		SetLockOnTarget(nextTarget);
+	}
+}
+
 void AAshForestCharacter::SwitchLockOnTarget_Left()
 {
 	if (IsLockedOn())
-		WantsToSwitchLockOnTargetDir = -1;
+		BufferAction(EAshInputAction::EAshInput_SWITCH_TARGET, -1);
 }
 
 void AAshForestCharacter::SwitchLockOnTarget_Right()
 {
 	if (IsLockedOn())
-		WantsToSwitchLockOnTargetDir = 1;
+		BufferAction(EAshInputAction::EAshInput_SWITCH_TARGET, 1);
 }
 
 void AAshForestCharacter::OnLockOnTargetUpdated_Implementation()
@@ -1246,15 +1543,27 @@ void AAshForestCharacter::Tick_LockedOn(float DeltaTime)
 	}
 
 	//AS: If our current target can no longer be targeted
-	if (!LockOnTarget_Current.Get()->GetOwner() || !LockOnTarget_Current.Get()->GetOwner()->GetClass()->ImplementsInterface(UTargetableInterface::StaticClass())
-		|| !ITargetableInterface::Execute_CanBeTargeted(LockOnTarget_Current.Get()->GetOwner(), this))
+	if (!LockOnTarget_Current.Get()->GetOwner() || !FAshInterfaceDispatch::CanBeTargeted(LockOnTarget_Current.Get()->GetOwner(), this))
 	{
 		AutoSwitchLockOnTarget(LockOnTarget_Current.Get());
 		return;
 	}
 
-	if (bDebugAshMovement)
-		DrawDebugLine(GetWorld(), GetActorLocation(), LockOnTarget_Current->GetComponentLocation(), FColor::Magenta, false, -1.f, 0, 3.f);
+	ASH_DEBUG_LINE(LockOn, GetWorld(), GetActorLocation(), LockOnTarget_Current->GetComponentLocation(), FColor::Magenta, 0.f, 3.f);
+
+	//AS: Keep the candidates' line of sight and angular ordering warm so switching targets is a lookup
+	{
+		FVector viewLoc;
+		FRotator viewRot;
+		GetController()->GetPlayerViewPoint(viewLoc, viewRot);
+
+		LockOnVisibility.RefreshStale(GetWorld(), viewLoc, SelfQueryParams);
+
+		if (GetWorld()->TimeSince(LastLockOnRingRefreshTime) > LockOnRing_RefreshInterval)
+			RefreshLockOnRing();
+		else
+			LockOnRing.Update(viewLoc);
+	}
 
 	auto newControlRot = GetControlRotation();
 	auto RotToTarget = (LockOnTarget_Current->GetComponentLocation() - GetPawnViewLocation()).GetSafeNormal().Rotation();
@@ -1302,6 +1611,8 @@ void AAshForestCharacter::Tick_UpdateCamera(float DeltaTime)
 				FRotator RotToTarget = (CurrentFocusPointTrigger->FocusPointActor->GetActorLocation() - GetPawnViewLocation()).GetSafeNormal().Rotation();
 				RotToTarget.Roll = 0.f;
 
+				ASH_DEBUG_LINE(Camera, GetWorld(), GetPawnViewLocation(), CurrentFocusPointTrigger->FocusPointActor->GetActorLocation(), FColor::Cyan, 0.f, 2.f);
+
 				auto rotDelta = (RotToTarget - newControlRot);
 
 				if (FMath::Abs(rotDelta.Pitch) > .1f || FMath::Abs(rotDelta.Yaw) > .1f)
@@ -1411,10 +1722,16 @@ void AAshForestCharacter::ResetMeshTransform()
 
 void AAshForestCharacter::Tick_UpdateHealth(float DeltaTime)
 {
-	if (CurrentHealth < MaxHealth)
-	{
-		CurrentHealth = FMath::Clamp(CurrentHealth + (HealthRestoreRate * DeltaTime), 0.f, MaxHealth);
-	}
+	if (CurrentHealth >= MaxHealth)
+		return;
+
+	const float newHealth = FMath::Clamp(CurrentHealth + (HealthRestoreRate * DeltaTime), 0.f, MaxHealth);
+
+	//AS: Regen only tells listeners when the displayed whole number changes (or health tops out), not every frame
+	if (FMath::FloorToInt(newHealth) != FMath::FloorToInt(CurrentHealth) || newHealth >= MaxHealth)
+		SetCurrentHealth(newHealth);
+	else
+		CurrentHealth = newHealth;
 }
 
 void AAshForestCharacter::DeflectProjectile(AActor* HitProjectile)
@@ -1429,35 +1746,167 @@ void AAshForestCharacter::DeflectProjectile(AActor* HitProjectile)
 			deflectDir = CurrentDashDir;
 
 		auto deflectedVel = (DashSpeed * .5f) * deflectDir;
-		((AAshForestProjectile*)HitProjectile)->OnDeflected(this, deflectedVel);
+		auto projectile = (AAshForestProjectile*)HitProjectile;
+		projectile->OnDeflected(this, deflectedVel);
+
+		if (GetNetMode() == NM_Standalone)
+			return;
+
+		if (projectile->IsAuthoritativeCopy())
+			MulticastProjectileDeflected(projectile->MakeDeflectEvent(this));
+		else if (IsLocallyControlled())
+		{
+			//AS: Predicted on our simulated copy, the server rewinds its copy to when we saw the hit and confirms or ignores it
+			auto gameState = GetWorld()->GetGameState();
+			ServerDeflectProjectile(projectile->GetNetProjectileId(), gameState ? gameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds());
+		}
 	}
 }
 
+bool AAshForestCharacter::ServerDeflectProjectile_Validate(uint16 ProjectileId, float ClientServerTime)
+{
+	return true;
+}
+
+void AAshForestCharacter::ServerDeflectProjectile_Implementation(uint16 ProjectileId, float ClientServerTime)
+{
+	auto projectile = AAshForestProjectile::FindByNetId(GetWorld(), ProjectileId);
+
+	//AS: Already exploded, or our own dash sweep on the server got there first
+	if (!projectile || projectile->GetInstigator() == this)
+		return;
+
+	const float now = GetWorld()->GetTimeSeconds();
+	const float rewindTime = FMath::Clamp(ClientServerTime, now - MaxDeflectRewindTime, now);
+
+	//AS: The dash must have been running at the time the client claims the hit happened
+	if (!IsDashing() && LastDashEndTime < rewindTime)
+		return;
+
+	//AS: Both sides are rewound, the projectile has to have been inside our dash sweep at that time
+	const FVector rewoundLoc = projectile->GetRewoundLocation(rewindTime);
+
+	FVector sweepStart;
+	FVector sweepEnd;
+	GetRewoundDashSweep(rewindTime, sweepStart, sweepEnd);
+
+	//AS: The dash sweep is 15 wider than the capsule, see Tick_Dash
+	const float tolerance = GetCapsuleComponent()->GetScaledCapsuleRadius() + 15.f + projectile->GetCollisionComponent()->GetScaledCapsuleRadius() + DeflectRewindTolerance;
+	const float dist = FMath::PointDistToSegment(rewoundLoc, sweepStart, sweepEnd);
+
+	if (dist > tolerance)
+	{
+		UE_LOG(LogAshForest, Verbose, TEXT("%s: rejected deflection of projectile %u, %.0f away from our dash at rewind (tolerance %.0f)"), *GetName(), ProjectileId, dist, tolerance);
+		return;
+	}
+
+	DeflectProjectile(projectile);
+}
+
+void AAshForestCharacter::RecordRewindSample()
+{
+	FRewindSample sample;
+	sample.Location = GetActorLocation();
+	sample.SweepEnd = IsDashing() ? sample.Location + (OriginalDashDir * DashDistance_Current) : sample.Location;
+
+	RewindHistory.Record(GetWorld()->GetTimeSeconds(), sample, CharacterRewindInterval);
+}
+
+void AAshForestCharacter::GetRewoundDashSweep(const float ServerTime, FVector & OutStart, FVector & OutEnd) const
+{
+	FRewindSample sample;
+
+	if (RewindHistory.GetAtTime(ServerTime, sample))
+	{
+		OutStart = sample.Location;
+		OutEnd = sample.SweepEnd;
+		return;
+	}
+
+	//AS: Newer than the newest sample, use where we are now
+	OutStart = OutEnd = GetActorLocation();
+
+	if (IsDashing())
+		OutEnd = OutStart + (OriginalDashDir * DashDistance_Current);
+}
+
+void AAshForestCharacter::MulticastProjectileDeflected_Implementation(const FAshProjectileDeflectEvent & DeflectEvent)
+{
+	if (GetNetMode() != NM_Client)
+		return;
+
+	if (auto projectile = AAshForestProjectile::FindByNetId(GetWorld(), DeflectEvent.ProjectileId))
+		projectile->ApplyDeflectEvent(DeflectEvent);
+}
+
 void AAshForestCharacter::OnKilledEnemy(AActor* KilledEnemy)
 {
-	if (!KilledEnemy || !KilledEnemy->GetClass()->ImplementsInterface(UTargetableInterface::StaticClass()))
+	if (!KilledEnemy || !FAshInterfaceDispatch::IsTargetable(KilledEnemy))
 		return;
 
 	USceneComponent* killedTargetComp = NULL;
-	TArray<USceneComponent*> comps;
-	if (ITargetableInterface::Execute_GetTargetableComponents(KilledEnemy, comps))
+	if (FAshInterfaceDispatch::GetTargetableComponents(KilledEnemy, TargetableCompsScratch))
 	{
-		if (comps.Num() == 1)
-			killedTargetComp = comps[0];
+		if (TargetableCompsScratch.Num() == 1)
+			killedTargetComp = TargetableCompsScratch[0];
 		else
 			return;
 	}
 
+	//AS: Kills from one damage pass reselect once when it's over, starting from our current target if it was one of them
+	auto& damageQueue = FAshDamageQueue::Get();
+	if (damageQueue.IsResolving())
+	{
+		if (!bHasPendingKilledTarget || (killedTargetComp && killedTargetComp == LockOnTarget_Current))
+			PendingKilledTarget = killedTargetComp;
+
+		bHasPendingKilledTarget = true;
+		damageQueue.AddKillListener(this);
+		return;
+	}
+
 	AutoSwitchLockOnTarget(killedTargetComp);
 }
 
+void AAshForestCharacter::ResolveKilledEnemies()
+{
+	if (!bHasPendingKilledTarget)
+		return;
+
+	bHasPendingKilledTarget = false;
+
+	//AS: The re-query can be a full overlap + traces, but the camera shouldn't sit on a dead target for long
+	TWeakObjectPtr<USceneComponent> killedTarget = PendingKilledTarget;
+	PendingKilledTarget.Reset();
+
+	FAshJobQueue::Get().Post(this, TEXT("LockOnReselect"), EAshJobPriority::EAshJob_HIGH, .05f, [this, killedTarget]()
+	{
+		AutoSwitchLockOnTarget(killedTarget.Get(true));
+	});
+}
+
 void AAshForestCharacter::AutoSwitchLockOnTarget(USceneComponent* OldTarget /*= NULL*/)
 {
 	if (LockOnTarget_Current == OldTarget)
 	{
+		//AS: The nearest neighbors of the old target on either side are the best replacement, only re-query if neither works
+		USceneComponent* ringTarget = NULL;
+
+		if (OldTarget && LockOnRing.Find(OldTarget) != INDEX_NONE)
+		{
+			float leftKey = -MAX_FLT;
+			float rightKey = -MAX_FLT;
+			auto leftTarget = FindLockOnRingNeighbor(OldTarget, -1, true, &leftKey);
+			auto rightTarget = FindLockOnRingNeighbor(OldTarget, 1, true, &rightKey);
+
+			ringTarget = rightKey > leftKey ? rightTarget : leftTarget;
+		}
+
 		SetLockOnTarget(NULL);
 
-		if (OldTarget)
+		if (ringTarget)
+			SetLockOnTarget(ringTarget);
+		else if (OldTarget)
 			SetLockOnTarget(FindLockOnTarget(true, (OldTarget->GetComponentLocation() - GetActorLocation()).GetSafeNormal2D().Rotation()));
 		else
 			SetLockOnTarget(FindLockOnTarget(false));
@@ -1483,7 +1932,17 @@ void AAshForestCharacter::OnTouchCheckpoint(AActor* Checkpoint)
 			LatestCheckpoint = Checkpoint;
 			LatestCheckpointIndex = index;
 
-			OnCheckpointUpdated();
+			//AS: Snapshot capture and the checkpoint UI don't need to land on the exact touch frame
+			FAshJobQueue::Get().Post(this, TEXT("CheckpointUpdated"), EAshJobPriority::EAshJob_LOW, .5f, [this]()
+			{
+				if (auto gameMode = GetWorld()->GetAuthGameMode<AAshForestGameMode>())
+				{
+					gameMode->CaptureCheckpointSnapshot();
+					FAshSaveSystem::Get().RequestSave(GetWorld());
+				}
+
+				OnCheckpointUpdated();
+			});
 		}
 	}
 }
@@ -1493,11 +1952,31 @@ void AAshForestCharacter::OnCheckpointUpdated_Implementation()
 
 }
 
+void AAshForestCharacter::RestoreSavedProgress(AActor* Checkpoint, const int32 CheckpointIndex, const int32 SmolMoniez, const int32 BigUnitMoniez)
+{
+	if (!Checkpoint || !Checkpoint->IsA(AAshForestCheckpoint::StaticClass()))
+		return;
+
+	LatestCheckpoint = Checkpoint;
+	LatestCheckpointIndex = CheckpointIndex;
+
+	Respawn();
+
+	//AS: After the respawn so the level snapshot it restores can't overwrite them
+	CurrentSmolMoniez = SmolMoniez;
+	CurrentBigUnitMoniez = BigUnitMoniez;
+}
+
 void AAshForestCharacter::Respawn()
 {
 	if (LatestCheckpoint)
 	{
-		CurrentHealth = MaxHealth;
+		//AS: Level state goes back first, that includes our money counters (back to what we had at the checkpoint, matching
+		//	  the collectables it un-collects). Health is reset below so it wins over the snapshot
+		if (auto gameMode = GetWorld()->GetAuthGameMode<AAshForestGameMode>())
+			gameMode->RestoreCheckpointSnapshot();
+
+		SetCurrentHealth(MaxHealth);
 
 		auto newTrans = ((AAshForestCheckpoint*)LatestCheckpoint)->GetRespawnTransform();
 		newTrans.SetScale3D(FVector(1.f));
@@ -0,0 +1,417 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestCharacterMovement.h"
+#include "AshForest.h"
+#include "AshForestCharacter.h"
+#include "AshForestDebugDraw.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Client Corrections"), STAT_AshNetCorrections, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Dash Starts Received"), STAT_AshNetDashStarts, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Dash Starts Rejected"), STAT_AshNetDashRejected, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Move State Mismatches"), STAT_AshNetStateMismatches, STATGROUP_AshForest);
+
+//AS: Compressed flag bits, FLAG_Custom_0..3 are free for game use
+static const uint8 AshFlag_DashStart = FSavedMove_Character::FLAG_Custom_0;
+static const uint8 AshFlag_MoveStateShift = 5;
+static const uint8 AshFlag_MoveStateMask = FSavedMove_Character::FLAG_Custom_1 | FSavedMove_Character::FLAG_Custom_2;
+
+static_assert(FSavedMove_Character::FLAG_Custom_1 == (1 << AshFlag_MoveStateShift), "Move state bits must start at FLAG_Custom_1");
+static_assert(EAshCustomMoveState::EAshMove_MAX <= 4, "Move state has to fit in two compressed flag bits");
+
+static uint32 GAshNetCorrections = 0;
+static uint32 GAshNetDashStarts = 0;
+static uint32 GAshNetDashRejected = 0;
+static uint32 GAshNetStateMismatches = 0;
+
+static FAutoConsoleCommand AshForestNetMoveStatsCmd(
+	TEXT("AshForest.NetMoveStats"),
+	TEXT("Prints client corrections received, dash starts received/rejected by the server and moves where the client's move state disagreed with the server's"),
+	FConsoleCommandDelegate::CreateStatic([]()
+	{
+		UAshForestCharacterMovement::LogNetStats();
+	}));
+
+UAshForestCharacterMovement::UAshForestCharacterMovement()
+{
+	AshMoveState = EAshCustomMoveState::EAshMove_NONE;
+	CustomStateVelocity = FVector::ZeroVector;
+	bDashStartPending = false;
+	DashTimeRemaining = 0.f;
+	AirLockTimeRemaining = 0.f;
+	bAirLockNoAirControl = false;
+	PendingVelocity = FVector::ZeroVector;
+	PendingLocation = FVector::ZeroVector;
+	bHasPendingVelocity = false;
+	bHasPendingLocation = false;
+	bSweepPendingLocation = false;
+	ClientAshMoveState = EAshCustomMoveState::EAshMove_NONE;
+}
+
+AAshForestCharacter* UAshForestCharacterMovement::GetAshOwner() const
+{
+	return Cast<AAshForestCharacter>(CharacterOwner);
+}
+
+FNetworkPredictionData_Client* UAshForestCharacterMovement::GetPredictionData_Client() const
+{
+	if (!ClientPredictionData)
+	{
+		auto mutableThis = const_cast<UAshForestCharacterMovement*>(this);
+		mutableThis->ClientPredictionData = new FNetworkPredictionData_Client_AshForest(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UAshForestCharacterMovement::SetAshMoveState(const uint8 NewMoveState)
+{
+	AshMoveState = NewMoveState;
+
+	if (!IsInCustomState())
+		CustomStateVelocity = FVector::ZeroVector;
+
+	if (AshMoveState != EAshCustomMoveState::EAshMove_DASHING)
+		DashTimeRemaining = 0.f;
+}
+
+void UAshForestCharacterMovement::SetCustomStateVelocity(const FVector & NewVelocity)
+{
+	CustomStateVelocity = NewVelocity;
+	Velocity = NewVelocity;
+}
+
+void UAshForestCharacterMovement::StartDashTimer(const float Duration)
+{
+	DashTimeRemaining = Duration;
+}
+
+void UAshForestCharacterMovement::StartAirLock(const float Duration, const bool bNoAirControl)
+{
+	AirLockTimeRemaining = Duration;
+	bAirLockNoAirControl = bNoAirControl;
+}
+
+void UAshForestCharacterMovement::SetPendingVelocity(const FVector & NewVelocity)
+{
+	PendingVelocity = NewVelocity;
+	bHasPendingVelocity = true;
+}
+
+void UAshForestCharacterMovement::SetPendingLocation(const FVector & NewLocation, const bool bSweep /*= false*/)
+{
+	PendingLocation = NewLocation;
+	bHasPendingLocation = true;
+	bSweepPendingLocation = bSweep;
+}
+
+void UAshForestCharacterMovement::ApplyPendingChanges()
+{
+	if (bHasPendingLocation)
+	{
+		auto owner = GetAshOwner();
+
+		//AS: The mesh is only smoothed for the real move, a replay just has to end up in the same place
+		if (owner && !CharacterOwner->bClientUpdating)
+			owner->SoftSetActorLocation(PendingLocation, bSweepPendingLocation);
+		else
+			UpdatedComponent->SetWorldLocation(PendingLocation, bSweepPendingLocation, NULL, ETeleportType::TeleportPhysics);
+
+		bHasPendingLocation = false;
+	}
+
+	if (bHasPendingVelocity)
+	{
+		Velocity = PendingVelocity;
+		bHasPendingVelocity = false;
+	}
+}
+
+void UAshForestCharacterMovement::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	//AS: Only the start is acted on, the move state bits are the client's view and only feed the mismatch count in UpdateCharacterStateBeforeMovement
+	bDashStartPending = (Flags & AshFlag_DashStart) != 0;
+	ClientAshMoveState = (Flags & AshFlag_MoveStateMask) >> AshFlag_MoveStateShift;
+}
+
+void UAshForestCharacterMovement::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	auto owner = GetAshOwner();
+
+	//AS: Server side of a predicted dash, the client sends the dash direction as its acceleration for this move
+	if (bDashStartPending && owner && CharacterOwner->Role == ROLE_Authority && !CharacterOwner->IsLocallyControlled())
+	{
+		GAshNetDashStarts++;
+		INC_DWORD_STAT(STAT_AshNetDashStarts);
+
+		if (!owner->IsDashing() && !owner->TryDashInDirection(Acceleration.GetSafeNormal2D()))
+		{
+			//AS: Out of charges or on cooldown as far as the server knows, the client gets corrected
+			GAshNetDashRejected++;
+			INC_DWORD_STAT(STAT_AshNetDashRejected);
+		}
+
+		bDashStartPending = false;
+	}
+
+	//AS: Counted rather than corrected, the client's state changes land a frame apart from the server's and the position check already covers the result
+	if (CharacterOwner->Role == ROLE_Authority && !CharacterOwner->IsLocallyControlled() && ClientAshMoveState != AshMoveState)
+	{
+		GAshNetStateMismatches++;
+		INC_DWORD_STAT(STAT_AshNetStateMismatches);
+
+		UE_LOG(LogAshForest, Verbose, TEXT("%s: client move state %u, server %u"), *CharacterOwner->GetName(), ClientAshMoveState, AshMoveState);
+	}
+
+	if (IsInCustomState() && !CustomStateVelocity.IsZero())
+		Velocity = CustomStateVelocity;
+
+	ApplyPendingChanges();
+}
+
+void UAshForestCharacterMovement::UpdateCharacterStateAfterMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateAfterMovement(DeltaSeconds);
+
+	//AS: The move that carried the start has been made (and saved), the flag must not leak into the next one
+	if (CharacterOwner && CharacterOwner->IsLocallyControlled())
+		bDashStartPending = false;
+
+	if (!CharacterOwner || CharacterOwner->Role == ROLE_SimulatedProxy)
+		return;
+
+	if (AirLockTimeRemaining > 0.f)
+		AirLockTimeRemaining -= DeltaSeconds;
+
+	if (AshMoveState == EAshCustomMoveState::EAshMove_DASHING)
+	{
+		DashTimeRemaining -= DeltaSeconds;
+
+		//AS: A replay of this move finds the end already saved in the move after it, only the real move ends the dash
+		if (DashTimeRemaining <= 0.f && !CharacterOwner->bClientUpdating)
+		{
+			if (auto owner = GetAshOwner())
+			{
+				ASH_DEBUG_MESSAGE(Dash, FColor::Orange, TEXT("END DASH (REACHED MAX TIME)"));
+
+				owner->EndDash();
+			}
+		}
+	}
+}
+
+void UAshForestCharacterMovement::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	//AS: Landing ends the wall jump air lock early
+	if (IsMovingOnGround())
+		AirLockTimeRemaining = 0.f;
+}
+
+float UAshForestCharacterMovement::GetGravityZ() const
+{
+	if (AshMoveState == EAshCustomMoveState::EAshMove_DASHING)
+		return 0.f;
+
+	return Super::GetGravityZ();
+}
+
+float UAshForestCharacterMovement::GetMaxSpeed() const
+{
+	auto owner = GetAshOwner();
+
+	if (AshMoveState == EAshCustomMoveState::EAshMove_DASHING && owner)
+		return owner->DashSpeed;
+
+	return Super::GetMaxSpeed();
+}
+
+FVector UAshForestCharacterMovement::GetAirControl(float DeltaTime, float TickAirControl, const FVector& FallAcceleration)
+{
+	if (AirLockTimeRemaining > 0.f && bAirLockNoAirControl)
+		return FVector::ZeroVector;
+
+	return Super::GetAirControl(DeltaTime, TickAirControl, FallAcceleration);
+}
+
+void UAshForestCharacterMovement::CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration)
+{
+	//AS: Dash/climb velocity is applied before movement, no friction or braking on top of it
+	if (IsInCustomState() && !CustomStateVelocity.IsZero())
+		return;
+
+	//AS: A wall jump keeps its full sideways speed while the air lock lasts
+	if (AirLockTimeRemaining > 0.f && IsFalling())
+		Friction = 0.f;
+
+	Super::CalcVelocity(DeltaTime, Friction, bFluid, BrakingDeceleration);
+}
+
+FVector UAshForestCharacterMovement::ConstrainInputAcceleration(const FVector& InputAcceleration) const
+{
+	//AS: While dashing the acceleration sent to the server is the dash direction, that's how the server learns it
+	if (AshMoveState == EAshCustomMoveState::EAshMove_DASHING && !CustomStateVelocity.IsZero())
+		return Super::ConstrainInputAcceleration(CustomStateVelocity.GetSafeNormal() * GetMaxAcceleration());
+
+	return Super::ConstrainInputAcceleration(InputAcceleration);
+}
+
+void UAshForestCharacterMovement::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase,
+	FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
+{
+	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+
+	GAshNetCorrections++;
+	INC_DWORD_STAT(STAT_AshNetCorrections);
+}
+
+bool UAshForestCharacterMovement::ClientUpdatePositionAfterServerUpdate()
+{
+	//AS: Corrections only cover position/velocity, the live custom state (including anything the owner queued since the last move) has to survive the replays
+	const uint8 moveState = AshMoveState;
+	const FVector customStateVelocity = CustomStateVelocity;
+	const float dashTimeRemaining = DashTimeRemaining;
+	const float airLockTimeRemaining = AirLockTimeRemaining;
+	const bool bNoAirControl = bAirLockNoAirControl;
+	const FVector pendingVelocity = PendingVelocity;
+	const FVector pendingLocation = PendingLocation;
+	const bool bHadPendingVelocity = bHasPendingVelocity;
+	const bool bHadPendingLocation = bHasPendingLocation;
+	const bool bSweepLocation = bSweepPendingLocation;
+
+	const bool bResult = Super::ClientUpdatePositionAfterServerUpdate();
+
+	AshMoveState = moveState;
+	CustomStateVelocity = customStateVelocity;
+	DashTimeRemaining = dashTimeRemaining;
+	AirLockTimeRemaining = airLockTimeRemaining;
+	bAirLockNoAirControl = bNoAirControl;
+	PendingVelocity = pendingVelocity;
+	PendingLocation = pendingLocation;
+	bHasPendingVelocity = bHadPendingVelocity;
+	bHasPendingLocation = bHadPendingLocation;
+	bSweepPendingLocation = bSweepLocation;
+
+	return bResult;
+}
+
+bool UAshForestCharacterMovement::HasUnacknowledgedDashMoves() const
+{
+	if (bDashStartPending)
+		return true;
+
+	auto clientData = (FNetworkPredictionData_Client_Character*)ClientPredictionData;
+	if (!clientData)
+		return false;
+
+	for (const auto& move : clientData->SavedMoves)
+	{
+		if (move.IsValid() && ((FSavedMove_AshForest*)move.Get())->bSavedDashStart)
+			return true;
+	}
+
+	return clientData->PendingMove.IsValid() && ((FSavedMove_AshForest*)clientData->PendingMove.Get())->bSavedDashStart;
+}
+
+void UAshForestCharacterMovement::LogNetStats()
+{
+	UE_LOG(LogAshForest, Log, TEXT("Net movement: %u client corrections, %u dash starts received by the server, %u rejected, %u move state mismatches"),
+		GAshNetCorrections, GAshNetDashStarts, GAshNetDashRejected, GAshNetStateMismatches);
+}
+
+void FSavedMove_AshForest::Clear()
+{
+	Super::Clear();
+
+	SavedAshMoveState = EAshCustomMoveState::EAshMove_NONE;
+	bSavedDashStart = false;
+	SavedCustomStateVelocity = FVector::ZeroVector;
+	SavedDashTimeRemaining = 0.f;
+	SavedAirLockTimeRemaining = 0.f;
+	bSavedAirLockNoAirControl = false;
+	SavedPendingVelocity = FVector::ZeroVector;
+	SavedPendingLocation = FVector::ZeroVector;
+	bSavedHasPendingVelocity = false;
+	bSavedHasPendingLocation = false;
+	bSavedSweepPendingLocation = false;
+}
+
+uint8 FSavedMove_AshForest::GetCompressedFlags() const
+{
+	uint8 flags = Super::GetCompressedFlags();
+
+	if (bSavedDashStart)
+		flags |= AshFlag_DashStart;
+
+	flags |= (SavedAshMoveState << AshFlag_MoveStateShift) & AshFlag_MoveStateMask;
+	return flags;
+}
+
+bool FSavedMove_AshForest::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	auto newAshMove = (FSavedMove_AshForest*)NewMove.Get();
+
+	if (bSavedDashStart || newAshMove->bSavedDashStart || SavedAshMoveState != newAshMove->SavedAshMoveState)
+		return false;
+
+	//AS: A combined move would make a one-shot change at the wrong time, and the air lock switching off mid-move would be lost
+	if (bSavedHasPendingVelocity || bSavedHasPendingLocation || newAshMove->bSavedHasPendingVelocity || newAshMove->bSavedHasPendingLocation)
+		return false;
+
+	if ((SavedAirLockTimeRemaining > 0.f) != (newAshMove->SavedAirLockTimeRemaining > 0.f))
+		return false;
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_AshForest::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character & ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (auto movement = Cast<UAshForestCharacterMovement>(C->GetCharacterMovement()))
+	{
+		SavedAshMoveState = movement->AshMoveState;
+		bSavedDashStart = movement->bDashStartPending;
+		SavedCustomStateVelocity = movement->CustomStateVelocity;
+		SavedDashTimeRemaining = movement->DashTimeRemaining;
+		SavedAirLockTimeRemaining = movement->AirLockTimeRemaining;
+		bSavedAirLockNoAirControl = movement->bAirLockNoAirControl;
+		SavedPendingVelocity = movement->PendingVelocity;
+		SavedPendingLocation = movement->PendingLocation;
+		bSavedHasPendingVelocity = movement->bHasPendingVelocity;
+		bSavedHasPendingLocation = movement->bHasPendingLocation;
+		bSavedSweepPendingLocation = movement->bSweepPendingLocation;
+	}
+}
+
+void FSavedMove_AshForest::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (auto movement = Cast<UAshForestCharacterMovement>(C->GetCharacterMovement()))
+	{
+		movement->AshMoveState = SavedAshMoveState;
+		movement->CustomStateVelocity = SavedCustomStateVelocity;
+		movement->DashTimeRemaining = SavedDashTimeRemaining;
+		movement->AirLockTimeRemaining = SavedAirLockTimeRemaining;
+		movement->bAirLockNoAirControl = bSavedAirLockNoAirControl;
+		movement->PendingVelocity = SavedPendingVelocity;
+		movement->PendingLocation = SavedPendingLocation;
+		movement->bHasPendingVelocity = bSavedHasPendingVelocity;
+		movement->bHasPendingLocation = bSavedHasPendingLocation;
+		movement->bSweepPendingLocation = bSavedSweepPendingLocation;
+
+		//AS: Replays mustn't re-send the dash start
+		movement->bDashStartPending = false;
+	}
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_AshForest::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_AshForest());
+}
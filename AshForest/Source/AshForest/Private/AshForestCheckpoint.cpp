@@ -2,13 +2,22 @@
 
 #include "AshForestCheckpoint.h"
 #include "AshForestCharacter.h"
+#include "AshForestMemory.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
 
 AAshForestCheckpoint::AAshForestCheckpoint()
 {
-	OnActorBeginOverlap.AddDynamic(this, &AAshForestCheckpoint::OnOverlapBegin);
-	OnActorEndOverlap.AddDynamic(this, &AAshForestCheckpoint::OnOverlapEnd);
+	ASH_LLM_SCOPE(TRIGGERS);
+
+	//AS: Player capsule tests come from FAshPlayerVolumes, nothing needs to overlap us
+	GetCollisionComponent()->SetGenerateOverlapEvents(false);
+	GetCollisionComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 
 	CheckpointIndex = -1;
+
+	//AS: Nothing to replicate, touching a checkpoint only changes the player. Keeps them out of the net driver's actor list entirely
+	bReplicates = false;
 }
 
 bool AAshForestCheckpoint::TryUpdatePlayerCheckpoint(class AActor* ForActor)
@@ -22,14 +31,26 @@ bool AAshForestCheckpoint::TryUpdatePlayerCheckpoint(class AActor* ForActor)
 	return false;
 }
 
-void AAshForestCheckpoint::OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor)
+void AAshForestCheckpoint::BeginPlay()
 {
-	if (OtherActor && OtherActor != this)
-		TryUpdatePlayerCheckpoint(OtherActor);
+	Super::BeginPlay();
+
+	FAshPlayerVolumes::Get().Register(this, Cast<UBoxComponent>(GetCollisionComponent()), this);
 }
 
-void AAshForestCheckpoint::OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor)
+void AAshForestCheckpoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (OtherActor && OtherActor != this)
-		TryUpdatePlayerCheckpoint(OtherActor);
-}
\ No newline at end of file
+	FAshPlayerVolumes::Get().Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAshForestCheckpoint::OnPlayerEnterVolume(AAshForestCharacter* Player)
+{
+	TryUpdatePlayerCheckpoint(Player);
+}
+
+void AAshForestCheckpoint::OnPlayerExitVolume(AAshForestCharacter* Player)
+{
+	TryUpdatePlayerCheckpoint(Player);
+}
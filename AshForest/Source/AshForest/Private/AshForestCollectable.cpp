@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestCollectable.h"
+#include "Components/SphereComponent.h"
+#include "AshForestCharacter.h"
+#include "AshForestMemory.h"
+#include "AshForestNetPolicy.h"
+#include "Net/UnrealNetwork.h"
+
+// Sets default values
+AAshForestCollectable::AAshForestCollectable()
+{
+	ASH_LLM_SCOPE(COLLECTABLES);
+
+	PrimaryActorTick.bCanEverTick = false;
+
+	PickupComp = CreateDefaultSubobject<USphereComponent>("PickupComp");
+	if (PickupComp)
+	{
+		RootComponent = PickupComp;
+		PickupComp->InitSphereRadius(60.f);
+		PickupComp->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+		PickupComp->OnComponentBeginOverlap.AddDynamic(this, &AAshForestCollectable::OnPickupOverlap);
+	}
+
+	SmolMoniezValue = 1;
+	BigUnitMoniezValue = 0;
+
+	bReplicates = true;
+	FAshNetPolicy::InitStaticActor(this);
+}
+
+void AAshForestCollectable::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FAshNetPolicy::ApplyLevelRelevancy(this);
+}
+
+void AAshForestCollectable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AAshForestCollectable, bCollected);
+}
+
+bool AAshForestCollectable::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	FAshNetPolicy::NoteConsidered(this);
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+bool AAshForestCollectable::Collect(AAshForestCharacter* ByCharacter)
+{
+	//AS: Pickups are the server's call, clients see them through the replicated bCollected
+	if (bCollected || !ByCharacter || !HasAuthority())
+		return false;
+
+	FAshNetPolicy::Flush(this);
+	bCollected = true;
+
+	ByCharacter->CurrentSmolMoniez += SmolMoniezValue;
+	ByCharacter->CurrentBigUnitMoniez += BigUnitMoniezValue;
+
+	RefreshCollectedState();
+	OnCollected(ByCharacter);
+
+	return true;
+}
+
+void AAshForestCollectable::RefreshCollectedState()
+{
+	SetActorHiddenInGame(bCollected);
+	SetActorEnableCollision(!bCollected);
+}
+
+void AAshForestCollectable::OnCollected_Implementation(AAshForestCharacter* ByCharacter)
+{
+
+}
+
+void AAshForestCollectable::OnPickupOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
+{
+	auto character = Cast<AAshForestCharacter>(OtherActor);
+	if (!character)
+		return;
+
+	Collect(character);
+}
@@ -2,14 +2,19 @@
 
 #include "AshForestCreature.h"
 #include "AshForestCharacter.h"
+#include "AshForestMemory.h"
+#include "Engine/AssetManager.h"
 
 // Sets default values
 AAshForestCreature::AAshForestCreature()
 {
+	ASH_LLM_SCOPE(CREATURES);
+
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
 	MaxHealth = 250.f;
+	bRetireOnDeath = true;
 
 	bAllowAttacking = true;
 
@@ -17,14 +22,23 @@ AAshForestCreature::AAshForestCreature()
 	AttackInterval_MAX = 4.f;
 }
 
+void AAshForestCreature::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//AS: Usually already resident through the map's preload list, in which case this completes immediately
+	if (!AttackProjectileClass.IsNull())
+		AttackProjectileHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AttackProjectileClass.ToSoftObjectPath());
+}
+
 bool AAshForestCreature::CanBeTargeted_Implementation(const AActor* ByActor)
 {
-	return ByActor->IsA(AAshForestCharacter::StaticClass());
+	return !bIsRetired && ByActor->IsA(AAshForestCharacter::StaticClass());
 }
 
 bool AAshForestCreature::CanBeDamaged_Implementation(const AActor* DamageCauser, const FHitResult & DamageHitEvent)
 {
-	return DamageCauser->IsA(AAshForestCharacter::StaticClass());
+	return !bIsRetired && DamageCauser->IsA(AAshForestCharacter::StaticClass());
 }
 
 void AAshForestCreature::OnTargetableDeath_Implementation(const AActor* Murderer)
@@ -35,7 +49,7 @@ void AAshForestCreature::OnTargetableDeath_Implementation(const AActor* Murderer
 
 bool AAshForestCreature::CanAttackTarget_Implementation(const AActor* ForTarget)
 {
-	return bAllowAttacking && AttackProjectileClass != NULL && ForTarget != NULL && GetWorld()->TimeSince(LastAttackTime) > CurrentAttackInterval;
+	return bAllowAttacking && !bIsRetired && AttackProjectileClass.Get() != NULL && ForTarget != NULL && GetWorld()->TimeSince(LastAttackTime) > CurrentAttackInterval;
 }
 
 FTransform AAshForestCreature::GetAttackOrigin_Implementation(const AActor* ForTarget)
@@ -48,23 +62,36 @@ FTransform AAshForestCreature::GetAttackOrigin_Implementation(const AActor* ForT
 
 void AAshForestCreature::AttackTarget(const AActor* ForTarget)
 {
-	if (AttackProjectileClass == NULL || ForTarget == NULL)
+	UClass* projectileClass = AttackProjectileClass.Get();
+	if (projectileClass == NULL || ForTarget == NULL)
 		return;
 
 	LastAttackTime = GetWorld()->GetTimeSeconds();
 	CurrentAttackInterval = FMath::RandRange(AttackInterval_MIN, AttackInterval_MAX);
-	
+
 	const FTransform spawnTrans = GetAttackOrigin(ForTarget);
-	auto temp = GetWorld()->SpawnActorDeferred<AAshForestProjectile>(AttackProjectileClass.Get(), spawnTrans, (AActor*)this, (APawn*)this, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
-	temp->InitProjectile(this);
-	temp->FinishSpawning(spawnTrans, true);
 
-	if (temp->IsValidLowLevel())
+	FAshProjectileSpawnParams spawnParams;
+	spawnParams.Origin = spawnTrans.GetLocation();
+	spawnParams.Direction = spawnTrans.GetRotation().Vector();
+
+	if (auto projectile = AAshForestProjectile::SpawnFromParams(GetWorld(), projectileClass, this, spawnParams))
 	{
-		LastFiredProjectile = temp;
+		LastFiredProjectile = projectile;
 
-		//AS: Reset To fix any directional errors caused by adjusting the spawn location
-		const FTransform spawnTrans = GetAttackOrigin(ForTarget);
-		LastFiredProjectile->SetActorTransform(spawnTrans);
+		if (GetNetMode() != NM_Standalone)
+			MulticastFireProjectile(spawnParams);
 	}
-}
\ No newline at end of file
+}
+
+void AAshForestCreature::MulticastFireProjectile_Implementation(const FAshProjectileSpawnParams & Params)
+{
+	//AS: The server already has the authoritative copy
+	if (GetNetMode() != NM_Client)
+		return;
+
+	FAshProjectileSpawnParams spawnParams = Params;
+
+	if (auto projectile = AAshForestProjectile::SpawnFromParams(GetWorld(), AttackProjectileClass.Get(), this, spawnParams))
+		LastFiredProjectile = projectile;
+}
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestDamageQueue.h"
+#include "AshForest.h"
+#include "AshForestInterfaceDispatch.h"
+#include "AshForestCharacter.h"
+#include "DamageableCharacter.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_AshDamageResolve, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Queued"), STAT_AshDamageQueued, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Applied"), STAT_AshDamageApplied, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Coalesced"), STAT_AshDamageCoalesced, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Deaths"), STAT_AshDamageDeaths, STATGROUP_AshForest);
+
+//AS: Damage dealt while resolving (chain reactions) is picked up in the same frame up to this many extra passes
+static const int32 MaxResolvePasses = 4;
+
+static FAutoConsoleCommand AshForestDamageStatsCmd(
+	TEXT("AshForest.DamageStats"),
+	TEXT("Prints damage queue throughput. Pass 'reset' to clear"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		FAshDamageQueue::Get().LogStats();
+
+		if (Args.Contains(TEXT("reset")))
+			FAshDamageQueue::Get().ResetStats();
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs AshForestDamageStressCmd(
+	TEXT("AshForest.DamageStress"),
+	TEXT("AshForest.DamageStress [Radius] [Amount] [Repeats]: queues damage from the player on every targetable actor in range, like one big AoE"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		auto player = UGameplayStatics::GetPlayerPawn(World, 0);
+		if (!player)
+			return;
+
+		const float radius = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 5000.f;
+		const float amount = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.f;
+		const int32 repeats = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 1;
+
+		FHitResult hit;
+		int32 numTargets = 0;
+
+		for (TActorIterator<AActor> it(World); it; ++it)
+		{
+			if (*it == player || !FAshInterfaceDispatch::IsTargetable(*it) || FVector::DistSquared(it->GetActorLocation(), player->GetActorLocation()) > FMath::Square(radius))
+				continue;
+
+			hit.Location = hit.ImpactPoint = it->GetActorLocation();
+
+			for (int32 i = 0; i < repeats; i++)
+				FAshDamageQueue::Get().Enqueue(*it, player, amount, hit);
+
+			numTargets++;
+		}
+
+		UE_LOG(LogAshForest, Log, TEXT("Queued %d damage records on %d targets"), numTargets * repeats, numTargets);
+	}));
+
+FAshDamageQueue & FAshDamageQueue::Get()
+{
+	static FAshDamageQueue instance;
+	return instance;
+}
+
+FAshDamageQueue::FAshDamageQueue()
+	: bResolving(false)
+{
+	ResetStats();
+}
+
+void FAshDamageQueue::Enqueue(AActor* Target, const AActor* DamageCauser, const float DamageAmount, const FHitResult & DamageHitEvent)
+{
+	check(IsInGameThread());
+
+	if (!Target || !FAshInterfaceDispatch::IsTargetable(Target))
+		return;
+
+	TotalQueued++;
+	INC_DWORD_STAT(STAT_AshDamageQueued);
+
+	//AS: The same causer hitting the same target again this frame (several components, dash + overlap) becomes one bigger hit
+	for (int32 i = Pending.Num() - 1; i >= 0; i--)
+	{
+		auto& record = Pending[i];
+
+		if (record.Target == Target && record.Causer == DamageCauser)
+		{
+			record.Amount += DamageAmount;
+
+			TotalCoalesced++;
+			INC_DWORD_STAT(STAT_AshDamageCoalesced);
+			return;
+		}
+	}
+
+	auto& record = Pending[Pending.AddDefaulted()];
+	record.World = Target->GetWorld();
+	record.Target = Target;
+	record.Causer = DamageCauser;
+	record.Amount = DamageAmount;
+	record.Hit = DamageHitEvent;
+}
+
+void FAshDamageQueue::AddKillListener(AAshForestCharacter* Character)
+{
+	KillListeners.AddUnique(Character);
+}
+
+static bool IsDead(AActor* Target)
+{
+	if (Target->IsPendingKill())
+		return true;
+
+	auto damageable = Cast<ADamageableCharacter>(Target);
+	return damageable && damageable->IsRetired();
+}
+
+void FAshDamageQueue::Resolve(UWorld* World)
+{
+	if (Pending.Num() <= 0 || bResolving)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_AshDamageResolve);
+
+	const double startTime = FPlatformTime::Seconds();
+	bResolving = true;
+
+	for (int32 pass = 0; pass < MaxResolvePasses && Pending.Num() > 0; pass++)
+	{
+		//AS: Records for other worlds (PIE clients) stay queued for their own resolve
+		Resolving.Reset();
+
+		for (int32 i = Pending.Num() - 1; i >= 0; i--)
+		{
+			if (Pending[i].World == World || !Pending[i].World.IsValid())
+			{
+				Resolving.Add(Pending[i]);
+				Pending.RemoveAtSwap(i, 1, false);
+			}
+		}
+
+		PeakBatch = FMath::Max(PeakBatch, Resolving.Num());
+
+		//AS: Collected back to front above, apply in the order the hits happened
+		for (int32 i = Resolving.Num() - 1; i >= 0; i--)
+		{
+			const auto& record = Resolving[i];
+			auto target = record.Target.Get();
+
+			//AS: Projectiles explode in the same frame they hit, they only need to survive until this pass, not GC
+			auto causer = record.Causer.Get(true);
+
+			if (!target || !causer || IsDead(target))
+			{
+				TotalDropped++;
+				continue;
+			}
+
+			FAshInterfaceDispatch::TakeDamage(target, causer, record.Amount, record.Hit);
+
+			TotalApplied++;
+			INC_DWORD_STAT(STAT_AshDamageApplied);
+
+			if (IsDead(target))
+			{
+				TotalDeaths++;
+				INC_DWORD_STAT(STAT_AshDamageDeaths);
+			}
+		}
+	}
+
+	bResolving = false;
+
+	for (auto& listener : KillListeners)
+	{
+		if (listener.IsValid())
+			listener->ResolveKilledEnemies();
+	}
+
+	KillListeners.Reset();
+
+	WorstResolveMs = FMath::Max(WorstResolveMs, (FPlatformTime::Seconds() - startTime) * 1000.0);
+}
+
+void FAshDamageQueue::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Damage queue: %llu queued, %llu applied, %llu coalesced, %llu dropped (target/causer gone), %llu deaths"),
+		TotalQueued, TotalApplied, TotalCoalesced, TotalDropped, TotalDeaths);
+	UE_LOG(LogAshForest, Log, TEXT("  peak batch %d records, worst resolve %.3fms, %d still pending"), PeakBatch, WorstResolveMs, Pending.Num());
+}
+
+void FAshDamageQueue::ResetStats()
+{
+	TotalQueued = 0;
+	TotalApplied = 0;
+	TotalCoalesced = 0;
+	TotalDropped = 0;
+	TotalDeaths = 0;
+	PeakBatch = 0;
+	WorstResolveMs = 0.0;
+}
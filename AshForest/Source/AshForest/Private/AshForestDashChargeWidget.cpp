@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestDashChargeWidget.h"
+#include "AshForestCharacter.h"
+
+void UAshForestDashChargeWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	DisplayedCharges = -1;
+	DisplayedMaxCharges = -1;
+
+	BoundCharacter = GetOwningAshCharacter();
+
+	if (BoundCharacter.IsValid())
+	{
+		BoundCharacter->OnDashChargesChanged.AddDynamic(this, &UAshForestDashChargeWidget::HandleDashChargesChanged);
+		HandleDashChargesChanged(BoundCharacter->GetDashCharges(), BoundCharacter->GetMaxDashCharges());
+	}
+}
+
+void UAshForestDashChargeWidget::NativeDestruct()
+{
+	if (BoundCharacter.IsValid())
+		BoundCharacter->OnDashChargesChanged.RemoveDynamic(this, &UAshForestDashChargeWidget::HandleDashChargesChanged);
+
+	BoundCharacter = NULL;
+
+	Super::NativeDestruct();
+}
+
+void UAshForestDashChargeWidget::HandleDashChargesChanged(int32 CurrentCharges, int32 MaxCharges)
+{
+	if (CurrentCharges == DisplayedCharges && MaxCharges == DisplayedMaxCharges)
+		return;
+
+	DisplayedCharges = CurrentCharges;
+	DisplayedMaxCharges = MaxCharges;
+
+	OnDashChargesUpdated(CurrentCharges, MaxCharges);
+	MarkContentChanged();
+}
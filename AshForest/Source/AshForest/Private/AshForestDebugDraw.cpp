@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestDebugDraw.h"
+
+#if ASH_DEBUG_DRAW_ENABLED
+
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+int32 GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_MAX] = { 0 };
+bool GAshDebugDrawForceAll = false;
+
+static FAutoConsoleVariableRef CVarAshDebugDash(TEXT("ash.Debug.Dash"), GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_DASH], TEXT("Draw dash sweeps, redirects and hits."), ECVF_Cheat);
+static FAutoConsoleVariableRef CVarAshDebugClimb(TEXT("ash.Debug.Climb"), GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_CLIMB], TEXT("Draw climbing and wall running state."), ECVF_Cheat);
+static FAutoConsoleVariableRef CVarAshDebugLedge(TEXT("ash.Debug.Ledge"), GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_LEDGE], TEXT("Draw ledge grab traces."), ECVF_Cheat);
+static FAutoConsoleVariableRef CVarAshDebugLockOn(TEXT("ash.Debug.LockOn"), GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_LOCKON], TEXT("Draw lock-on queries and candidates."), ECVF_Cheat);
+static FAutoConsoleVariableRef CVarAshDebugCamera(TEXT("ash.Debug.Camera"), GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_CAMERA], TEXT("Draw camera focus targets."), ECVF_Cheat);
+
+namespace AshDebugDraw
+{
+	enum EPrimitiveType : uint8
+	{
+		Prim_Line,
+		Prim_Sphere,
+		Prim_Capsule,
+	};
+
+	struct FPrimitive
+	{
+		TWeakObjectPtr<const UWorld> World;
+		FQuat Rotation;
+		FVector A;
+		FVector B;
+		FColor Color;
+		float Radius;
+		float HalfHeight;
+		float Thickness;
+		float TimeRemaining;
+		EPrimitiveType Type;
+		bool bLive;
+	};
+
+	struct FMessage
+	{
+		FString Text;
+		FColor Color;
+		float LifeTime;
+		bool bPending;
+	};
+
+	//AS: Fixed capacity, the oldest entries get overwritten once the buffer wraps
+	static const int32 MaxPrimitives = 1024;
+	static const int32 MaxMessages = 16;
+	static const uint64 MessageKeyBase = 0xA5F0000;
+
+	static FPrimitive Primitives[MaxPrimitives];
+	static int32 NextPrimitive = 0;
+
+	static FMessage Messages[MaxMessages];
+	static int32 NextMessage = 0;
+
+	static FPrimitive& Allocate(const UWorld* World, const EPrimitiveType Type, const FColor & Color, const float LifeTime, const float Thickness)
+	{
+		FPrimitive& prim = Primitives[NextPrimitive];
+		NextPrimitive = (NextPrimitive + 1) % MaxPrimitives;
+
+		prim.World = World;
+		prim.Type = Type;
+		prim.Color = Color;
+		prim.TimeRemaining = LifeTime;
+		prim.Thickness = Thickness;
+		prim.bLive = true;
+
+		return prim;
+	}
+}
+
+static int32 GAshDebugDrawForceAllCount = 0;
+
+void FAshDebugDraw::PushForceAllCategories()
+{
+	GAshDebugDrawForceAllCount++;
+	GAshDebugDrawForceAll = true;
+}
+
+void FAshDebugDraw::PopForceAllCategories()
+{
+	GAshDebugDrawForceAllCount = FMath::Max(GAshDebugDrawForceAllCount - 1, 0);
+	GAshDebugDrawForceAll = GAshDebugDrawForceAllCount > 0;
+}
+
+void FAshDebugDraw::Line(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Start, const FVector & End, const FColor & Color, const float LifeTime /*= 0.f*/, const float Thickness /*= 0.f*/)
+{
+	auto& prim = AshDebugDraw::Allocate(World, AshDebugDraw::Prim_Line, Color, LifeTime, Thickness);
+	prim.A = Start;
+	prim.B = End;
+}
+
+void FAshDebugDraw::Sphere(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Center, const float Radius, const FColor & Color, const float LifeTime /*= 0.f*/, const float Thickness /*= 0.f*/)
+{
+	auto& prim = AshDebugDraw::Allocate(World, AshDebugDraw::Prim_Sphere, Color, LifeTime, Thickness);
+	prim.A = Center;
+	prim.Radius = Radius;
+}
+
+void FAshDebugDraw::Capsule(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Center, const float HalfHeight, const float Radius, const FQuat & Rotation, const FColor & Color, const float LifeTime /*= 0.f*/, const float Thickness /*= 0.f*/)
+{
+	auto& prim = AshDebugDraw::Allocate(World, AshDebugDraw::Prim_Capsule, Color, LifeTime, Thickness);
+	prim.A = Center;
+	prim.Radius = Radius;
+	prim.HalfHeight = HalfHeight;
+	prim.Rotation = Rotation;
+}
+
+void FAshDebugDraw::Message(const EAshDebugCategory::Type Category, FString && Text, const FColor & Color, const float LifeTime /*= 3.f*/)
+{
+	auto& msg = AshDebugDraw::Messages[AshDebugDraw::NextMessage];
+	AshDebugDraw::NextMessage = (AshDebugDraw::NextMessage + 1) % AshDebugDraw::MaxMessages;
+
+	msg.Text = MoveTemp(Text);
+	msg.Color = Color;
+	msg.LifeTime = LifeTime;
+	msg.bPending = true;
+}
+
+void FAshDebugDraw::Render(UWorld* World, const float DeltaTime)
+{
+	if (!World)
+		return;
+
+	for (auto& prim : AshDebugDraw::Primitives)
+	{
+		if (!prim.bLive || prim.World.Get() != World)
+			continue;
+
+		//AS: Always draw as single frame primitives, the ring buffer owns the lifetime
+		switch (prim.Type)
+		{
+		case AshDebugDraw::Prim_Line:
+			DrawDebugLine(World, prim.A, prim.B, prim.Color, false, -1.f, 0, prim.Thickness);
+			break;
+		case AshDebugDraw::Prim_Sphere:
+			DrawDebugSphere(World, prim.A, prim.Radius, 16, prim.Color, false, -1.f, 0, prim.Thickness);
+			break;
+		case AshDebugDraw::Prim_Capsule:
+			DrawDebugCapsule(World, prim.A, prim.HalfHeight, prim.Radius, prim.Rotation, prim.Color, false, -1.f, 0, prim.Thickness);
+			break;
+		default:
+			break;
+		}
+
+		prim.TimeRemaining -= DeltaTime;
+		prim.bLive = prim.TimeRemaining > 0.f;
+	}
+
+	if (!GEngine)
+		return;
+
+	//AS: Messages are keyed by ring slot so a debug session can never show more than MaxMessages lines
+	for (int32 i = 0; i < AshDebugDraw::MaxMessages; i++)
+	{
+		auto& msg = AshDebugDraw::Messages[i];
+
+		if (!msg.bPending)
+			continue;
+
+		GEngine->AddOnScreenDebugMessage(AshDebugDraw::MessageKeyBase + i, msg.LifeTime, msg.Color, msg.Text);
+		msg.bPending = false;
+	}
+}
+
+void FAshDebugDraw::Clear(const UWorld* World /*= NULL*/)
+{
+	for (auto& prim : AshDebugDraw::Primitives)
+	{
+		if (!World || prim.World.Get() == World || !prim.World.IsValid())
+			prim.bLive = false;
+	}
+}
+
+#endif
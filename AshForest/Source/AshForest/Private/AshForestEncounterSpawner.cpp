@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestEncounterSpawner.h"
+#include "AshForest.h"
+#include "AshForestCreature.h"
+#include "AshForestMemory.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Encounter Pool Spawn"), STAT_AshEncounterPoolSpawn, STATGROUP_AshForest);
+DECLARE_CYCLE_STAT(TEXT("Encounter Activate"), STAT_AshEncounterActivate, STATGROUP_AshForest);
+
+static FAutoConsoleCommandWithWorld AshForestEncounterStatsCmd(
+	TEXT("AshForest.EncounterStats"),
+	TEXT("Prints pool state and worst per-frame step time of every encounter spawner"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		for (TActorIterator<AAshForestEncounterSpawner> it(World); it; ++it)
+			it->LogEncounterStats();
+	}));
+
+AAshForestEncounterSpawner::AAshForestEncounterSpawner()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+
+	PoolSize = 8;
+	bAllowPoolGrowth = true;
+	FrameBudgetMs = 1.f;
+	PoolParkingOffset = FVector(0.f, 0.f, -5000.f);
+
+	PendingPrewarm = 0;
+	PendingActivations = 0;
+	NextSpawnPointIndex = 0;
+	WorstStepMs = 0.0;
+}
+
+void AAshForestEncounterSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!CreatureClass)
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("%s: no creature class, spawner disabled"), *GetName());
+		return;
+	}
+
+	PendingPrewarm = PoolSize;
+	SetActorTickEnabled(PendingPrewarm > 0);
+}
+
+void AAshForestEncounterSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (auto currCreature : FreeCreatures)
+	{
+		if (currCreature)
+		{
+			currCreature->OnRetired.RemoveDynamic(this, &AAshForestEncounterSpawner::OnCreatureRetired);
+			currCreature->OnDestroyed.RemoveDynamic(this, &AAshForestEncounterSpawner::OnCreatureDestroyed);
+		}
+	}
+
+	for (auto currCreature : ActiveCreatures)
+	{
+		if (currCreature)
+		{
+			currCreature->OnRetired.RemoveDynamic(this, &AAshForestEncounterSpawner::OnCreatureRetired);
+			currCreature->OnDestroyed.RemoveDynamic(this, &AAshForestEncounterSpawner::OnCreatureDestroyed);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAshForestEncounterSpawner::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double startTime = FPlatformTime::Seconds();
+	const double budgetSeconds = FrameBudgetMs / 1000.0;
+
+	//AS: Activations first while there are free creatures, building the pool only competes when nothing is waiting on it
+	while (PendingActivations > 0 || PendingPrewarm > 0)
+	{
+		const double stepStart = FPlatformTime::Seconds();
+
+		if (PendingActivations > 0 && FreeCreatures.Num() > 0)
+		{
+			ActivateCreature(FreeCreatures.Pop(false));
+			PendingActivations--;
+		}
+		else if (PendingPrewarm > 0 || (PendingActivations > 0 && bAllowPoolGrowth))
+		{
+			if (!SpawnPooledCreature())
+			{
+				PendingPrewarm = 0;
+				PendingActivations = 0;
+				break;
+			}
+
+			if (PendingPrewarm > 0)
+				PendingPrewarm--;
+		}
+		else
+		{
+			UE_LOG(LogAshForest, Warning, TEXT("%s: pool exhausted, dropping %d activations"), *GetName(), PendingActivations);
+			PendingActivations = 0;
+		}
+
+		const double now = FPlatformTime::Seconds();
+		WorstStepMs = FMath::Max(WorstStepMs, (now - stepStart) * 1000.0);
+
+		if (now - startTime >= budgetSeconds)
+			break;
+	}
+
+	if (PendingActivations <= 0 && PendingPrewarm <= 0)
+		SetActorTickEnabled(false);
+}
+
+AAshForestCreature* AAshForestEncounterSpawner::SpawnPooledCreature()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshEncounterPoolSpawn);
+	ASH_LLM_SCOPE(CREATURES);
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.Owner = this;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	//AS: Construction, controller spawn/possession and BT startup all happen here, once, away from the wave
+	auto creature = GetWorld()->SpawnActor<AAshForestCreature>(CreatureClass, GetActorTransform().TransformPosition(PoolParkingOffset), GetActorRotation(), spawnParams);
+	if (!creature)
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("%s: failed to spawn %s"), *GetName(), *CreatureClass->GetName());
+		return NULL;
+	}
+
+	//AS: AutoPossessAI defaults to placed-in-world only, so a spawned creature has no brain unless we give it one
+	if (!creature->GetController())
+		creature->SpawnDefaultController();
+
+	creature->Retire();
+	creature->OnRetired.AddDynamic(this, &AAshForestEncounterSpawner::OnCreatureRetired);
+	creature->OnDestroyed.AddDynamic(this, &AAshForestEncounterSpawner::OnCreatureDestroyed);
+
+	FreeCreatures.Add(creature);
+	return creature;
+}
+
+FTransform AAshForestEncounterSpawner::GetNextSpawnTransform()
+{
+	if (SpawnPoints.Num() <= 0)
+		return GetActorTransform();
+
+	const FTransform& point = SpawnPoints[NextSpawnPointIndex++ % SpawnPoints.Num()];
+	return point * GetActorTransform();
+}
+
+void AAshForestEncounterSpawner::ActivateCreature(AAshForestCreature* Creature)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshEncounterActivate);
+
+	if (!Creature || Creature->IsPendingKill())
+		return;
+
+	const FTransform spawnTrans = GetNextSpawnTransform();
+	Creature->SetActorLocationAndRotation(spawnTrans.GetLocation(), spawnTrans.GetRotation(), false, NULL, ETeleportType::TeleportPhysics);
+	Creature->Revive();
+
+	ActiveCreatures.Add(Creature);
+	OnCreatureActivated(Creature);
+}
+
+void AAshForestEncounterSpawner::OnCreatureRetired(AActor* RetiredActor)
+{
+	auto creature = Cast<AAshForestCreature>(RetiredActor);
+
+	if (!creature || ActiveCreatures.RemoveSwap(creature) <= 0)
+		return;
+
+	//AS: Out of the way so a hidden creature never blocks traces or overlaps at its death spot
+	creature->SetActorLocation(GetActorTransform().TransformPosition(PoolParkingOffset), false, NULL, ETeleportType::TeleportPhysics);
+	FreeCreatures.Add(creature);
+}
+
+void AAshForestEncounterSpawner::OnCreatureDestroyed(AActor* DestroyedActor)
+{
+	auto creature = Cast<AAshForestCreature>(DestroyedActor);
+	if (!creature)
+		return;
+
+	ActiveCreatures.RemoveSwap(creature);
+	FreeCreatures.RemoveSwap(creature);
+}
+
+void AAshForestEncounterSpawner::SpawnWave(const int32 Count)
+{
+	if (!CreatureClass || Count <= 0)
+		return;
+
+	PendingActivations += Count;
+	SetActorTickEnabled(true);
+}
+
+void AAshForestEncounterSpawner::ReturnAllToPool()
+{
+	PendingActivations = 0;
+
+	//AS: Retire broadcasts OnRetired which removes the creature from ActiveCreatures
+	while (ActiveCreatures.Num() > 0)
+	{
+		auto creature = ActiveCreatures.Last();
+
+		if (creature && !creature->IsRetired())
+			creature->Retire();
+		else
+			ActiveCreatures.Pop(false);
+	}
+}
+
+void AAshForestEncounterSpawner::LogEncounterStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("%s: %d active, %d pooled, %d activations and %d pool spawns pending, worst step %.3fms (budget %.2fms)"),
+		*GetName(), ActiveCreatures.Num(), FreeCreatures.Num(), PendingActivations, PendingPrewarm, WorstStepMs, FrameBudgetMs);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestFrameScratch.h"
+#include "AshForest.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_MEMORY_STAT(TEXT("Frame Scratch Used"), STAT_AshFrameScratchBytes, STATGROUP_AshForest);
+DECLARE_MEMORY_STAT(TEXT("Frame Scratch Peak"), STAT_AshFrameScratchPeakBytes, STATGROUP_AshForest);
+
+static FAutoConsoleCommand AshForestScratchStatsCmd(
+	TEXT("AshForest.ScratchStats"),
+	TEXT("Prints frame scratch usage, including how many frames had to grow the arena past its previous peak"),
+	FConsoleCommandDelegate::CreateStatic([]()
+	{
+		FAshFrameScratch::Get().LogStats();
+	}));
+
+FAshFrameScratch & FAshFrameScratch::Get()
+{
+	static FAshFrameScratch instance;
+	return instance;
+}
+
+FAshFrameScratch::FAshFrameScratch()
+	: Stack(1), LastFrameBytes(0), PeakFrameBytes(0), NumGrowthFrames(0), LastGrowthFrame(0)
+{
+	new (&FrameMark) FMemMark(Stack);
+}
+
+FAshFrameScratch::~FAshFrameScratch()
+{
+	//AS: FrameMark is raw storage, so the mark has to be popped by hand before Stack goes away
+	FrameMark.GetTypedPtr()->~FMemMark();
+}
+
+void FAshFrameScratch::EndFrame()
+{
+	check(IsInGameThread());
+
+	LastFrameBytes = Stack.GetByteCount();
+
+	//AS: A frame that needed more than any before it is the only time new pages get pulled in
+	if (LastFrameBytes > PeakFrameBytes)
+	{
+		PeakFrameBytes = LastFrameBytes;
+		NumGrowthFrames++;
+		LastGrowthFrame = GFrameCounter;
+	}
+
+	SET_MEMORY_STAT(STAT_AshFrameScratchBytes, LastFrameBytes);
+	SET_MEMORY_STAT(STAT_AshFrameScratchPeakBytes, PeakFrameBytes);
+
+	FrameMark.GetTypedPtr()->~FMemMark();
+	new (&FrameMark) FMemMark(Stack);
+}
+
+void FAshFrameScratch::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Frame scratch: %d bytes last frame, %d peak, grew on %u frames (last growth %llu frames ago)"),
+		LastFrameBytes, PeakFrameBytes, NumGrowthFrames, GFrameCounter - LastGrowthFrame);
+}
@@ -0,0 +1,665 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestGhost.h"
+#include "AshForest.h"
+#include "Async/MappedFileHandle.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ghost Playback"), STAT_AshGhostPlayback, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ghosts Playing"), STAT_AshGhostsPlaying, STATGROUP_AshForest);
+
+static_assert(EAshCustomMoveState::EAshMove_MAX <= 4, "Ghost samples store the move state in 2 bits");
+
+static FAutoConsoleCommandWithWorldAndArgs AshForestGhostRecordCmd(
+	TEXT("AshForest.GhostRecord"),
+	TEXT("Starts recording the player as a ghost (optional name, 'Ghost' by default), or stops and saves it if already recording"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		auto player = Cast<AAshForestCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+		if (!player)
+			return;
+
+		auto recorder = player->FindComponentByClass<UAshForestGhostRecorder>();
+		if (!recorder)
+		{
+			recorder = NewObject<UAshForestGhostRecorder>(player, TEXT("GhostRecorder"));
+			recorder->RegisterComponent();
+		}
+
+		if (recorder->IsRecording())
+			recorder->StopRecording(true);
+		else
+			recorder->StartRecording(Args.Num() > 0 ? Args[0] : TEXT("Ghost"));
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs AshForestGhostPlayCmd(
+	TEXT("AshForest.GhostPlay"),
+	TEXT("Spawns a ghost for every name given and plays them back together"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		auto player = Cast<AAshForestCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+
+		for (const auto& ghostName : Args)
+		{
+			auto ghost = AAshForestGhost::SpawnGhost(World, ghostName, NULL);
+
+			//AS: The plain class has no mesh of its own, borrow the player's so there is something to look at
+			if (ghost && player && player->GetMesh())
+				ghost->Mesh->SetSkeletalMesh(player->GetMesh()->SkeletalMesh);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld AshForestGhostClearCmd(
+	TEXT("AshForest.GhostClear"),
+	TEXT("Destroys every ghost in the world"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		for (TActorIterator<AAshForestGhost> it(World); it; ++it)
+			it->Destroy();
+	}));
+
+static FAutoConsoleCommandWithWorld AshForestGhostStatsCmd(
+	TEXT("AshForest.GhostStats"),
+	TEXT("Prints active ghost recordings and playing ghosts with their stream sizes"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		for (TActorIterator<AAshForestCharacter> it(World); it; ++it)
+		{
+			if (auto recorder = it->FindComponentByClass<UAshForestGhostRecorder>())
+				recorder->LogStats();
+		}
+
+		for (TActorIterator<AAshForestGhost> it(World); it; ++it)
+			it->LogStats();
+	}));
+
+//AS: =========================================================================
+//AS: Codec
+//AS: =========================================================================
+
+namespace EAshGhostFlags
+{
+	enum Type
+	{
+		EAshGhost_MOVE_STATE_MASK	= 0x03,
+		EAshGhost_WALL_RUNNING		= 0x04,
+		EAshGhost_DASHED			= 0x08,
+		EAshGhost_SAME_VELOCITY		= 0x10,
+		EAshGhost_SAME_YAW			= 0x20,
+		EAshGhost_KEY				= 0x40
+	};
+}
+
+static FORCEINLINE uint32 ZigZag(const int32 Value)
+{
+	return ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+}
+
+static FORCEINLINE int32 UnZigZag(const uint32 Value)
+{
+	return (int32)(Value >> 1) ^ -(int32)(Value & 1);
+}
+
+static void WriteVarInt(uint32 Value, TArray<uint8> & Out)
+{
+	while (Value >= 0x80)
+	{
+		Out.Add((uint8)(Value | 0x80));
+		Value >>= 7;
+	}
+
+	Out.Add((uint8)Value);
+}
+
+static bool ReadVarInt(const uint8* Data, const int64 Size, int64 & Cursor, uint32 & OutValue)
+{
+	OutValue = 0;
+
+	for (int32 shift = 0; shift < 35; shift += 7)
+	{
+		if (Cursor >= Size)
+			return false;
+
+		const uint8 byte = Data[Cursor++];
+		OutValue |= (uint32)(byte & 0x7f) << shift;
+
+		if (!(byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+static bool ReadIntVector(const uint8* Data, const int64 Size, int64 & Cursor, FIntVector & OutVector)
+{
+	uint32 x, y, z;
+	if (!ReadVarInt(Data, Size, Cursor, x) || !ReadVarInt(Data, Size, Cursor, y) || !ReadVarInt(Data, Size, Cursor, z))
+		return false;
+
+	OutVector = FIntVector(UnZigZag(x), UnZigZag(y), UnZigZag(z));
+	return true;
+}
+
+void FAshGhostCodec::Reset()
+{
+	Position = FIntVector::ZeroValue;
+	Velocity = FIntVector::ZeroValue;
+	Yaw = 0;
+	bHasKey = false;
+}
+
+void FAshGhostCodec::Encode(const FAshGhostSample& Sample, TArray<uint8> & Out)
+{
+	uint8 flags = (Sample.MoveState & EAshGhostFlags::EAshGhost_MOVE_STATE_MASK)
+		| (Sample.bWallRunning ? EAshGhostFlags::EAshGhost_WALL_RUNNING : 0)
+		| (Sample.bDashed ? EAshGhostFlags::EAshGhost_DASHED : 0);
+
+	//AS: The first sample is absolute, everything after it is relative to what the decoder will have rebuilt
+	if (!bHasKey)
+	{
+		Out.Add(flags | EAshGhostFlags::EAshGhost_KEY);
+		WriteVarInt(ZigZag(Sample.Position.X), Out);
+		WriteVarInt(ZigZag(Sample.Position.Y), Out);
+		WriteVarInt(ZigZag(Sample.Position.Z), Out);
+		WriteVarInt(Sample.Yaw, Out);
+
+		Position = Sample.Position;
+		Velocity = FIntVector::ZeroValue;
+		Yaw = Sample.Yaw;
+		bHasKey = true;
+		return;
+	}
+
+	const FIntVector delta = Sample.Position - Position;
+	const FIntVector accel = delta - Velocity;
+	const int16 yawDelta = (int16)(Sample.Yaw - Yaw);
+
+	if (accel == FIntVector::ZeroValue)
+		flags |= EAshGhostFlags::EAshGhost_SAME_VELOCITY;
+
+	if (yawDelta == 0)
+		flags |= EAshGhostFlags::EAshGhost_SAME_YAW;
+
+	Out.Add(flags);
+
+	if (!(flags & EAshGhostFlags::EAshGhost_SAME_VELOCITY))
+	{
+		WriteVarInt(ZigZag(accel.X), Out);
+		WriteVarInt(ZigZag(accel.Y), Out);
+		WriteVarInt(ZigZag(accel.Z), Out);
+	}
+
+	if (!(flags & EAshGhostFlags::EAshGhost_SAME_YAW))
+		WriteVarInt(ZigZag(yawDelta), Out);
+
+	Position = Sample.Position;
+	Velocity = delta;
+	Yaw = Sample.Yaw;
+}
+
+bool FAshGhostCodec::Decode(const uint8* Data, const int64 Size, int64 & Cursor, FAshGhostSample & OutSample)
+{
+	if (Cursor >= Size)
+		return false;
+
+	const uint8 flags = Data[Cursor++];
+
+	if (flags & EAshGhostFlags::EAshGhost_KEY)
+	{
+		uint32 yaw;
+		if (!ReadIntVector(Data, Size, Cursor, Position) || !ReadVarInt(Data, Size, Cursor, yaw))
+			return false;
+
+		Velocity = FIntVector::ZeroValue;
+		Yaw = (uint16)yaw;
+		bHasKey = true;
+	}
+	else
+	{
+		if (!bHasKey)
+			return false;
+
+		if (!(flags & EAshGhostFlags::EAshGhost_SAME_VELOCITY))
+		{
+			FIntVector accel;
+			if (!ReadIntVector(Data, Size, Cursor, accel))
+				return false;
+
+			Velocity = Velocity + accel;
+		}
+
+		if (!(flags & EAshGhostFlags::EAshGhost_SAME_YAW))
+		{
+			uint32 yawDelta;
+			if (!ReadVarInt(Data, Size, Cursor, yawDelta))
+				return false;
+
+			Yaw = (uint16)(Yaw + UnZigZag(yawDelta));
+		}
+
+		Position = Position + Velocity;
+	}
+
+	OutSample.Position = Position;
+	OutSample.Yaw = Yaw;
+	OutSample.MoveState = flags & EAshGhostFlags::EAshGhost_MOVE_STATE_MASK;
+	OutSample.bWallRunning = (flags & EAshGhostFlags::EAshGhost_WALL_RUNNING) != 0;
+	OutSample.bDashed = (flags & EAshGhostFlags::EAshGhost_DASHED) != 0;
+	return true;
+}
+
+//AS: =========================================================================
+//AS: Stream
+//AS: =========================================================================
+
+FAshGhostStream::FAshGhostStream()
+	: MappedHandle(NULL), MappedRegion(NULL), Data(NULL), Size(0), Cursor(0), SampleRate(0), NumSamples(0)
+{
+}
+
+FAshGhostStream::~FAshGhostStream()
+{
+	Close();
+}
+
+bool FAshGhostStream::Open(const FString & FileName)
+{
+	Close();
+
+	//AS: Mapped reads keep the stream out of the heap entirely, only the pages being played get touched
+	MappedHandle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FileName);
+
+	if (MappedHandle && MappedHandle->GetFileSize() > 0)
+		MappedRegion = MappedHandle->MapRegion(0, MappedHandle->GetFileSize());
+
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		delete MappedHandle;
+		MappedHandle = NULL;
+
+		if (!FFileHelper::LoadFileToArray(LoadedData, *FileName, FILEREAD_Silent))
+			return false;
+
+		Data = LoadedData.GetData();
+		Size = LoadedData.Num();
+	}
+
+	uint32 magic = 0;
+	uint16 version = 0;
+	uint16 sampleRate = 0;
+	uint32 numSamples = 0;
+
+	if (Size >= FAshGhostCodec::HeaderSize)
+	{
+		FMemory::Memcpy(&magic, Data, sizeof(magic));
+		FMemory::Memcpy(&version, Data + 4, sizeof(version));
+		FMemory::Memcpy(&sampleRate, Data + 6, sizeof(sampleRate));
+		FMemory::Memcpy(&numSamples, Data + 8, sizeof(numSamples));
+	}
+
+	if (magic != FAshGhostCodec::Magic || version != FAshGhostCodec::Version || sampleRate == 0)
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("%s is not a ghost file this build can play"), *FileName);
+		Close();
+		return false;
+	}
+
+	SampleRate = sampleRate;
+	NumSamples = (int32)numSamples;
+	Rewind();
+	return true;
+}
+
+void FAshGhostStream::Close()
+{
+	//AS: The region has to go before the handle it was mapped from
+	delete MappedRegion;
+	MappedRegion = NULL;
+	delete MappedHandle;
+	MappedHandle = NULL;
+
+	LoadedData.Empty();
+	Data = NULL;
+	Size = 0;
+	Cursor = 0;
+	SampleRate = 0;
+	NumSamples = 0;
+}
+
+void FAshGhostStream::Rewind()
+{
+	Cursor = FAshGhostCodec::HeaderSize;
+	Codec.Reset();
+}
+
+bool FAshGhostStream::ReadNext(FAshGhostSample & OutSample)
+{
+	return Data && Codec.Decode(Data, Size, Cursor, OutSample);
+}
+
+//AS: =========================================================================
+//AS: Recorder
+//AS: =========================================================================
+
+UAshForestGhostRecorder::UAshForestGhostRecorder()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	SampleRate = 30;
+	MaxRecordingSeconds = 600.f;
+
+	NumSamples = 0;
+	SampleAccumulator = 0.f;
+	LastDashStartTime = 0.f;
+	bRecording = false;
+}
+
+FString UAshForestGhostRecorder::GetGhostPath(const FString & GhostName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Ghosts") / GhostName + TEXT(".ghost");
+}
+
+void UAshForestGhostRecorder::StartRecording(const FString & GhostName)
+{
+	auto character = Cast<AAshForestCharacter>(GetOwner());
+	if (!character)
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("%s: ghosts can only be recorded from an AAshForestCharacter"), *GetName());
+		return;
+	}
+
+	SampleRate = FMath::Clamp(SampleRate, 1, (int32)MAX_uint16);
+	RecordingName = GhostName;
+
+	//AS: A few bytes per sample, reserve roughly a minute up front
+	Buffer.Reset();
+	Buffer.Reserve(SampleRate * 60 * 4);
+	Codec.Reset();
+
+	NumSamples = 0;
+	SampleAccumulator = 0.f;
+	LastDashStartTime = character->GetLastDashStartTime();
+	bRecording = true;
+
+	WriteSample(character);
+	SetComponentTickEnabled(true);
+}
+
+FString UAshForestGhostRecorder::StopRecording(const bool bSave /*= true*/)
+{
+	if (!bRecording)
+		return FString();
+
+	bRecording = false;
+	SetComponentTickEnabled(false);
+
+	if (!bSave || NumSamples <= 0)
+		return FString();
+
+	const uint32 magic = FAshGhostCodec::Magic;
+	const uint16 version = FAshGhostCodec::Version;
+	const uint16 sampleRate = (uint16)SampleRate;
+	const uint32 numSamples = (uint32)NumSamples;
+
+	TArray<uint8> fileData;
+	fileData.SetNumZeroed(FAshGhostCodec::HeaderSize);
+	FMemory::Memcpy(fileData.GetData(), &magic, sizeof(magic));
+	FMemory::Memcpy(fileData.GetData() + 4, &version, sizeof(version));
+	FMemory::Memcpy(fileData.GetData() + 6, &sampleRate, sizeof(sampleRate));
+	FMemory::Memcpy(fileData.GetData() + 8, &numSamples, sizeof(numSamples));
+	fileData.Append(Buffer);
+
+	const FString path = GetGhostPath(RecordingName);
+
+	if (!FFileHelper::SaveArrayToFile(fileData, *path))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to write ghost to %s"), *path);
+		return FString();
+	}
+
+	const float minutes = (float)NumSamples / (float)SampleRate / 60.f;
+	UE_LOG(LogAshForest, Log, TEXT("Saved ghost %s: %d samples, %.1f KB (%.1f KB/min)"), *path, NumSamples, fileData.Num() / 1024.f, minutes > 0.f ? (fileData.Num() / 1024.f) / minutes : 0.f);
+
+	Buffer.Empty();
+	return path;
+}
+
+void UAshForestGhostRecorder::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	auto character = Cast<AAshForestCharacter>(GetOwner());
+	if (!bRecording || !character)
+		return;
+
+	//AS: Fixed rate so playback never needs timestamps, a hitch just repeats the current state
+	const float interval = 1.f / SampleRate;
+	SampleAccumulator += DeltaTime;
+
+	while (SampleAccumulator >= interval)
+	{
+		SampleAccumulator -= interval;
+		WriteSample(character);
+	}
+
+	if (NumSamples >= MaxRecordingSeconds * SampleRate)
+		StopRecording(true);
+}
+
+void UAshForestGhostRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording(true);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UAshForestGhostRecorder::WriteSample(const AAshForestCharacter* Character)
+{
+	const FVector location = Character->GetActorLocation();
+
+	FAshGhostSample sample;
+	sample.Position = FIntVector(FMath::RoundToInt(location.X), FMath::RoundToInt(location.Y), FMath::RoundToInt(location.Z));
+	sample.Yaw = FRotator::CompressAxisToShort(Character->GetActorRotation().Yaw);
+	sample.MoveState = (uint8)Character->GetCurrentAshMoveState();
+	sample.bWallRunning = Character->IsWallRunning();
+
+	//AS: Chained dashes never leave the dashing state, the start time is what tells them apart
+	if (Character->GetLastDashStartTime() != LastDashStartTime)
+	{
+		LastDashStartTime = Character->GetLastDashStartTime();
+		sample.bDashed = true;
+	}
+
+	Codec.Encode(sample, Buffer);
+	NumSamples++;
+}
+
+void UAshForestGhostRecorder::LogStats() const
+{
+	const float minutes = SampleRate > 0 ? (float)NumSamples / (float)SampleRate / 60.f : 0.f;
+
+	UE_LOG(LogAshForest, Log, TEXT("Recorder %s on %s: %s, %d samples (%.1fs), %.1f KB (%.1f KB/min)"), *RecordingName, *GetOwner()->GetName(), bRecording ? TEXT("recording") : TEXT("idle"),
+		NumSamples, minutes * 60.f, Buffer.Num() / 1024.f, minutes > 0.f ? (Buffer.Num() / 1024.f) / minutes : 0.f);
+}
+
+//AS: =========================================================================
+//AS: Ghost
+//AS: =========================================================================
+
+AAshForestGhost::AAshForestGhost()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	Root->SetMobility(EComponentMobility::Movable);
+	RootComponent = Root;
+
+	//AS: Same offset as the character's mesh, samples are the capsule centre
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	Mesh->SetupAttachment(Root);
+	Mesh->SetRelativeLocationAndRotation(FVector(0.f, 0.f, -90.f), FRotator(0.f, -90.f, 0.f));
+	Mesh->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->SetCanEverAffectNavigation(false);
+	Mesh->CanCharacterStepUpOn = ECB_No;
+	Mesh->bReceivesDecals = false;
+	Mesh->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered;
+
+	SetActorEnableCollision(false);
+
+	PlaybackRate = 1.f;
+	bLoop = false;
+	MoveState = EAshCustomMoveState::EAshMove_NONE;
+	bIsWallRunning = false;
+	Speed = 0.f;
+
+	NextSampleIndex = 0;
+	PlaybackTime = 0.f;
+	bPlaying = false;
+}
+
+AAshForestGhost* AAshForestGhost::SpawnGhost(const UObject* WorldContextObject, const FString & InGhostName, TSubclassOf<AAshForestGhost> GhostClass)
+{
+	auto world = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : NULL;
+	if (!world)
+		return NULL;
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	auto ghost = world->SpawnActor<AAshForestGhost>(GhostClass ? *GhostClass : AAshForestGhost::StaticClass(), FTransform::Identity, spawnParams);
+	if (ghost && !ghost->StartPlayback(InGhostName))
+	{
+		ghost->Destroy();
+		return NULL;
+	}
+
+	return ghost;
+}
+
+bool AAshForestGhost::StartPlayback(const FString & InGhostName)
+{
+	if (!Stream.Open(UAshForestGhostRecorder::GetGhostPath(InGhostName)))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("%s: couldn't open ghost %s"), *GetName(), *InGhostName);
+		return false;
+	}
+
+	GhostName = InGhostName;
+	Restart();
+	return bPlaying;
+}
+
+void AAshForestGhost::Restart()
+{
+	Stream.Rewind();
+	PlaybackTime = 0.f;
+	NextSampleIndex = 0;
+	bPlaying = Stream.ReadNext(NextSample);
+
+	PrevSample = NextSample;
+	ApplySamples(0.f);
+	SetActorTickEnabled(bPlaying);
+}
+
+void AAshForestGhost::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshGhostPlayback);
+
+	Super::Tick(DeltaTime);
+
+	if (!bPlaying)
+		return;
+
+	INC_DWORD_STAT(STAT_AshGhostsPlaying);
+
+	PlaybackTime += DeltaTime * PlaybackRate;
+
+	const float samplePos = PlaybackTime * Stream.GetSampleRate();
+	const int32 baseIndex = FMath::FloorToInt(samplePos);
+
+	if (AdvanceTo(baseIndex + 1))
+	{
+		ApplySamples(samplePos - baseIndex);
+		return;
+	}
+
+	if (bLoop)
+	{
+		Restart();
+		return;
+	}
+
+	ApplySamples(1.f);
+	bPlaying = false;
+	SetActorTickEnabled(false);
+	OnPlaybackFinished();
+}
+
+bool AAshForestGhost::AdvanceTo(const int32 SampleIndex)
+{
+	while (NextSampleIndex < SampleIndex)
+	{
+		PrevSample = NextSample;
+
+		if (!Stream.ReadNext(NextSample))
+		{
+			NextSample = PrevSample;
+			return false;
+		}
+
+		NextSampleIndex++;
+
+		if (NextSample.bDashed)
+			OnGhostDash();
+	}
+
+	return true;
+}
+
+void AAshForestGhost::ApplySamples(const float Alpha)
+{
+	const FVector prevLoc(PrevSample.Position);
+	const FVector nextLoc(NextSample.Position);
+
+	//AS: Yaw goes the short way round, the wrapped delta is already signed
+	const float yawDelta = FRotator::DecompressAxisFromShort((uint16)(NextSample.Yaw - PrevSample.Yaw));
+	const float yaw = FRotator::DecompressAxisFromShort(PrevSample.Yaw) + FRotator::NormalizeAxis(yawDelta) * Alpha;
+
+	SetActorLocationAndRotation(FMath::Lerp(prevLoc, nextLoc, Alpha), FRotator(0.f, yaw, 0.f));
+
+	MoveState = (EAshCustomMoveState::Type)NextSample.MoveState;
+	bIsWallRunning = NextSample.bWallRunning;
+	Speed = FVector::Dist(prevLoc, nextLoc) * Stream.GetSampleRate();
+}
+
+void AAshForestGhost::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Stream.Close();
+	bPlaying = false;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAshForestGhost::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Ghost %s (%s): %s, sample %d/%d at %dHz, %.1f KB %s"), *GetName(), *GhostName, bPlaying ? TEXT("playing") : TEXT("stopped"),
+		NextSampleIndex, Stream.GetNumSamples(), Stream.GetSampleRate(), Stream.GetSize() / 1024.f, Stream.IsMapped() ? TEXT("mapped") : TEXT("loaded"));
+}
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestHealthBarLayer.h"
+#include "AshForestHealthWidget.h"
+#include "AshForestCharacter.h"
+#include "Components/CanvasPanel.h"
+#include "Components/CanvasPanelSlot.h"
+#include "Components/CapsuleComponent.h"
+#include "Blueprint/WidgetLayoutLibrary.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "EngineUtils.h"
+#include "SceneView.h"
+#include "AshForestJobQueue.h"
+
+UAshForestHealthBarLayer::UAshForestHealthBarLayer(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	MaxBars = 6;
+	MaxBarDistance = 4000.f;
+	BarHeightOffset = 20.f;
+	VisibleTolerance = .1f;
+
+	bBarPoolRequested = false;
+}
+
+void UAshForestHealthBarLayer::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (!BarCanvas || !HealthBarClass || bBarPoolRequested)
+		return;
+
+	bBarPoolRequested = true;
+
+	//AS: The whole pool is created once, bars are only ever shown/hidden and re-pointed after this.
+	//AS: One bar per job so building the pool is spread out, AssignBars copes with a pool that's still growing
+	for (int32 i = 0; i < MaxBars; i++)
+	{
+		FAshJobQueue::Get().Post(this, TEXT("HealthBarCreate"), EAshJobPriority::EAshJob_LOW, 0.f, [this]()
+		{
+			auto bar = CreateWidget<UAshForestHealthWidget>(GetOwningPlayer(), HealthBarClass);
+			if (!bar)
+				return;
+
+			auto barSlot = BarCanvas->AddChildToCanvas(bar);
+			barSlot->SetAutoSize(true);
+			barSlot->SetAlignment(FVector2D(.5f, 1.f));
+			bar->SetVisibility(ESlateVisibility::Collapsed);
+
+			BarPool.Add(bar);
+			BarSlots.Add(barSlot);
+		});
+	}
+}
+
+void UAshForestHealthBarLayer::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	if (BarPool.Num() <= 0)
+		return;
+
+	auto localPlayer = GetOwningLocalPlayer();
+	FSceneViewProjectionData projectionData;
+
+	if (!localPlayer || !localPlayer->ViewportClient || !localPlayer->GetProjectionData(localPlayer->ViewportClient->Viewport, eSSP_FULL, projectionData))
+	{
+		Candidates.Reset();
+		AssignBars(FMatrix::Identity, FIntRect(), 1.f);
+		return;
+	}
+
+	GatherCandidates();
+	AssignBars(projectionData.ComputeViewProjectionMatrix(), projectionData.GetConstrainedViewRect(), UWidgetLayoutLibrary::GetViewportScale(this));
+}
+
+void UAshForestHealthBarLayer::GatherCandidates()
+{
+	Candidates.Reset();
+
+	auto player = GetOwningAshCharacter();
+	if (!player)
+		return;
+
+	const FVector viewLoc = player->GetPawnViewLocation();
+	const float maxDistSq = FMath::Square(MaxBarDistance);
+	const USceneComponent* lockOnTarget = player->GetLockOnTarget();
+	const AActor* lockedOnActor = lockOnTarget ? lockOnTarget->GetOwner() : NULL;
+
+	for (TActorIterator<ADamageableCharacter> it(GetWorld()); it; ++it)
+	{
+		ADamageableCharacter* currChar = *it;
+
+		if (currChar == player || currChar->IsRetired() || currChar->IsPendingKill())
+			continue;
+
+		const bool bLockedOn = currChar == lockedOnActor;
+
+		if (!bLockedOn && currChar->GetCurrentHealth() >= currChar->GetMaxHealth())
+			continue;
+
+		const float distSq = FVector::DistSquared(viewLoc, currChar->GetActorLocation());
+
+		if (!bLockedOn && (distSq > maxDistSq || !currChar->WasRecentlyRendered(VisibleTolerance)))
+			continue;
+
+		FBarCandidate candidate;
+		candidate.Character = currChar;
+		candidate.WorldLocation = currChar->GetActorLocation() + FVector(0.f, 0.f, currChar->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + BarHeightOffset);
+		candidate.DistSq = distSq;
+		candidate.bLockedOn = bLockedOn;
+		Candidates.Add(candidate);
+	}
+
+	//AS: Lock on target always gets a bar, the rest go closest first
+	Candidates.Sort([](const FBarCandidate& A, const FBarCandidate& B)
+	{
+		return A.bLockedOn != B.bLockedOn ? A.bLockedOn : A.DistSq < B.DistSq;
+	});
+
+	if (Candidates.Num() > BarPool.Num())
+		Candidates.SetNum(BarPool.Num(), false);
+}
+
+void UAshForestHealthBarLayer::AssignBars(const FMatrix & ViewProjection, const FIntRect & ViewRect, const float ViewportScale)
+{
+	TBitArray<> barUsed(false, BarPool.Num());
+	TBitArray<> candidateAssigned(false, Candidates.Num());
+
+	const float invScale = ViewportScale > 0.f ? 1.f / ViewportScale : 1.f;
+
+	auto placeBar = [&](const int32 BarIndex, const FBarCandidate& Candidate)
+	{
+		FVector2D screenPos;
+		if (!FSceneView::ProjectWorldToScreen(Candidate.WorldLocation, ViewRect, ViewProjection, screenPos))
+			return false;
+
+		BarSlots[BarIndex]->SetPosition((screenPos - FVector2D(ViewRect.Min)) * invScale);
+		BarPool[BarIndex]->SetVisibility(ESlateVisibility::HitTestInvisible);
+		return true;
+	};
+
+	//AS: Keep bars on the characters they already show so they don't rebind every frame
+	for (int32 b = 0; b < BarPool.Num(); b++)
+	{
+		auto source = BarPool[b]->GetHealthSource();
+		if (!source)
+			continue;
+
+		for (int32 c = 0; c < Candidates.Num(); c++)
+		{
+			if (!candidateAssigned[c] && Candidates[c].Character == source)
+			{
+				candidateAssigned[c] = true;
+				barUsed[b] = placeBar(b, Candidates[c]);
+				break;
+			}
+		}
+	}
+
+	int32 nextBar = 0;
+
+	for (int32 c = 0; c < Candidates.Num(); c++)
+	{
+		if (candidateAssigned[c])
+			continue;
+
+		while (nextBar < BarPool.Num() && barUsed[nextBar])
+			nextBar++;
+
+		if (nextBar >= BarPool.Num())
+			break;
+
+		BarPool[nextBar]->SetHealthSource(Candidates[c].Character);
+		barUsed[nextBar] = placeBar(nextBar, Candidates[c]);
+		nextBar++;
+	}
+
+	for (int32 b = 0; b < BarPool.Num(); b++)
+	{
+		if (barUsed[b])
+			continue;
+
+		BarPool[b]->SetHealthSource(NULL);
+		BarPool[b]->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestHealthWidget.h"
+#include "DamageableCharacter.h"
+
+void UAshForestHealthWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (!HealthSource.IsValid() && bTrackOwningPawn)
+		SetHealthSource(Cast<ADamageableCharacter>(GetOwningPlayerPawn()));
+}
+
+void UAshForestHealthWidget::NativeDestruct()
+{
+	SetHealthSource(NULL);
+
+	Super::NativeDestruct();
+}
+
+void UAshForestHealthWidget::SetHealthSource(ADamageableCharacter* NewSource)
+{
+	if (HealthSource.Get() == NewSource)
+		return;
+
+	if (HealthSource.IsValid())
+		HealthSource->OnHealthChanged.RemoveDynamic(this, &UAshForestHealthWidget::HandleHealthChanged);
+
+	HealthSource = NewSource;
+
+	if (NewSource)
+	{
+		NewSource->OnHealthChanged.AddDynamic(this, &UAshForestHealthWidget::HandleHealthChanged);
+
+		DisplayedHealth = -1.f;
+		HandleHealthChanged(NewSource, NewSource->GetCurrentHealth(), NewSource->GetMaxHealth());
+	}
+}
+
+void UAshForestHealthWidget::HandleHealthChanged(ADamageableCharacter* Character, float NewHealth, float MaxHealth)
+{
+	if (NewHealth == DisplayedHealth && MaxHealth == DisplayedMaxHealth)
+		return;
+
+	DisplayedHealth = NewHealth;
+	DisplayedMaxHealth = MaxHealth;
+
+	OnHealthUpdated(NewHealth, MaxHealth, MaxHealth > 0.f ? FMath::Clamp(NewHealth / MaxHealth, 0.f, 1.f) : 0.f);
+	MarkContentChanged();
+}
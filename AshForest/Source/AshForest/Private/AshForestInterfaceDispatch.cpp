@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestInterfaceDispatch.h"
+#include "AshForest.h"
+#include "TargetableInterface.h"
+#include "ActivateableInterface.h"
+#include "GameFramework/Actor.h"
+#include "UObject/ObjectKey.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interface Native Dispatches"), STAT_AshInterfaceNative, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interface Script Dispatches"), STAT_AshInterfaceScript, STATGROUP_AshForest);
+
+static TMap<FObjectKey, FAshClassCapabilities> GAshClassCapabilities;
+static uint64 GAshNativeDispatches[EAshInterfaceEvent::EAshEvent_MAX];
+static uint64 GAshScriptDispatches[EAshInterfaceEvent::EAshEvent_MAX];
+
+static const TCHAR* GAshInterfaceEventNames[EAshInterfaceEvent::EAshEvent_MAX] =
+{
+	TEXT("GetTargetableComponents"),
+	TEXT("CanBeTargeted"),
+	TEXT("CanBeDamaged"),
+	TEXT("IgnoresCollisionWithDamager"),
+	TEXT("TakeDamage"),
+	TEXT("AllowsActivationState"),
+};
+
+static FAutoConsoleCommand AshForestInterfaceStatsCmd(
+	TEXT("AshForest.InterfaceStats"),
+	TEXT("Prints how many targetable/activateable interface calls took the native path vs ProcessEvent. Pass 'reset' to clear"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		FAshInterfaceDispatch::LogStats();
+
+		if (Args.Contains(TEXT("reset")))
+			FAshInterfaceDispatch::ResetStats();
+	}));
+
+static bool IsScriptOverridden(const UClass* Class, const FName FunctionName)
+{
+	//AS: Native implementations (and the interface's own declaration) carry FUNC_Native, a Blueprint override doesn't
+	const UFunction* func = Class->FindFunctionByName(FunctionName);
+	return func && !func->HasAnyFunctionFlags(FUNC_Native);
+}
+
+static int32 GetInterfaceOffset(const UClass* Class, UClass* InterfaceClass)
+{
+	UObject* defaultObject = Class->GetDefaultObject();
+	void* interfaceAddress = defaultObject ? defaultObject->GetInterfaceAddress(InterfaceClass) : NULL;
+
+	return interfaceAddress ? (int32)((uint8*)interfaceAddress - (uint8*)defaultObject) : INDEX_NONE;
+}
+
+const FAshClassCapabilities & FAshInterfaceDispatch::GetCapabilities(const UClass* Class)
+{
+	if (const FAshClassCapabilities* found = GAshClassCapabilities.Find(Class))
+		return *found;
+
+	FAshClassCapabilities caps;
+	caps.bTargetable = Class->ImplementsInterface(UTargetableInterface::StaticClass());
+	caps.bActivateable = Class->ImplementsInterface(UActivateableInterface::StaticClass());
+
+	if (caps.bTargetable)
+	{
+		caps.TargetableOffset = GetInterfaceOffset(Class, UTargetableInterface::StaticClass());
+
+		const FName targetableEvents[] =
+		{
+			GET_FUNCTION_NAME_CHECKED(ITargetableInterface, GetTargetableComponents),
+			GET_FUNCTION_NAME_CHECKED(ITargetableInterface, CanBeTargeted),
+			GET_FUNCTION_NAME_CHECKED(ITargetableInterface, CanBeDamaged),
+			GET_FUNCTION_NAME_CHECKED(ITargetableInterface, IgnoresCollisionWithDamager),
+			GET_FUNCTION_NAME_CHECKED(ITargetableInterface, TakeDamage),
+		};
+
+		for (int32 i = 0; i < ARRAY_COUNT(targetableEvents); i++)
+		{
+			if (IsScriptOverridden(Class, targetableEvents[i]))
+				caps.ScriptOverrideMask |= 1 << i;
+		}
+	}
+
+	if (caps.bActivateable)
+	{
+		caps.ActivateableOffset = GetInterfaceOffset(Class, UActivateableInterface::StaticClass());
+
+		if (IsScriptOverridden(Class, GET_FUNCTION_NAME_CHECKED(IActivateableInterface, AllowsActivationState)))
+			caps.ScriptOverrideMask |= 1 << EAshInterfaceEvent::EAshEvent_ALLOWS_ACTIVATION_STATE;
+	}
+
+	return GAshClassCapabilities.Add(Class, caps);
+}
+
+bool FAshInterfaceDispatch::IsTargetable(const AActor* Actor)
+{
+	return Actor && GetCapabilities(Actor->GetClass()).bTargetable;
+}
+
+bool FAshInterfaceDispatch::IsActivateable(const AActor* Actor)
+{
+	return Actor && GetCapabilities(Actor->GetClass()).bActivateable;
+}
+
+/** Native interface pointer if Event can skip ProcessEvent for this actor, NULL if it has to go through Execute_ */
+static ITargetableInterface* GetNativeTargetable(AActor* Actor, const FAshClassCapabilities & Caps, const EAshInterfaceEvent::Type Event)
+{
+	if (Caps.TargetableOffset == INDEX_NONE || (Caps.ScriptOverrideMask & (1 << Event)) != 0)
+	{
+		GAshScriptDispatches[Event]++;
+		INC_DWORD_STAT(STAT_AshInterfaceScript);
+		return NULL;
+	}
+
+	GAshNativeDispatches[Event]++;
+	INC_DWORD_STAT(STAT_AshInterfaceNative);
+	return (ITargetableInterface*)((uint8*)Actor + Caps.TargetableOffset);
+}
+
+bool FAshInterfaceDispatch::GetTargetableComponents(AActor* Actor, TArray<USceneComponent*> & TargetableComps)
+{
+	if (!Actor)
+		return false;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bTargetable)
+		return false;
+
+	if (auto native = GetNativeTargetable(Actor, caps, EAshInterfaceEvent::EAshEvent_GET_TARGETABLE_COMPONENTS))
+		return native->GetTargetableComponents_Implementation(TargetableComps);
+
+	return ITargetableInterface::Execute_GetTargetableComponents(Actor, TargetableComps);
+}
+
+bool FAshInterfaceDispatch::CanBeTargeted(AActor* Actor, const AActor* ByActor)
+{
+	if (!Actor)
+		return false;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bTargetable)
+		return false;
+
+	if (auto native = GetNativeTargetable(Actor, caps, EAshInterfaceEvent::EAshEvent_CAN_BE_TARGETED))
+		return native->CanBeTargeted_Implementation(ByActor);
+
+	return ITargetableInterface::Execute_CanBeTargeted(Actor, ByActor);
+}
+
+bool FAshInterfaceDispatch::CanBeDamaged(AActor* Actor, const AActor* DamageCauser, const FHitResult & DamageHitEvent)
+{
+	if (!Actor)
+		return false;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bTargetable)
+		return false;
+
+	if (auto native = GetNativeTargetable(Actor, caps, EAshInterfaceEvent::EAshEvent_CAN_BE_DAMAGED))
+		return native->CanBeDamaged_Implementation(DamageCauser, DamageHitEvent);
+
+	return ITargetableInterface::Execute_CanBeDamaged(Actor, DamageCauser, DamageHitEvent);
+}
+
+bool FAshInterfaceDispatch::IgnoresCollisionWithDamager(AActor* Actor, const AActor* DamageCauser, const FHitResult & DamageHitEvent)
+{
+	if (!Actor)
+		return false;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bTargetable)
+		return false;
+
+	if (auto native = GetNativeTargetable(Actor, caps, EAshInterfaceEvent::EAshEvent_IGNORES_COLLISION))
+		return native->IgnoresCollisionWithDamager_Implementation(DamageCauser, DamageHitEvent);
+
+	return ITargetableInterface::Execute_IgnoresCollisionWithDamager(Actor, DamageCauser, DamageHitEvent);
+}
+
+void FAshInterfaceDispatch::TakeDamage(AActor* Actor, const AActor* DamageCauser, const float DamageAmount, const FHitResult & DamageHitEvent)
+{
+	if (!Actor)
+		return;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bTargetable)
+		return;
+
+	if (auto native = GetNativeTargetable(Actor, caps, EAshInterfaceEvent::EAshEvent_TAKE_DAMAGE))
+		native->TakeDamage_Implementation(DamageCauser, DamageAmount, DamageHitEvent);
+	else
+		ITargetableInterface::Execute_TakeDamage(Actor, DamageCauser, DamageAmount, DamageHitEvent);
+}
+
+bool FAshInterfaceDispatch::AllowsActivationState(AActor* Actor, const AActor* ByActivator, const bool NewActivationState)
+{
+	if (!Actor)
+		return false;
+
+	const auto& caps = GetCapabilities(Actor->GetClass());
+	if (!caps.bActivateable)
+		return false;
+
+	const auto event = EAshInterfaceEvent::EAshEvent_ALLOWS_ACTIVATION_STATE;
+
+	if (caps.ActivateableOffset != INDEX_NONE && (caps.ScriptOverrideMask & (1 << event)) == 0)
+	{
+		GAshNativeDispatches[event]++;
+		INC_DWORD_STAT(STAT_AshInterfaceNative);
+		return ((IActivateableInterface*)((uint8*)Actor + caps.ActivateableOffset))->AllowsActivationState_Implementation(ByActivator, NewActivationState);
+	}
+
+	GAshScriptDispatches[event]++;
+	INC_DWORD_STAT(STAT_AshInterfaceScript);
+	return IActivateableInterface::Execute_AllowsActivationState(Actor, ByActivator, NewActivationState);
+}
+
+void FAshInterfaceDispatch::LogStats()
+{
+	UE_LOG(LogAshForest, Log, TEXT("Interface dispatch (%d classes cached):"), GAshClassCapabilities.Num());
+
+	for (int32 i = 0; i < EAshInterfaceEvent::EAshEvent_MAX; i++)
+	{
+		const uint64 total = GAshNativeDispatches[i] + GAshScriptDispatches[i];
+		UE_LOG(LogAshForest, Log, TEXT("  %-28s native %10llu  script %10llu  (%.1f%% bypassed ProcessEvent)"), GAshInterfaceEventNames[i], GAshNativeDispatches[i], GAshScriptDispatches[i],
+			total > 0 ? 100.0 * (double)GAshNativeDispatches[i] / (double)total : 0.0);
+	}
+}
+
+void FAshInterfaceDispatch::ClearCache()
+{
+	GAshClassCapabilities.Reset();
+}
+
+void FAshInterfaceDispatch::ResetStats()
+{
+	FMemory::Memzero(GAshNativeDispatches);
+	FMemory::Memzero(GAshScriptDispatches);
+}
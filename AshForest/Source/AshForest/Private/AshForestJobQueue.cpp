@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestJobQueue.h"
+#include "AshForest.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Job Queue Drain"), STAT_AshJobQueueDrain, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Job Queue Depth"), STAT_AshJobQueueDepth, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Jobs Run"), STAT_AshJobsRun, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Jobs Forced By Deadline"), STAT_AshJobsForced, STATGROUP_AshForest);
+
+static TAutoConsoleVariable<float> CVarAshJobBudgetMs(
+	TEXT("ash.JobBudgetMs"),
+	1.f,
+	TEXT("Milliseconds per frame the deferred gameplay job queue may spend. Jobs past their deadline run regardless"),
+	ECVF_Default);
+
+static FAutoConsoleCommand AshForestJobStatsCmd(
+	TEXT("AshForest.JobStats"),
+	TEXT("Prints deferred job queue depth and latency. Pass 'reset' to clear"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		FAshJobQueue::Get().LogStats();
+
+		if (Args.Contains(TEXT("reset")))
+			FAshJobQueue::Get().ResetStats();
+	}));
+
+void FAshJobQueue::FLane::Compact()
+{
+	if (Head <= 0)
+		return;
+
+	//AS: Only shift once the dead prefix is a good chunk of the array, otherwise just keep appending
+	if (Head == Jobs.Num() || Head >= 32)
+	{
+		Jobs.RemoveAt(0, Head, false);
+		Head = 0;
+	}
+}
+
+FAshJobQueue & FAshJobQueue::Get()
+{
+	static FAshJobQueue instance;
+	return instance;
+}
+
+FAshJobQueue::FAshJobQueue()
+{
+	ResetStats();
+}
+
+void FAshJobQueue::Post(const UObject* Context, const TCHAR* Name, const EAshJobPriority::Type Priority, const float Deadline, TFunction<void()> && Job)
+{
+	check(IsInGameThread());
+
+	if (!Context)
+		return;
+
+	const double now = FPlatformTime::Seconds();
+
+	auto& lane = Lanes[FMath::Clamp((int32)Priority, 0, (int32)EAshJobPriority::EAshJob_MAX - 1)];
+	auto& job = lane.Jobs[lane.Jobs.AddDefaulted()];
+	job.Context = Context;
+	job.World = Context->GetWorld();
+	job.Name = Name;
+	job.Work = MoveTemp(Job);
+	job.PostTime = now;
+	job.DeadlineTime = Deadline > 0.f ? now + Deadline : 0.0;
+	job.PostFrame = GFrameCounter;
+
+	TotalPosted++;
+	PeakDepth = FMath::Max(PeakDepth, GetNumPending());
+}
+
+int32 FAshJobQueue::GetNumPending() const
+{
+	int32 num = 0;
+
+	for (const auto& lane : Lanes)
+		num += lane.Num();
+
+	return num;
+}
+
+bool FAshJobQueue::RunJob(FJob & Job, UWorld* World, const double Now)
+{
+	if (!Job.Work)
+		return true;
+
+	//AS: Jobs for another world (PIE clients) wait for that world's drain
+	if (Job.World.IsValid() && Job.World.Get() != World)
+		return false;
+
+	auto work = MoveTemp(Job.Work);
+	Job.Work = nullptr;
+
+	if (!Job.Context.IsValid())
+	{
+		TotalDropped++;
+		return true;
+	}
+
+	const double latencyMs = (Now - Job.PostTime) * 1000.0;
+	TotalLatencyMs += latencyMs;
+
+	if (latencyMs > WorstLatencyMs)
+	{
+		WorstLatencyMs = latencyMs;
+		WorstLatencyFrames = GFrameCounter - Job.PostFrame;
+	}
+
+	TotalRun++;
+	INC_DWORD_STAT(STAT_AshJobsRun);
+
+	work();
+	return true;
+}
+
+void FAshJobQueue::Drain(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshJobQueueDrain);
+
+	const double startTime = FPlatformTime::Seconds();
+	const double budgetSeconds = FMath::Max(0.f, CVarAshJobBudgetMs.GetValueOnGameThread()) / 1000.0;
+
+	//AS: Overdue jobs first, whatever their priority. Jobs may post more jobs, so index instead of iterating
+	for (auto& lane : Lanes)
+	{
+		for (int32 i = lane.Head; i < lane.Jobs.Num(); i++)
+		{
+			if (lane.Jobs[i].Work && lane.Jobs[i].DeadlineTime > 0.0 && lane.Jobs[i].DeadlineTime <= startTime && RunJob(lane.Jobs[i], World, startTime))
+			{
+				TotalForcedByDeadline++;
+				INC_DWORD_STAT(STAT_AshJobsForced);
+			}
+		}
+	}
+
+	for (auto& lane : Lanes)
+	{
+		while (lane.Head < lane.Jobs.Num())
+		{
+			const double now = FPlatformTime::Seconds();
+
+			if (now - startTime >= budgetSeconds)
+				break;
+
+			if (!RunJob(lane.Jobs[lane.Head], World, now))
+				break;
+
+			lane.Head++;
+		}
+
+		//AS: Skip over anything the deadline pass already ran
+		while (lane.Head < lane.Jobs.Num() && !lane.Jobs[lane.Head].Work)
+			lane.Head++;
+
+		lane.Compact();
+	}
+
+	SET_DWORD_STAT(STAT_AshJobQueueDepth, GetNumPending());
+}
+
+void FAshJobQueue::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Job queue: %d pending (high %d, normal %d, low %d), peak %d, budget %.2fms"), GetNumPending(),
+		Lanes[EAshJobPriority::EAshJob_HIGH].Num(), Lanes[EAshJobPriority::EAshJob_NORMAL].Num(), Lanes[EAshJobPriority::EAshJob_LOW].Num(), PeakDepth, CVarAshJobBudgetMs.GetValueOnGameThread());
+	UE_LOG(LogAshForest, Log, TEXT("  %llu posted, %llu run, %llu dropped (context gone), %llu forced by deadline"), TotalPosted, TotalRun, TotalDropped, TotalForcedByDeadline);
+	UE_LOG(LogAshForest, Log, TEXT("  latency avg %.2fms, worst %.2fms (%llu frames)"), TotalRun > 0 ? TotalLatencyMs / (double)TotalRun : 0.0, WorstLatencyMs, WorstLatencyFrames);
+}
+
+void FAshJobQueue::ResetStats()
+{
+	TotalPosted = 0;
+	TotalRun = 0;
+	TotalDropped = 0;
+	TotalForcedByDeadline = 0;
+	TotalLatencyMs = 0.0;
+	WorstLatencyMs = 0.0;
+	WorstLatencyFrames = 0;
+	PeakDepth = 0;
+}
@@ -0,0 +1,311 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLevelSnapshot.h"
+#include "AshForest.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "Misc/PackageName.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UnrealType.h"
+#include "DamageableCharacter.h"
+#include "AshForestTrigger.h"
+#include "AshForestActivateableActor.h"
+#include "AshForestCollectable.h"
+#include "AshForestProjectile.h"
+#include "AshForestEncounterSpawner.h"
+
+DECLARE_CYCLE_STAT(TEXT("Snapshot Capture"), STAT_AshSnapshotCapture, STATGROUP_AshForest);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Restore"), STAT_AshSnapshotRestore, STATGROUP_AshForest);
+
+static FAutoConsoleCommandWithWorld AshForestSnapshotCheckCmd(
+	TEXT("AshForest.SnapshotCheck"),
+	TEXT("Captures the level, changes every SaveGame bool/int on the captured actors, reads the snapshot back and logs anything that didn't return"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		FAshForestLevelSnapshot::VerifyRoundTrip(World);
+	}),
+	ECVF_Cheat);
+
+bool FAshForestLevelSnapshot::IsSnapshotActor(const AActor* Actor)
+{
+	//AS: Pooled creatures belong to their encounter spawner, restoring them would fight the pool
+	if (Actor->GetOwner() && Actor->GetOwner()->IsA(AAshForestEncounterSpawner::StaticClass()))
+		return false;
+
+	return Actor->IsA(ADamageableCharacter::StaticClass())
+		|| Actor->IsA(AAshForestTrigger::StaticClass())
+		|| Actor->IsA(AAshForestActivateableActor::StaticClass())
+		|| Actor->IsA(AAshForestCollectable::StaticClass());
+}
+
+FString FAshForestLevelSnapshot::GetActorKey(const AActor* Actor)
+{
+	const FString levelName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(Actor->GetOutermost()->GetName()));
+	return levelName + TEXT(".") + Actor->GetName();
+}
+
+void FAshForestLevelSnapshot::GetActorKeys(TArray<FString> & OutKeys) const
+{
+	OutKeys.Reset(Records.Num());
+
+	for (const auto& record : Records)
+	{
+		const AActor* currActor = record.Actor.Get();
+		OutKeys.Add(currActor ? GetActorKey(currActor) : FString());
+	}
+}
+
+int32 FAshForestLevelSnapshot::ResolveActors(UWorld* World, const TArray<FString> & Keys)
+{
+	if (!World || Keys.Num() != Records.Num())
+	{
+		Reset();
+		return 0;
+	}
+
+	TMap<FString, AActor*> actorsByKey;
+
+	for (TActorIterator<AActor> it(World); it; ++it)
+	{
+		if (*it && !it->IsPendingKill() && IsSnapshotActor(*it))
+			actorsByKey.Add(GetActorKey(*it), *it);
+	}
+
+	//AS: Offsets stay valid when records go, the blob is left as is
+	for (int32 i = Records.Num() - 1; i >= 0; i--)
+	{
+		auto found = actorsByKey.Find(Keys[i]);
+
+		if (found)
+			Records[i].Actor = *found;
+		else
+			Records.RemoveAt(i, 1, false);
+	}
+
+	return Records.Num();
+}
+
+FArchive& operator<<(FArchive& Ar, FAshForestLevelSnapshot& Snapshot)
+{
+	int32 numRecords = Snapshot.Records.Num();
+	Ar << numRecords;
+
+	if (Ar.IsLoading())
+	{
+		if (numRecords < 0)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+
+		Snapshot.Records.SetNum(numRecords);
+	}
+
+	for (auto& record : Snapshot.Records)
+	{
+		Ar << record.Transform;
+		Ar << record.Offset;
+		Ar << record.Size;
+		Ar << record.bRetired;
+	}
+
+	Ar << Snapshot.Blob;
+	return Ar;
+}
+
+void FAshForestLevelSnapshot::Reset()
+{
+	Records.Reset();
+	Blob.Reset();
+}
+
+void FAshForestLevelSnapshot::Capture(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshSnapshotCapture);
+
+	Reset();
+
+	if (!World)
+		return;
+
+	const double startTime = FPlatformTime::Seconds();
+
+	//AS: Not persistent: a persistent archive skips Transient properties, and most runtime SaveGame state (bCollected, bTriggerEnabled, money) is Transient
+	FMemoryWriter writer(Blob, false);
+	FObjectAndNameAsStringProxyArchive ar(writer, true);
+	ar.ArIsSaveGame = true;
+
+	for (TActorIterator<AActor> it(World); it; ++it)
+	{
+		AActor* currActor = *it;
+
+		if (!currActor || currActor->IsPendingKill() || !IsSnapshotActor(currActor))
+			continue;
+
+		auto damageable = Cast<ADamageableCharacter>(currActor);
+
+		auto& record = Records[Records.AddDefaulted()];
+		record.Actor = currActor;
+		record.Transform = currActor->GetActorTransform();
+		record.bRetired = damageable && damageable->IsRetired();
+		record.Offset = Blob.Num();
+
+		//AS: Only SaveGame flagged properties go through with ArIsSaveGame set
+		currActor->Serialize(ar);
+
+		record.Size = Blob.Num() - record.Offset;
+	}
+
+	UE_LOG(LogAshForest, Verbose, TEXT("Snapshot captured %d actors into %d bytes in %.3fms"), Records.Num(), Blob.Num(), (FPlatformTime::Seconds() - startTime) * 1000.0);
+}
+
+int32 FAshForestLevelSnapshot::Restore(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshSnapshotRestore);
+
+	if (!World || !IsValid())
+		return 0;
+
+	const double startTime = FPlatformTime::Seconds();
+	int32 restoredCount = 0;
+
+	FMemoryReader reader(Blob, false);
+	FObjectAndNameAsStringProxyArchive ar(reader, true);
+	ar.ArIsSaveGame = true;
+
+	for (const auto& record : Records)
+	{
+		//AS: Actors that were destroyed outright can't come back, anything that should must retire instead
+		AActor* currActor = record.Actor.Get();
+		if (!currActor || currActor->IsPendingKill())
+			continue;
+
+		auto damageable = Cast<ADamageableCharacter>(currActor);
+		auto activateable = Cast<AAshForestActivateableActor>(currActor);
+		const bool bWasActivated = activateable && activateable->IsActivated();
+
+		//AS: Revive first, it resets health which the blob then overwrites
+		if (damageable && !damageable->IsPlayerControlled())
+		{
+			if (damageable->IsRetired() && !record.bRetired)
+				damageable->Revive();
+
+			damageable->SetActorTransform(record.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+			damageable->GetCharacterMovement()->StopMovementImmediately();
+		}
+
+		reader.Seek(record.Offset);
+		currActor->Serialize(ar);
+		restoredCount++;
+
+		if (damageable)
+			damageable->OnHealthChanged.Broadcast(damageable, damageable->GetCurrentHealth(), damageable->GetMaxHealth());
+
+		if (activateable && activateable->IsActivated() != bWasActivated)
+			activateable->OnActivationStateRestored(activateable->IsActivated());
+
+		if (auto collectable = Cast<AAshForestCollectable>(currActor))
+			collectable->RefreshCollectedState();
+	}
+
+	//AS: Nothing in flight survives a retry
+	for (TActorIterator<AAshForestProjectile> it(World); it; ++it)
+		it->Destroy();
+
+	UE_LOG(LogAshForest, Verbose, TEXT("Snapshot restored %d/%d actors in %.3fms"), restoredCount, Records.Num(), (FPlatformTime::Seconds() - startTime) * 1000.0);
+
+	return restoredCount;
+}
+
+int32 FAshForestLevelSnapshot::VerifyRoundTrip(UWorld* World, const TFunction<void(FAshForestLevelSnapshot&)> & Transport)
+{
+	FAshForestLevelSnapshot snapshot;
+	snapshot.Capture(World);
+
+	struct FCheckedValue
+	{
+		AActor* Actor;
+		UProperty* Property;
+		bool bBoolValue;
+		int32 IntValue;
+	};
+
+	TArray<FCheckedValue> checkedValues;
+
+	//AS: Scramble every SaveGame bool/int so the read back has to be what puts them right again
+	for (const auto& record : snapshot.Records)
+	{
+		AActor* currActor = record.Actor.Get();
+		if (!currActor)
+			continue;
+
+		for (TFieldIterator<UProperty> it(currActor->GetClass()); it; ++it)
+		{
+			if (!it->HasAnyPropertyFlags(CPF_SaveGame))
+				continue;
+
+			if (auto boolProp = Cast<UBoolProperty>(*it))
+			{
+				const bool bValue = boolProp->GetPropertyValue_InContainer(currActor);
+				checkedValues.Add({ currActor, boolProp, bValue, 0 });
+				boolProp->SetPropertyValue_InContainer(currActor, !bValue);
+			}
+			else if (auto intProp = Cast<UIntProperty>(*it))
+			{
+				const int32 value = intProp->GetPropertyValue_InContainer(currActor);
+				checkedValues.Add({ currActor, intProp, false, value });
+				intProp->SetPropertyValue_InContainer(currActor, value + 1);
+			}
+		}
+	}
+
+	const int32 numCaptured = snapshot.Records.Num();
+
+	if (Transport)
+		Transport(snapshot);
+
+	FMemoryReader reader(snapshot.Blob, false);
+	FObjectAndNameAsStringProxyArchive ar(reader, true);
+	ar.ArIsSaveGame = true;
+
+	for (const auto& record : snapshot.Records)
+	{
+		if (AActor* currActor = record.Actor.Get())
+		{
+			reader.Seek(record.Offset);
+			currActor->Serialize(ar);
+		}
+	}
+
+	int32 failedCount = 0;
+
+	for (const auto& checked : checkedValues)
+	{
+		bool bMatches;
+
+		if (auto boolProp = Cast<UBoolProperty>(checked.Property))
+		{
+			bMatches = boolProp->GetPropertyValue_InContainer(checked.Actor) == checked.bBoolValue;
+			boolProp->SetPropertyValue_InContainer(checked.Actor, checked.bBoolValue);
+		}
+		else
+		{
+			auto intProp = (UIntProperty*)checked.Property;
+			bMatches = intProp->GetPropertyValue_InContainer(checked.Actor) == checked.IntValue;
+			intProp->SetPropertyValue_InContainer(checked.Actor, checked.IntValue);
+		}
+
+		if (!bMatches)
+		{
+			failedCount++;
+			UE_LOG(LogAshForest, Warning, TEXT("Snapshot round trip: %s.%s was not restored"), *checked.Actor->GetName(), *checked.Property->GetName());
+		}
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("Snapshot round trip: %d/%d SaveGame values on %d/%d actors restored"), checkedValues.Num() - failedCount, checkedValues.Num(), snapshot.Records.Num(), numCaptured);
+	return failedCount;
+}
@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLevelStreamer.h"
+#include "AshForest.h"
+#include "AshForestCharacter.h"
+#include "Engine/World.h"
+#include "Engine/LevelStreaming.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/PackageName.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Late Loads"), STAT_AshStreamingLateLoads, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Segments Loaded"), STAT_AshStreamingSegmentsLoaded, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Streaming Loaded MB (est.)"), STAT_AshStreamingLoadedMB, STATGROUP_AshForest);
+
+static FAutoConsoleCommandWithWorld AshForestStreamingStatsCmd(
+	TEXT("AshForest.StreamingStats"),
+	TEXT("Prints predictive streaming state and late load telemetry"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		for (TActorIterator<AAshForestLevelStreamer> it(World); it; ++it)
+			it->LogStreamingStats();
+	}));
+
+AAshForestLevelStreamer::AAshForestLevelStreamer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	VelocityLookAheadTime = 1.5f;
+	PredictionPadding = 1000.f;
+	SegmentsAhead = 1;
+	SegmentsBehind = 1;
+	MemoryBudgetMB = 512.f;
+	UpdateInterval = .1f;
+
+	CurrentSegmentIndex = INDEX_NONE;
+}
+
+void AAshForestLevelStreamer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PrimaryActorTick.TickInterval = UpdateInterval;
+
+	//AS: Resolve the streaming objects once and take them away from distance based streaming volumes
+	for (auto& segment : Segments)
+	{
+		segment.StreamingLevel = NULL;
+
+		for (auto currStreaming : GetWorld()->GetStreamingLevels())
+		{
+			if (!currStreaming)
+				continue;
+
+			const FString shortName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(currStreaming->GetWorldAssetPackageName()));
+
+			if (segment.LevelName == FName(*shortName))
+			{
+				segment.StreamingLevel = currStreaming;
+				segment.bLoadRequested = currStreaming->ShouldBeLoaded();
+				currStreaming->bDisableDistanceStreaming = true;
+				break;
+			}
+		}
+
+		if (!segment.StreamingLevel)
+			UE_LOG(LogAshForest, Warning, TEXT("%s: no streaming level named %s"), *GetName(), *segment.LevelName.ToString());
+	}
+
+	UpdateStreaming();
+}
+
+void AAshForestLevelStreamer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateStreaming();
+}
+
+int32 AAshForestLevelStreamer::FindCurrentSegment(const AAshForestCharacter* Player) const
+{
+	int32 retIndex = INDEX_NONE;
+	const int32 checkpointIndex = Player->GetLatestCheckpointIndex();
+	const FVector playerLoc = Player->GetActorLocation();
+
+	for (int32 i = 0; i < Segments.Num(); i++)
+	{
+		if (Segments[i].bAlwaysLoaded)
+			continue;
+
+		//AS: Checkpoints define progress, but being physically inside a later segment wins (e.g. skipping a checkpoint with a dash)
+		if ((Segments[i].FirstCheckpointIndex >= 0 && checkpointIndex >= Segments[i].FirstCheckpointIndex) || (Segments[i].Bounds.IsValid && Segments[i].Bounds.IsInside(playerLoc)))
+			retIndex = i;
+	}
+
+	if (retIndex == INDEX_NONE)
+	{
+		for (int32 i = 0; i < Segments.Num(); i++)
+		{
+			if (!Segments[i].bAlwaysLoaded)
+				return i;
+		}
+	}
+
+	return retIndex;
+}
+
+void AAshForestLevelStreamer::GatherNeededSegments(const AAshForestCharacter* Player, TBitArray<> & OutNeeded) const
+{
+	OutNeeded.Init(false, Segments.Num());
+
+	if (CurrentSegmentIndex != INDEX_NONE)
+	{
+		for (int32 i = CurrentSegmentIndex - SegmentsBehind; i <= CurrentSegmentIndex + SegmentsAhead; i++)
+		{
+			if (Segments.IsValidIndex(i))
+				OutNeeded[i] = true;
+		}
+	}
+
+	//AS: Anything the current velocity will carry the player into within the look ahead window
+	const FVector start = Player->GetActorLocation();
+	const FVector end = start + (Player->GetVelocity() * VelocityLookAheadTime);
+
+	for (int32 i = 0; i < Segments.Num(); i++)
+	{
+		const auto& segment = Segments[i];
+
+		if (segment.bAlwaysLoaded)
+		{
+			OutNeeded[i] = true;
+			continue;
+		}
+
+		if (!segment.Bounds.IsValid)
+			continue;
+
+		const FBox paddedBounds = segment.Bounds.ExpandBy(PredictionPadding);
+
+		if (paddedBounds.IsInside(start) || paddedBounds.IsInside(end) || FMath::LineBoxIntersection(paddedBounds, start, end, end - start))
+			OutNeeded[i] = true;
+	}
+}
+
+void AAshForestLevelStreamer::RequestLoad(FAshStreamingSegment & Segment)
+{
+	if (!Segment.StreamingLevel || Segment.bLoadRequested)
+		return;
+
+	Segment.bLoadRequested = true;
+	Segment.LoadRequestTime = GetWorld()->GetTimeSeconds();
+
+	//AS: Streaming levels load through the async package loader, nothing here blocks
+	Segment.StreamingLevel->SetShouldBeLoaded(true);
+	Segment.StreamingLevel->SetShouldBeVisible(true);
+}
+
+void AAshForestLevelStreamer::RequestUnload(FAshStreamingSegment & Segment)
+{
+	if (!Segment.StreamingLevel || !Segment.bLoadRequested)
+		return;
+
+	Segment.bLoadRequested = false;
+	Segment.LateSinceTime = -1.f;
+
+	Segment.StreamingLevel->SetShouldBeVisible(false);
+	Segment.StreamingLevel->SetShouldBeLoaded(false);
+}
+
+bool AAshForestLevelStreamer::IsSegmentReady(const int32 SegmentIndex) const
+{
+	return Segments.IsValidIndex(SegmentIndex) && Segments[SegmentIndex].StreamingLevel && Segments[SegmentIndex].StreamingLevel->IsLevelVisible();
+}
+
+void AAshForestLevelStreamer::UpdateStreaming()
+{
+	auto player = Cast<AAshForestCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+
+	if (!player || Segments.Num() <= 0)
+		return;
+
+	CurrentSegmentIndex = FindCurrentSegment(player);
+
+	TBitArray<> needed;
+	GatherNeededSegments(player, needed);
+
+	//AS: Closest segments first so they get the front of the async queue
+	for (int32 dist = 0; dist < Segments.Num(); dist++)
+	{
+		const int32 aheadIndex = CurrentSegmentIndex + dist;
+		const int32 behindIndex = CurrentSegmentIndex - dist;
+
+		if (Segments.IsValidIndex(aheadIndex) && needed[aheadIndex])
+			RequestLoad(Segments[aheadIndex]);
+
+		if (dist > 0 && Segments.IsValidIndex(behindIndex) && needed[behindIndex])
+			RequestLoad(Segments[behindIndex]);
+	}
+
+	float loadedMB = 0.f;
+	int32 loadedCount = 0;
+
+	for (const auto& segment : Segments)
+	{
+		if (segment.bLoadRequested)
+		{
+			loadedMB += segment.EstimatedMemoryMB;
+			loadedCount++;
+		}
+	}
+
+	//AS: Over budget, drop segments that aren't needed: furthest behind the player first, then furthest ahead
+	if (loadedMB > MemoryBudgetMB)
+	{
+		TArray<int32, TInlineAllocator<16>> unloadOrder;
+
+		for (int32 i = 0; i < CurrentSegmentIndex; i++)
+			unloadOrder.Add(i);
+
+		for (int32 i = Segments.Num() - 1; i > CurrentSegmentIndex; i--)
+			unloadOrder.Add(i);
+
+		for (int32 candidate : unloadOrder)
+		{
+			if (loadedMB <= MemoryBudgetMB)
+				break;
+
+			if (needed[candidate] || Segments[candidate].bAlwaysLoaded || !Segments[candidate].bLoadRequested)
+				continue;
+
+			RequestUnload(Segments[candidate]);
+			loadedMB -= Segments[candidate].EstimatedMemoryMB;
+			loadedCount--;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_AshStreamingSegmentsLoaded, loadedCount);
+	SET_FLOAT_STAT(STAT_AshStreamingLoadedMB, loadedMB);
+
+	UpdateLateLoadTelemetry(player, needed);
+}
+
+void AAshForestLevelStreamer::UpdateLateLoadTelemetry(const AAshForestCharacter* Player, const TBitArray<> & Needed)
+{
+	const float now = GetWorld()->GetTimeSeconds();
+	const FVector playerLoc = Player->GetActorLocation();
+
+	for (int32 i = 0; i < Segments.Num(); i++)
+	{
+		auto& segment = Segments[i];
+
+		//AS: A load is late when the player is standing in a segment (or it is the checkpoint segment) and it still isn't visible
+		const bool bPlayerNeedsItNow = i == CurrentSegmentIndex || (segment.Bounds.IsValid && segment.Bounds.IsInside(playerLoc));
+
+		if (!bPlayerNeedsItNow || !segment.StreamingLevel)
+			continue;
+
+		if (!IsSegmentReady(i))
+		{
+			if (segment.LateSinceTime < 0.f)
+			{
+				segment.LateSinceTime = now;
+				LateLoadCount++;
+				INC_DWORD_STAT(STAT_AshStreamingLateLoads);
+
+				UE_LOG(LogAshForest, Warning, TEXT("Late load: player entered %s before it was visible (requested %.2fs ago, speed %.0f u/s)"),
+					*segment.LevelName.ToString(), segment.bLoadRequested ? now - segment.LoadRequestTime : -1.f, Player->GetVelocity().Size());
+			}
+		}
+		else if (segment.LateSinceTime >= 0.f)
+		{
+			const float lateSeconds = now - segment.LateSinceTime;
+			TotalLateLoadSeconds += lateSeconds;
+			WorstLateLoadSeconds = FMath::Max(WorstLateLoadSeconds, lateSeconds);
+			segment.LateSinceTime = -1.f;
+
+			UE_LOG(LogAshForest, Warning, TEXT("Late load: %s became visible %.2fs after the player needed it"), *segment.LevelName.ToString(), lateSeconds);
+		}
+	}
+}
+
+void AAshForestLevelStreamer::LogStreamingStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("%s: current segment %d, %d late loads, %.2fs total late, %.2fs worst"), *GetName(), CurrentSegmentIndex, LateLoadCount, TotalLateLoadSeconds, WorstLateLoadSeconds);
+
+	for (int32 i = 0; i < Segments.Num(); i++)
+	{
+		const auto& segment = Segments[i];
+		UE_LOG(LogAshForest, Log, TEXT("  [%d] %-36s requested:%d visible:%d %.0fMB%s"), i, *segment.LevelName.ToString(), segment.bLoadRequested ? 1 : 0, IsSegmentReady(i) ? 1 : 0,
+			segment.EstimatedMemoryMB, segment.bAlwaysLoaded ? TEXT(" (always)") : TEXT(""));
+	}
+}
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLockOnKernel.h"
+#include "AshForest.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+void FAshLockOnBatch::Reset()
+{
+	PosX.Reset();
+	PosY.Reset();
+	Num = 0;
+}
+
+int32 FAshLockOnBatch::Add(const FVector & Location)
+{
+	//AS: Grow a whole SIMD lane group at a time, padding lanes are masked out by index in the picks
+	if (Num == PosX.Num())
+	{
+		PosX.AddZeroed(4);
+		PosY.AddZeroed(4);
+	}
+
+	PosX[Num] = Location.X;
+	PosY[Num] = Location.Y;
+
+	return Num++;
+}
+
+float FAshLockOnKernel::ConeKey(const float MaxAngleDegrees)
+{
+	if (MaxAngleDegrees >= 180.f)
+		return -MAX_FLT;
+
+	return CosineKey(FMath::Cos(FMath::DegreesToRadians(FMath::Max(MaxAngleDegrees, 0.f))));
+}
+
+float FAshLockOnKernel::KeyToDegrees(const float Key)
+{
+	const float cosine = FMath::Clamp(FMath::Sign(Key) * FMath::Sqrt(FMath::Abs(Key)), -1.f, 1.f);
+	return FMath::RadiansToDegrees(FMath::Acos(cosine));
+}
+
+void FAshLockOnKernel::Evaluate(FAshLockOnBatch & Batch, const FVector & Origin, const FVector & RefDir)
+{
+	const int32 paddedNum = Batch.GetPaddedNum();
+	Batch.Key.SetNumUninitialized(paddedNum, false);
+	Batch.Side.SetNumUninitialized(paddedNum, false);
+
+	const VectorRegister originX = VectorSetFloat1(Origin.X);
+	const VectorRegister originY = VectorSetFloat1(Origin.Y);
+	const VectorRegister refX = VectorSetFloat1(RefDir.X);
+	const VectorRegister refY = VectorSetFloat1(RefDir.Y);
+	const VectorRegister minLenSq = VectorSetFloat1(SMALL_NUMBER);
+	const VectorRegister zero = VectorZero();
+	const VectorRegister one = VectorOne();
+
+	for (int32 i = 0; i < paddedNum; i += 4)
+	{
+		const VectorRegister dx = VectorSubtract(VectorLoadAligned(&Batch.PosX[i]), originX);
+		const VectorRegister dy = VectorSubtract(VectorLoadAligned(&Batch.PosY[i]), originY);
+
+		const VectorRegister lenSq = VectorMultiplyAdd(dx, dx, VectorMultiply(dy, dy));
+		const VectorRegister dot = VectorMultiplyAdd(dx, refX, VectorMultiply(dy, refY));
+		const VectorRegister cross = VectorSubtract(VectorMultiply(refX, dy), VectorMultiply(refY, dx));
+
+		//AS: Same tolerance as GetSafeNormal2D, anything shorter scores as a zero direction (cos 0, no side)
+		const VectorRegister validLen = VectorCompareGE(lenSq, minLenSq);
+		const VectorRegister key = VectorDivide(VectorMultiply(dot, VectorAbs(dot)), VectorSelect(validLen, lenSq, one));
+
+		VectorStoreAligned(VectorSelect(validLen, key, zero), &Batch.Key[i]);
+		VectorStoreAligned(VectorSelect(validLen, cross, zero), &Batch.Side[i]);
+	}
+}
+
+static int32 ReduceBestLane(const VectorRegister & BestKey, const VectorRegister & BestIndex)
+{
+	MS_ALIGN(16) float keys[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float indices[4] GCC_ALIGN(16);
+	VectorStoreAligned(BestKey, keys);
+	VectorStoreAligned(BestIndex, indices);
+
+	int32 retIndex = INDEX_NONE;
+	float retKey = -MAX_FLT;
+
+	//AS: Ties go to the lowest index, same as the first-wins scalar loop
+	for (int32 lane = 0; lane < 4; lane++)
+	{
+		const int32 index = (int32)indices[lane];
+
+		if (index >= 0 && (keys[lane] > retKey || (keys[lane] == retKey && index < retIndex)))
+		{
+			retKey = keys[lane];
+			retIndex = index;
+		}
+	}
+
+	return retIndex;
+}
+
+int32 FAshLockOnKernel::PickBestInCone(const FAshLockOnBatch & Batch, const float MinKey)
+{
+	const VectorRegister minKey = VectorSetFloat1(MinKey);
+	const VectorRegister count = VectorSetFloat1((float)Batch.Num);
+	const VectorRegister four = VectorSetFloat1(4.f);
+
+	VectorRegister lane = MakeVectorRegister(0.f, 1.f, 2.f, 3.f);
+	VectorRegister bestKey = VectorSetFloat1(-MAX_FLT);
+	VectorRegister bestIndex = VectorSetFloat1(-1.f);
+
+	for (int32 i = 0; i < Batch.GetPaddedNum(); i += 4)
+	{
+		const VectorRegister key = VectorLoadAligned(&Batch.Key[i]);
+		const VectorRegister accept = VectorBitwiseAnd(VectorCompareGE(key, minKey), VectorCompareGT(count, lane));
+		const VectorRegister better = VectorBitwiseAnd(accept, VectorCompareGT(key, bestKey));
+
+		bestKey = VectorSelect(better, key, bestKey);
+		bestIndex = VectorSelect(better, lane, bestIndex);
+		lane = VectorAdd(lane, four);
+	}
+
+	return ReduceBestLane(bestKey, bestIndex);
+}
+
+void FAshLockOnKernel::PickSwitchTargets(const FAshLockOnBatch & Batch, const int32 SkipIndex, int32 & OutBestLeft, int32 & OutBestRight)
+{
+	const VectorRegister zero = VectorZero();
+	const VectorRegister count = VectorSetFloat1((float)Batch.Num);
+	const VectorRegister skip = VectorSetFloat1((float)SkipIndex);
+	const VectorRegister four = VectorSetFloat1(4.f);
+
+	VectorRegister lane = MakeVectorRegister(0.f, 1.f, 2.f, 3.f);
+	VectorRegister bestLeftKey = VectorSetFloat1(-MAX_FLT);
+	VectorRegister bestLeftIndex = VectorSetFloat1(-1.f);
+	VectorRegister bestRightKey = VectorSetFloat1(-MAX_FLT);
+	VectorRegister bestRightIndex = VectorSetFloat1(-1.f);
+
+	for (int32 i = 0; i < Batch.GetPaddedNum(); i += 4)
+	{
+		const VectorRegister key = VectorLoadAligned(&Batch.Key[i]);
+		const VectorRegister side = VectorLoadAligned(&Batch.Side[i]);
+		const VectorRegister valid = VectorBitwiseAnd(VectorCompareGT(count, lane), VectorCompareNE(lane, skip));
+
+		//AS: Matches the scalar sign convention: exactly behind counts as right, exactly ahead is neither
+		const VectorRegister isRight = VectorBitwiseOr(VectorCompareGT(side, zero), VectorBitwiseAnd(VectorCompareEQ(side, zero), VectorCompareGE(zero, key)));
+		const VectorRegister isLeft = VectorCompareGT(zero, side);
+
+		const VectorRegister betterRight = VectorBitwiseAnd(VectorBitwiseAnd(valid, isRight), VectorCompareGT(key, bestRightKey));
+		const VectorRegister betterLeft = VectorBitwiseAnd(VectorBitwiseAnd(valid, isLeft), VectorCompareGT(key, bestLeftKey));
+
+		bestRightKey = VectorSelect(betterRight, key, bestRightKey);
+		bestRightIndex = VectorSelect(betterRight, lane, bestRightIndex);
+		bestLeftKey = VectorSelect(betterLeft, key, bestLeftKey);
+		bestLeftIndex = VectorSelect(betterLeft, lane, bestLeftIndex);
+		lane = VectorAdd(lane, four);
+	}
+
+	OutBestLeft = ReduceBestLane(bestLeftKey, bestLeftIndex);
+	OutBestRight = ReduceBestLane(bestRightKey, bestRightIndex);
+}
+
+int32 FAshLockOnKernel::PickBestInCone_Scalar(const TArray<FVector> & Locations, const FVector & Origin, const FVector & RefDir, const float MaxAngleDegrees)
+{
+	int32 retIndex = INDEX_NONE;
+	float angleToTarget_best = 400.f;
+
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		const float angleToTarget_curr = FMath::Abs(FMath::Acos(FVector::DotProduct((Locations[i] - Origin).GetSafeNormal2D(), RefDir)) * (180.f / PI));
+
+		if (angleToTarget_curr <= MaxAngleDegrees && angleToTarget_curr < angleToTarget_best)
+		{
+			angleToTarget_best = angleToTarget_curr;
+			retIndex = i;
+		}
+	}
+
+	return retIndex;
+}
+
+void FAshLockOnKernel::PickSwitchTargets_Scalar(const TArray<FVector> & Locations, const FVector & Origin, const FVector & RefDir, const int32 SkipIndex, int32 & OutBestLeft, int32 & OutBestRight)
+{
+	OutBestLeft = OutBestRight = INDEX_NONE;
+	float bestLeft = 400.f;
+	float bestRight = 400.f;
+
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		if (i == SkipIndex)
+			continue;
+
+		const FVector dirToTarget = (Locations[i] - Origin).GetSafeNormal2D();
+		float angleToTarget_curr = FMath::Acos(FVector::DotProduct(RefDir, dirToTarget)) * (180.f / PI);
+
+		if (FVector::CrossProduct(RefDir, dirToTarget).Z < 0.f)
+			angleToTarget_curr *= -1.f;
+
+		if (FMath::Sign(angleToTarget_curr) > 0.f && angleToTarget_curr < bestRight)
+		{
+			bestRight = angleToTarget_curr;
+			OutBestRight = i;
+		}
+		else if (FMath::Sign(angleToTarget_curr) < 0.f && -angleToTarget_curr < bestLeft)
+		{
+			bestLeft = -angleToTarget_curr;
+			OutBestLeft = i;
+		}
+	}
+}
+
+//AS: Benchmark and exactness check ==========================================
+
+static float AngleTo(const FVector & Location, const FVector & Origin, const FVector & RefDir)
+{
+	return FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector::DotProduct((Location - Origin).GetSafeNormal2D(), RefDir), -1.f, 1.f)));
+}
+
+/** Different picks are only acceptable when both candidates are the same angle away to within float noise */
+static bool PicksMatch(const int32 A, const int32 B, const TArray<FVector> & Locations, const FVector & Origin, const FVector & RefDir)
+{
+	if (A == B)
+		return true;
+
+	if (A == INDEX_NONE || B == INDEX_NONE)
+		return false;
+
+	return FMath::IsNearlyEqual(AngleTo(Locations[A], Origin, RefDir), AngleTo(Locations[B], Origin, RefDir), 1.e-3f);
+}
+
+static void RandomCandidates(FRandomStream & Rng, const int32 Count, TArray<FVector> & OutLocations, FAshLockOnBatch & OutBatch)
+{
+	OutLocations.Reset();
+	OutBatch.Reset();
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector location(Rng.FRandRange(-3000.f, 3000.f), Rng.FRandRange(-3000.f, 3000.f), Rng.FRandRange(-200.f, 200.f));
+		OutLocations.Add(location);
+		OutBatch.Add(location);
+	}
+}
+
+static void RunLockOnKernelBench(const TArray<FString> & Args)
+{
+	const int32 numCandidates = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 32;
+	const int32 iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 20000;
+	const float coneDegrees = 45.f;
+
+	FRandomStream rng(0xA54F);
+	TArray<FVector> locations;
+	FAshLockOnBatch batch;
+
+	//AS: Exactness: every trial gets fresh candidates and a fresh view direction
+	int32 coneMismatches = 0;
+	int32 switchMismatches = 0;
+
+	for (int32 trial = 0; trial < iterations; trial++)
+	{
+		RandomCandidates(rng, numCandidates, locations, batch);
+
+		const FVector origin(rng.FRandRange(-500.f, 500.f), rng.FRandRange(-500.f, 500.f), 0.f);
+		const FVector refDir = FRotator(0.f, rng.FRandRange(-180.f, 180.f), 0.f).Vector();
+		const int32 skipIndex = rng.RandRange(-1, numCandidates - 1);
+
+		FAshLockOnKernel::Evaluate(batch, origin, refDir);
+
+		const int32 simdBest = FAshLockOnKernel::PickBestInCone(batch, FAshLockOnKernel::ConeKey(coneDegrees));
+		const int32 scalarBest = FAshLockOnKernel::PickBestInCone_Scalar(locations, origin, refDir, coneDegrees);
+
+		if (!PicksMatch(simdBest, scalarBest, locations, origin, refDir))
+			coneMismatches++;
+
+		int32 simdLeft, simdRight, scalarLeft, scalarRight;
+		FAshLockOnKernel::PickSwitchTargets(batch, skipIndex, simdLeft, simdRight);
+		FAshLockOnKernel::PickSwitchTargets_Scalar(locations, origin, refDir, skipIndex, scalarLeft, scalarRight);
+
+		if (!PicksMatch(simdLeft, scalarLeft, locations, origin, refDir) || !PicksMatch(simdRight, scalarRight, locations, origin, refDir))
+			switchMismatches++;
+	}
+
+	//AS: Timing: one fixed candidate set, both paths do a cone pick and a switch pick per iteration
+	RandomCandidates(rng, numCandidates, locations, batch);
+	const FVector origin = FVector::ZeroVector;
+	const FVector refDir = FVector::ForwardVector;
+	int32 sink = 0;
+
+	double startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; i++)
+	{
+		int32 left, right;
+		sink += FAshLockOnKernel::PickBestInCone_Scalar(locations, origin, refDir, coneDegrees);
+		FAshLockOnKernel::PickSwitchTargets_Scalar(locations, origin, refDir, i % numCandidates, left, right);
+		sink += left + right;
+	}
+	const double scalarSeconds = FPlatformTime::Seconds() - startTime;
+
+	startTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < iterations; i++)
+	{
+		//AS: Re-read positions every iteration like the character does, the batch is rebuilt from the same components anyway
+		int32 left, right;
+		FAshLockOnKernel::Evaluate(batch, origin, refDir);
+		sink += FAshLockOnKernel::PickBestInCone(batch, FAshLockOnKernel::ConeKey(coneDegrees));
+		FAshLockOnKernel::PickSwitchTargets(batch, i % numCandidates, left, right);
+		sink += left + right;
+	}
+	const double simdSeconds = FPlatformTime::Seconds() - startTime;
+
+	const double perCandidate = 1.e9 / ((double)iterations * (double)numCandidates);
+
+	UE_LOG(LogAshForest, Log, TEXT("LockOnKernelBench: %d candidates x %d iterations (sink %d)"), numCandidates, iterations, sink);
+	UE_LOG(LogAshForest, Log, TEXT("  scalar: %.3fms total, %.2fns/candidate"), scalarSeconds * 1000.0, scalarSeconds * perCandidate);
+	UE_LOG(LogAshForest, Log, TEXT("  simd:   %.3fms total, %.2fns/candidate (%.2fx)"), simdSeconds * 1000.0, simdSeconds * perCandidate, simdSeconds > 0.0 ? scalarSeconds / simdSeconds : 0.0);
+
+	if (coneMismatches > 0 || switchMismatches > 0)
+		UE_LOG(LogAshForest, Error, TEXT("  exactness FAILED: %d cone and %d switch mismatches out of %d trials"), coneMismatches, switchMismatches, iterations);
+	else
+		UE_LOG(LogAshForest, Log, TEXT("  exactness OK: %d trials match the scalar reference"), iterations);
+}
+
+static FAutoConsoleCommand AshForestLockOnKernelBenchCmd(
+	TEXT("AshForest.LockOnKernelBench"),
+	TEXT("Times the SIMD lock-on kernel against the scalar acos path and checks they pick the same targets. Args: [NumCandidates=32] [Iterations=20000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunLockOnKernelBench));
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLockOnRing.h"
+#include "Components/SceneComponent.h"
+
+float FAshLockOnRing::PseudoAngle(const FVector & Dir)
+{
+	const float sum = FMath::Abs(Dir.X) + FMath::Abs(Dir.Y);
+	if (sum <= SMALL_NUMBER)
+		return 0.f;
+
+	//AS: Same ordering as atan2(Y, X) wrapped to [0, 2PI)
+	const float p = Dir.Y / sum;
+
+	if (Dir.X < 0.f)
+		return 2.f - p;
+
+	return Dir.Y < 0.f ? 4.f + p : p;
+}
+
+void FAshLockOnRing::Reset()
+{
+	Entries.Reset();
+}
+
+void FAshLockOnRing::Rebuild(TArrayView<USceneComponent* const> Targets, const FVector & InOrigin)
+{
+	//AS: Keep surviving entries where they are so the sort below stays close to linear
+	for (int32 i = Entries.Num() - 1; i >= 0; i--)
+	{
+		if (!Entries[i].Target.IsValid() || !Targets.Contains(Entries[i].Target.Get()))
+			Entries.RemoveAt(i, 1, false);
+	}
+
+	for (auto currTarget : Targets)
+	{
+		if (currTarget && !Entries.ContainsByPredicate([currTarget](const FEntry& Entry) { return Entry.Target == currTarget; }))
+		{
+			auto& entry = Entries[Entries.AddDefaulted()];
+			entry.Target = currTarget;
+		}
+	}
+
+	Update(InOrigin);
+}
+
+void FAshLockOnRing::Update(const FVector & InOrigin)
+{
+	Origin = InOrigin;
+
+	for (int32 i = Entries.Num() - 1; i >= 0; i--)
+	{
+		auto& entry = Entries[i];
+
+		if (!entry.Target.IsValid())
+		{
+			Entries.RemoveAt(i, 1, false);
+			continue;
+		}
+
+		entry.Location = entry.Target->GetComponentLocation();
+		entry.Angle = PseudoAngle(entry.Location - Origin);
+	}
+
+	SortEntries();
+}
+
+void FAshLockOnRing::SortEntries()
+{
+	for (int32 i = 1; i < Entries.Num(); i++)
+	{
+		if (Entries[i - 1].Angle <= Entries[i].Angle)
+			continue;
+
+		FEntry moving = Entries[i];
+		int32 j = i - 1;
+
+		while (j >= 0 && Entries[j].Angle > moving.Angle)
+		{
+			Entries[j + 1] = Entries[j];
+			j--;
+		}
+
+		Entries[j + 1] = moving;
+	}
+}
+
+int32 FAshLockOnRing::Find(const USceneComponent* Target) const
+{
+	if (!Target || Entries.Num() <= 0)
+		return INDEX_NONE;
+
+	const float angle = PseudoAngle(Target->GetComponentLocation() - Origin);
+
+	int32 low = 0;
+	int32 high = Entries.Num();
+
+	while (low < high)
+	{
+		const int32 mid = (low + high) / 2;
+
+		if (Entries[mid].Angle < angle)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	//AS: The target may have moved since the last Update, look outwards from where it should be
+	for (int32 offset = 0; offset < Entries.Num(); offset++)
+	{
+		const int32 after = (low + offset) % Entries.Num();
+		const int32 before = (low - 1 - offset + Entries.Num() * 2) % Entries.Num();
+
+		if (Entries[after].Target == Target)
+			return after;
+
+		if (Entries[before].Target == Target)
+			return before;
+	}
+
+	return INDEX_NONE;
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLockOnVisibility.h"
+#include "AshForest.h"
+#include "Engine/World.h"
+#include "Components/SceneComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lock On LOS Traces"), STAT_AshLockOnLOSTraces, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lock On LOS Cache Hits"), STAT_AshLockOnLOSCacheHits, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lock On LOS Background Refreshes"), STAT_AshLockOnLOSRefreshes, STATGROUP_AshForest);
+
+//AS: Entries nobody has asked about for this long are dropped
+static const float LockOnVisibilityForgetTime = 2.f;
+
+FAshLockOnVisibilityCache::FAshLockOnVisibilityCache()
+	: MaxAge(.25f), MoveTolerance(50.f), RefreshPerFrame(2)
+{
+}
+
+void FAshLockOnVisibilityCache::Reset()
+{
+	Entries.Reset();
+}
+
+bool FAshLockOnVisibilityCache::Trace(UWorld* World, USceneComponent* Target, const FVector & TargetLoc, const FVector & ViewLoc, const FCollisionQueryParams & Params) const
+{
+	INC_DWORD_STAT(STAT_AshLockOnLOSTraces);
+
+	FHitResult blockingHit;
+	const bool bBlocked = World->LineTraceSingleByChannel(blockingHit, ViewLoc, TargetLoc, ECC_Camera, Params);
+
+	//AS: Hitting the target itself still counts as a clear path
+	return !bBlocked || (blockingHit.Actor != NULL && blockingHit.Actor == Target->GetOwner());
+}
+
+bool FAshLockOnVisibilityCache::IsFresh(const FEntry & Entry, const FVector & TargetLoc, const FVector & ViewLoc, const float Now) const
+{
+	const float moveToleranceSq = FMath::Square(MoveTolerance);
+
+	return Now - Entry.TraceTime <= MaxAge
+		&& FVector::DistSquared(Entry.TargetLoc, TargetLoc) <= moveToleranceSq
+		&& FVector::DistSquared(Entry.ViewLoc, ViewLoc) <= moveToleranceSq;
+}
+
+bool FAshLockOnVisibilityCache::IsVisible(UWorld* World, USceneComponent* Target, const FVector & TargetLoc, const FVector & ViewLoc, const FCollisionQueryParams & Params)
+{
+	const float now = World->GetTimeSeconds();
+	FEntry* entry = Entries.FindByPredicate([Target](const FEntry& Entry) { return Entry.Target == Target; });
+
+	if (entry)
+	{
+		entry->LastUsedTime = now;
+
+		if (IsFresh(*entry, TargetLoc, ViewLoc, now))
+		{
+			INC_DWORD_STAT(STAT_AshLockOnLOSCacheHits);
+			return entry->bVisible;
+		}
+	}
+	else
+	{
+		entry = &Entries[Entries.AddDefaulted()];
+		entry->Target = Target;
+		entry->LastUsedTime = now;
+	}
+
+	entry->bVisible = Trace(World, Target, TargetLoc, ViewLoc, Params);
+	entry->TargetLoc = TargetLoc;
+	entry->ViewLoc = ViewLoc;
+	entry->TraceTime = now;
+
+	return entry->bVisible;
+}
+
+void FAshLockOnVisibilityCache::RefreshStale(UWorld* World, const FVector & ViewLoc, const FCollisionQueryParams & Params)
+{
+	const float now = World->GetTimeSeconds();
+
+	for (int32 i = Entries.Num() - 1; i >= 0; i--)
+	{
+		if (!Entries[i].Target.IsValid() || now - Entries[i].LastUsedTime > LockOnVisibilityForgetTime)
+			Entries.RemoveAtSwap(i, 1, false);
+	}
+
+	//AS: Oldest first, and only entries that are past half their lifetime or have moved, so a refresh lands before the next lookup needs it
+	for (int32 refreshed = 0; refreshed < RefreshPerFrame; refreshed++)
+	{
+		FEntry* oldest = NULL;
+
+		for (auto& entry : Entries)
+		{
+			if (entry.TraceTime == now)
+				continue;
+
+			const FVector targetLoc = entry.Target->GetComponentLocation();
+			const bool bNeedsRefresh = now - entry.TraceTime > MaxAge * .5f || !IsFresh(entry, targetLoc, ViewLoc, now);
+
+			if (bNeedsRefresh && (!oldest || entry.TraceTime < oldest->TraceTime))
+				oldest = &entry;
+		}
+
+		if (!oldest)
+			break;
+
+		INC_DWORD_STAT(STAT_AshLockOnLOSRefreshes);
+
+		oldest->TargetLoc = oldest->Target->GetComponentLocation();
+		oldest->ViewLoc = ViewLoc;
+		oldest->TraceTime = now;
+		oldest->bVisible = Trace(World, oldest->Target.Get(), oldest->TargetLoc, ViewLoc, Params);
+	}
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestLockOnWidget.h"
+#include "AshForestCharacter.h"
+
+void UAshForestLockOnWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	BoundCharacter = GetOwningAshCharacter();
+
+	if (BoundCharacter.IsValid())
+	{
+		BoundCharacter->OnLockOnTargetChanged.AddDynamic(this, &UAshForestLockOnWidget::HandleLockOnTargetChanged);
+		HandleLockOnTargetChanged(BoundCharacter->GetLockOnTarget(), NULL);
+	}
+}
+
+void UAshForestLockOnWidget::NativeDestruct()
+{
+	if (BoundCharacter.IsValid())
+		BoundCharacter->OnLockOnTargetChanged.RemoveDynamic(this, &UAshForestLockOnWidget::HandleLockOnTargetChanged);
+
+	BoundCharacter = NULL;
+
+	Super::NativeDestruct();
+}
+
+void UAshForestLockOnWidget::HandleLockOnTargetChanged(USceneComponent* NewTarget, USceneComponent* PreviousTarget)
+{
+	if (DisplayedTarget == NewTarget)
+		return;
+
+	DisplayedTarget = NewTarget;
+
+	OnLockOnTargetDisplayed(NewTarget, PreviousTarget);
+	MarkContentChanged();
+}
@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestMemory.h"
+#include "AshForest.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Engine/TriggerBase.h"
+#include "AshForestCharacter.h"
+#include "AshForestCreature.h"
+#include "AshForestProjectile.h"
+#include "AshForestTrigger.h"
+#include "AshForestCollectable.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+static_assert((int32)EAshForestLLMTag::EAshLLM_CHARACTERS == (int32)ELLMTag::ProjectTagStart, "AshForest LLM tags must start at ELLMTag::ProjectTagStart");
+static_assert((int32)EAshForestLLMTag::EAshLLM_MAX <= (int32)ELLMTag::ProjectTagEnd, "Too many AshForest LLM tags");
+
+DECLARE_LLM_MEMORY_STAT(TEXT("AshCharacters"), STAT_AshCharactersLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("AshCreatures"), STAT_AshCreaturesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("AshProjectiles"), STAT_AshProjectilesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("AshVFX"), STAT_AshVFXLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("AshTriggers"), STAT_AshTriggersLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("AshCollectables"), STAT_AshCollectablesLLM, STATGROUP_LLMFULL);
+#endif
+
+static FAutoConsoleCommandWithWorldAndArgs AshForestMemReportCmd(
+	TEXT("AshForest.MemReport"),
+	TEXT("Prints actor/component counts and estimated bytes per loaded sublevel. Pass 'csv' to also write Saved/Profiling/AshForest/MemReport-*.csv"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UAshForestMemoryLibrary::PrintSublevelMemoryReport(World, Args.Contains(TEXT("csv")));
+	}));
+
+void UAshForestMemoryLibrary::RegisterLLMTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	auto& tracker = FLowLevelMemTracker::Get();
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_CHARACTERS, TEXT("AshCharacters"), GET_STATFNAME(STAT_AshCharactersLLM), NAME_None);
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_CREATURES, TEXT("AshCreatures"), GET_STATFNAME(STAT_AshCreaturesLLM), NAME_None);
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_PROJECTILES, TEXT("AshProjectiles"), GET_STATFNAME(STAT_AshProjectilesLLM), NAME_None);
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_VFX, TEXT("AshVFX"), GET_STATFNAME(STAT_AshVFXLLM), NAME_None);
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_TRIGGERS, TEXT("AshTriggers"), GET_STATFNAME(STAT_AshTriggersLLM), NAME_None);
+	tracker.RegisterProjectTag((int32)EAshForestLLMTag::EAshLLM_COLLECTABLES, TEXT("AshCollectables"), GET_STATFNAME(STAT_AshCollectablesLLM), NAME_None);
+#endif
+}
+
+static int64 EstimateObjectBytes(UObject* Obj)
+{
+	//AS: Property memory (including owned containers) plus whatever the object reports as its own resources
+	FArchiveCountMem countMem(Obj);
+	return (int64)countMem.GetMax() + (int64)Obj->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
+
+void UAshForestMemoryLibrary::GetSublevelMemoryReport(const UObject* WorldContextObject, TArray<FAshSublevelMemReport> & OutReports)
+{
+	OutReports.Reset();
+
+	auto world = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : NULL;
+	if (!world)
+		return;
+
+	TArray<UActorComponent*> components;
+
+	for (auto level : world->GetLevels())
+	{
+		if (!level)
+			continue;
+
+		auto& report = OutReports[OutReports.AddDefaulted()];
+		report.LevelName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(level->GetOutermost()->GetName()));
+		report.bIsVisible = level->bIsVisible;
+
+		for (auto currActor : level->Actors)
+		{
+			if (!currActor || currActor->IsPendingKill())
+				continue;
+
+			report.ActorCount++;
+			report.EstimatedBytes += EstimateObjectBytes(currActor);
+
+			if (currActor->IsA(AAshForestCharacter::StaticClass()))
+				report.CharacterCount++;
+			else if (currActor->IsA(AAshForestCreature::StaticClass()))
+				report.CreatureCount++;
+			else if (currActor->IsA(AAshForestProjectile::StaticClass()))
+				report.ProjectileCount++;
+			else if (currActor->IsA(AAshForestTrigger::StaticClass()) || currActor->IsA(ATriggerBase::StaticClass()))
+				report.TriggerCount++;
+			else if (currActor->IsA(AAshForestCollectable::StaticClass()))
+				report.CollectableCount++;
+
+			currActor->GetComponents(components);
+			report.ComponentCount += components.Num();
+
+			for (auto currComp : components)
+			{
+				report.EstimatedBytes += EstimateObjectBytes(currComp);
+
+				if (currComp->IsA(UParticleSystemComponent::StaticClass()))
+					report.ParticleComponentCount++;
+			}
+		}
+
+		report.EstimatedKB = (float)((double)report.EstimatedBytes / 1024.0);
+	}
+}
+
+FString UAshForestMemoryLibrary::PrintSublevelMemoryReport(const UObject* WorldContextObject, const bool bWriteCSV /*= false*/)
+{
+	TArray<FAshSublevelMemReport> reports;
+	GetSublevelMemoryReport(WorldContextObject, reports);
+
+	FAshSublevelMemReport total;
+	FString csv = TEXT("Level,Visible,Actors,Components,Characters,Creatures,Projectiles,ParticleComps,Triggers,Collectables,EstimatedBytes\n");
+
+	UE_LOG(LogAshForest, Log, TEXT("%-40s %4s %7s %7s %5s %5s %5s %5s %5s %5s %12s"), TEXT("Level"), TEXT("Vis"), TEXT("Actors"), TEXT("Comps"), TEXT("Char"), TEXT("Crtr"), TEXT("Proj"), TEXT("VFX"), TEXT("Trig"), TEXT("Coll"), TEXT("Est. KB"));
+
+	for (const auto& report : reports)
+	{
+		UE_LOG(LogAshForest, Log, TEXT("%-40s %4s %7d %7d %5d %5d %5d %5d %5d %5d %12.1f"), *report.LevelName, report.bIsVisible ? TEXT("Y") : TEXT("N"), report.ActorCount, report.ComponentCount,
+			report.CharacterCount, report.CreatureCount, report.ProjectileCount, report.ParticleComponentCount, report.TriggerCount, report.CollectableCount, report.EstimatedKB);
+
+		csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%lld\n"), *report.LevelName, report.bIsVisible ? 1 : 0, report.ActorCount, report.ComponentCount,
+			report.CharacterCount, report.CreatureCount, report.ProjectileCount, report.ParticleComponentCount, report.TriggerCount, report.CollectableCount, report.EstimatedBytes);
+
+		total.ActorCount += report.ActorCount;
+		total.ComponentCount += report.ComponentCount;
+		total.EstimatedBytes += report.EstimatedBytes;
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("TOTAL: %d levels, %d actors, %d components, %.1f KB estimated"), reports.Num(), total.ActorCount, total.ComponentCount, (double)total.EstimatedBytes / 1024.0);
+
+	if (!bWriteCSV)
+		return FString();
+
+	const FString csvPath = FPaths::ProfilingDir() / TEXT("AshForest") / FString::Printf(TEXT("MemReport-%s.csv"), *FDateTime::Now().ToString());
+
+	if (!FFileHelper::SaveStringToFile(csv, *csvPath))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to write memory report to %s"), *csvPath);
+		return FString();
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("Wrote memory report to %s"), *csvPath);
+	return csvPath;
+}
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestMoverComponent.h"
+#include "AshForest.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Movers Tick"), STAT_AshMoversTick, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movers Moving"), STAT_AshMoversMoving, STATGROUP_AshForest);
+
+static FAutoConsoleCommand AshForestMoverStatsCmd(
+	TEXT("AshForest.MoverStats"),
+	TEXT("Prints registered and moving movers per world"),
+	FConsoleCommandDelegate::CreateStatic([]()
+	{
+		FAshMovers::Get().LogStats();
+	}));
+
+void FAshMoverTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (auto world = World.Get())
+		FAshMovers::Get().TickMovers(world, DeltaTime);
+}
+
+FString FAshMoverTickFunction::DiagnosticMessage()
+{
+	return TEXT("FAshMoverTickFunction");
+}
+
+UAshForestMoverComponent::UAshForestMoverComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	OpenOffset = FVector(0.f, 0.f, 300.f);
+	OpenRotation = FRotator::ZeroRotator;
+	MoveCurve = NULL;
+	MoveDuration = 1.f;
+	bDriveFromActivation = true;
+
+	MovedComponent = NULL;
+	MoveTime = 0.f;
+	bTargetOpen = false;
+	bIsMoving = false;
+}
+
+void UAshForestMoverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	auto owner = GetOwner();
+	MovedComponent = owner->GetRootComponent();
+
+	if (MovedComponentName != NAME_None)
+	{
+		TInlineComponentArray<USceneComponent*> sceneComps(owner);
+
+		for (auto currComp : sceneComps)
+		{
+			if (currComp->GetFName() == MovedComponentName)
+			{
+				MovedComponent = currComp;
+				break;
+			}
+		}
+	}
+
+	if (!MovedComponent)
+		return;
+
+	MovedComponent->SetMobility(EComponentMobility::Movable);
+	ClosedRelativeTransform = MovedComponent->GetRelativeTransform();
+
+	FAshMovers::Get().Register(this);
+}
+
+void UAshForestMoverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MovedComponent)
+		FAshMovers::Get().Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UAshForestMoverComponent::Open()
+{
+	StartMove(true);
+}
+
+void UAshForestMoverComponent::Close()
+{
+	StartMove(false);
+}
+
+void UAshForestMoverComponent::StartMove(const bool bOpen)
+{
+	bTargetOpen = bOpen;
+
+	if (!MovedComponent || bIsMoving || MoveTime == (bOpen ? 1.f : 0.f))
+		return;
+
+	bIsMoving = true;
+	FAshMovers::Get().StartMoving(this);
+}
+
+void UAshForestMoverComponent::SnapTo(const bool bOpen)
+{
+	bTargetOpen = bOpen;
+	MoveTime = bOpen ? 1.f : 0.f;
+
+	//AS: A move in flight just finishes on its next update
+	if (MovedComponent)
+		ApplyMoveTime();
+}
+
+bool UAshForestMoverComponent::UpdateMove(const float DeltaTime)
+{
+	if (!MovedComponent)
+	{
+		bIsMoving = false;
+		return false;
+	}
+
+	const float step = MoveDuration > 0.f ? DeltaTime / MoveDuration : 1.f;
+	MoveTime = FMath::Clamp(MoveTime + (bTargetOpen ? step : -step), 0.f, 1.f);
+
+	ApplyMoveTime();
+
+	if (MoveTime != (bTargetOpen ? 1.f : 0.f))
+		return true;
+
+	bIsMoving = false;
+	OnMoveFinished.Broadcast(this, bTargetOpen);
+
+	return false;
+}
+
+void UAshForestMoverComponent::ApplyMoveTime()
+{
+	const float alpha = MoveCurve ? MoveCurve->GetFloatValue(MoveTime) : MoveTime;
+
+	const FVector newLoc = ClosedRelativeTransform.GetLocation() + (OpenOffset * alpha);
+	const FRotator newRot = (ClosedRelativeTransform.Rotator() + (OpenRotation * alpha)).GetNormalized();
+
+	//AS: No sweep and no teleport, so physics sees a kinematic move and based characters ride along
+	MovedComponent->SetRelativeLocationAndRotation(newLoc, newRot, false, NULL, ETeleportType::None);
+}
+
+FAshMovers & FAshMovers::Get()
+{
+	static FAshMovers instance;
+	return instance;
+}
+
+FAshMovers::FAshMovers()
+	: TotalMoves(0), PeakMoving(0)
+{
+}
+
+void FAshMovers::Register(UAshForestMoverComponent* Mover)
+{
+	auto world = Mover->GetWorld();
+	auto& worldMovers = Worlds.FindOrAdd(FObjectKey(world));
+
+	if (!worldMovers.TickFunction.IsValid())
+	{
+		worldMovers.TickFunction = MakeUnique<FAshMoverTickFunction>();
+
+		auto tickFunction = worldMovers.TickFunction.Get();
+		tickFunction->World = world;
+		tickFunction->bCanEverTick = true;
+		tickFunction->bStartWithTickEnabled = false;
+
+		//AS: Same group as character movement, riders are made to wait for it so anyone standing on a mover gets its new position the same frame
+		tickFunction->TickGroup = TG_PrePhysics;
+		tickFunction->RegisterTickFunction(world->PersistentLevel);
+
+		for (const auto& rider : worldMovers.Riders)
+		{
+			if (rider.IsValid())
+				rider->PrimaryComponentTick.AddPrerequisite(world, *tickFunction);
+		}
+	}
+
+	worldMovers.NumRegistered++;
+}
+
+void FAshMovers::Unregister(UAshForestMoverComponent* Mover)
+{
+	const FObjectKey worldKey(Mover->GetWorld());
+	auto worldMovers = Worlds.Find(worldKey);
+	if (!worldMovers)
+		return;
+
+	worldMovers->Moving.RemoveSwap(Mover);
+	worldMovers->NumRegistered--;
+
+	if (worldMovers->NumRegistered <= 0)
+	{
+		if (worldMovers->TickFunction.IsValid())
+		{
+			for (const auto& rider : worldMovers->Riders)
+			{
+				if (rider.IsValid())
+					rider->PrimaryComponentTick.RemovePrerequisite(Mover->GetWorld(), *worldMovers->TickFunction);
+			}
+
+			worldMovers->TickFunction->UnRegisterTickFunction();
+			worldMovers->TickFunction.Reset();
+		}
+
+		worldMovers->Moving.Reset();
+
+		if (worldMovers->Riders.Num() <= 0)
+			Worlds.Remove(worldKey);
+	}
+}
+
+void FAshMovers::AddRider(UActorComponent* Rider)
+{
+	auto world = Rider->GetWorld();
+	auto& worldMovers = Worlds.FindOrAdd(FObjectKey(world));
+
+	if (worldMovers.Riders.Contains(Rider))
+		return;
+
+	worldMovers.Riders.Add(Rider);
+
+	//AS: No movers registered yet, Register adds the prerequisite once the tick function exists
+	if (worldMovers.TickFunction.IsValid())
+		Rider->PrimaryComponentTick.AddPrerequisite(world, *worldMovers.TickFunction);
+}
+
+void FAshMovers::RemoveRider(UActorComponent* Rider)
+{
+	const FObjectKey worldKey(Rider->GetWorld());
+	auto worldMovers = Worlds.Find(worldKey);
+	if (!worldMovers || worldMovers->Riders.RemoveSwap(Rider) <= 0)
+		return;
+
+	if (worldMovers->TickFunction.IsValid())
+		Rider->PrimaryComponentTick.RemovePrerequisite(Rider->GetWorld(), *worldMovers->TickFunction);
+	else if (worldMovers->Riders.Num() <= 0 && worldMovers->NumRegistered <= 0)
+		Worlds.Remove(worldKey);
+}
+
+void FAshMovers::StartMoving(UAshForestMoverComponent* Mover)
+{
+	auto worldMovers = Worlds.Find(FObjectKey(Mover->GetWorld()));
+	if (!worldMovers || !worldMovers->TickFunction.IsValid())
+		return;
+
+	worldMovers->Moving.AddUnique(Mover);
+	PeakMoving = FMath::Max(PeakMoving, worldMovers->Moving.Num());
+	TotalMoves++;
+
+	if (!worldMovers->TickFunction->IsTickFunctionEnabled())
+		worldMovers->TickFunction->SetTickFunctionEnable(true);
+}
+
+void FAshMovers::TickMovers(UWorld* World, const float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshMoversTick);
+
+	auto worldMovers = Worlds.Find(FObjectKey(World));
+	if (!worldMovers)
+		return;
+
+	INC_DWORD_STAT_BY(STAT_AshMoversMoving, worldMovers->Moving.Num());
+
+	for (int32 i = worldMovers->Moving.Num() - 1; i >= 0; i--)
+	{
+		auto mover = worldMovers->Moving[i].Get();
+
+		if (!mover || !mover->UpdateMove(DeltaTime))
+			worldMovers->Moving.RemoveAtSwap(i, 1, false);
+	}
+
+	//AS: Everything has arrived, the tick function sleeps until the next StartMoving
+	if (worldMovers->Moving.Num() <= 0)
+		worldMovers->TickFunction->SetTickFunctionEnable(false);
+}
+
+void FAshMovers::LogStats() const
+{
+	for (const auto& pair : Worlds)
+	{
+		auto world = Cast<UWorld>(pair.Key.ResolveObjectPtr());
+		UE_LOG(LogAshForest, Log, TEXT("Movers in %s: %d registered, %d moving, %d riders, tick %s"), world ? *world->GetName() : TEXT("(gone)"), pair.Value.NumRegistered, pair.Value.Moving.Num(), pair.Value.Riders.Num(),
+			pair.Value.TickFunction.IsValid() && pair.Value.TickFunction->IsTickFunctionEnabled() ? TEXT("awake") : TEXT("asleep"));
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("Movers: %llu moves started, peak %d moving at once"), TotalMoves, PeakMoving);
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestNetPolicy.h"
+#include "AshForest.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Net Static Actors Considered"), STAT_AshNetConsidered, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Net Dormancy Flushes"), STAT_AshNetFlushes, STATGROUP_AshForest);
+
+static TAutoConsoleVariable<float> CVarAshDistanceLevelCullDistance(
+	TEXT("ash.Net.DistanceLevelCullDistance"),
+	30000.f,
+	TEXT("Net cull distance for replicated gameplay actors placed in *_Distance sublevels. Read at BeginPlay"),
+	ECVF_Default);
+
+static uint64 GAshNetConsidered = 0;
+static uint64 GAshNetFlushes = 0;
+
+static FAutoConsoleCommandWithWorldAndArgs AshForestNetDormancyStatsCmd(
+	TEXT("AshForest.NetDormancyStats"),
+	TEXT("Prints how many static gameplay actors are dormant/awake and how often they were considered for replication. Pass 'reset' to clear the counters"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Contains(TEXT("reset")))
+			FAshNetPolicy::ResetStats();
+		else
+			FAshNetPolicy::LogStats(World);
+	}));
+
+void FAshNetPolicy::InitStaticActor(AActor* Actor)
+{
+	Actor->NetDormancy = DORM_Initial;
+
+	//AS: Dormant actors aren't looked at at all, this only matters for the frames after a flush
+	Actor->NetUpdateFrequency = 10.f;
+	Actor->MinNetUpdateFrequency = 1.f;
+}
+
+void FAshNetPolicy::ApplyLevelRelevancy(AActor* Actor)
+{
+	auto level = Actor->GetLevel();
+	if (!level || Actor->GetNetMode() == NM_Standalone)
+		return;
+
+	const FString levelName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(level->GetOutermost()->GetName()));
+
+	if (levelName.EndsWith(TEXT("_Distance")))
+		Actor->NetCullDistanceSquared = FMath::Square(CVarAshDistanceLevelCullDistance.GetValueOnGameThread());
+}
+
+void FAshNetPolicy::Flush(AActor* Actor)
+{
+	if (!Actor || Actor->GetNetMode() == NM_Standalone || Actor->GetNetMode() == NM_Client)
+		return;
+
+	Actor->FlushNetDormancy();
+
+	GAshNetFlushes++;
+	INC_DWORD_STAT(STAT_AshNetFlushes);
+}
+
+void FAshNetPolicy::NoteConsidered(const AActor* Actor)
+{
+	GAshNetConsidered++;
+	INC_DWORD_STAT(STAT_AshNetConsidered);
+}
+
+void FAshNetPolicy::LogStats(UWorld* World)
+{
+	int32 numDormant = 0;
+	int32 numReplicated = 0;
+
+	if (World)
+	{
+		for (TActorIterator<AActor> it(World); it; ++it)
+		{
+			if (!it->GetIsReplicated())
+				continue;
+
+			numReplicated++;
+
+			if (it->NetDormancy == DORM_Initial || it->NetDormancy == DORM_DormantAll)
+				numDormant++;
+		}
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("Net dormancy: %d of %d replicated actors dormant, %llu flushes, %llu relevancy checks on static actors"), numDormant, numReplicated, GAshNetFlushes, GAshNetConsidered);
+}
+
+void FAshNetPolicy::ResetStats()
+{
+	GAshNetConsidered = 0;
+	GAshNetFlushes = 0;
+}
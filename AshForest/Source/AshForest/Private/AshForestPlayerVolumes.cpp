@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestPlayerVolumes.h"
+#include "AshForest.h"
+#include "AshForestCharacter.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player Volumes Update"), STAT_AshPlayerVolumesUpdate, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Player Volume Tests"), STAT_AshPlayerVolumeTests, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Player Volumes Registered"), STAT_AshPlayerVolumesRegistered, STATGROUP_AshForest);
+
+static FAutoConsoleCommandWithArgs AshForestPlayerVolumeStatsCmd(
+	TEXT("AshForest.PlayerVolumeStats"),
+	TEXT("Prints registered player volumes, capsule tests and enter/exit counts. Pass 'reset' to clear the counters"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		if (Args.Contains(TEXT("reset")))
+			FAshPlayerVolumes::Get().ResetStats();
+		else
+			FAshPlayerVolumes::Get().LogStats();
+	}));
+
+FAshPlayerVolumes & FAshPlayerVolumes::Get()
+{
+	static FAshPlayerVolumes instance;
+	return instance;
+}
+
+FAshPlayerVolumes::FAshPlayerVolumes()
+	: CellSize(2048.f), CurrentStamp(0)
+{
+	ResetStats();
+}
+
+FIntPoint FAshPlayerVolumes::GetCell(const FVector & Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FAshPlayerVolumes::Register(AActor* Volume, UBoxComponent* Box, IAshPlayerVolumeListener* Listener)
+{
+	if (!Volume || !Box || !Listener || !Volume->GetWorld())
+		return;
+
+	auto& worldVolumes = Worlds.FindOrAdd(FObjectKey(Volume->GetWorld()));
+
+	int32 entryIndex;
+	if (worldVolumes.FreeEntries.Num() > 0)
+		entryIndex = worldVolumes.FreeEntries.Pop(false);
+	else
+		entryIndex = worldVolumes.Entries.AddDefaulted();
+
+	auto& entry = worldVolumes.Entries[entryIndex];
+	entry.Volume = Volume;
+	entry.Listener = Listener;
+	entry.QueryStamp = 0;
+
+	//AS: Scale goes into the extent so the inverse transform only has to undo rotation and translation
+	entry.BoxToWorld = Box->GetComponentTransform();
+	entry.Extent = Box->GetScaledBoxExtent();
+	entry.BoxToWorld.SetScale3D(FVector(1.f));
+	entry.Bounds = Box->Bounds.GetBox();
+
+	const FIntPoint minCell = GetCell(entry.Bounds.Min);
+	const FIntPoint maxCell = GetCell(entry.Bounds.Max);
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+			worldVolumes.Cells.FindOrAdd(FIntPoint(x, y)).Add(entryIndex);
+	}
+
+	worldVolumes.NumLive++;
+	INC_DWORD_STAT(STAT_AshPlayerVolumesRegistered);
+}
+
+void FAshPlayerVolumes::Unregister(AActor* Volume)
+{
+	if (!Volume)
+		return;
+
+	const FObjectKey worldKey(Volume->GetWorld());
+	auto worldVolumes = Worlds.Find(worldKey);
+	if (!worldVolumes)
+		return;
+
+	for (int32 i = 0; i < worldVolumes->Entries.Num(); i++)
+	{
+		if (worldVolumes->Entries[i].Volume.Get(true) == Volume)
+		{
+			RemoveEntry(*worldVolumes, i);
+			break;
+		}
+	}
+
+	if (worldVolumes->NumLive <= 0)
+		Worlds.Remove(worldKey);
+}
+
+void FAshPlayerVolumes::RemoveEntry(FWorldVolumes & WorldVolumes, const int32 EntryIndex)
+{
+	auto& entry = WorldVolumes.Entries[EntryIndex];
+
+	for (auto& pair : WorldVolumes.Inside)
+	{
+		if (pair.Value.RemoveSwap(EntryIndex) > 0 && pair.Key.IsValid())
+		{
+			TotalExits++;
+			entry.Listener->OnPlayerExitVolume(pair.Key.Get());
+		}
+	}
+
+	const FIntPoint minCell = GetCell(entry.Bounds.Min);
+	const FIntPoint maxCell = GetCell(entry.Bounds.Max);
+
+	for (int32 x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			if (auto cell = WorldVolumes.Cells.Find(FIntPoint(x, y)))
+				cell->RemoveSwap(EntryIndex);
+		}
+	}
+
+	entry.Volume = NULL;
+	entry.Listener = NULL;
+
+	WorldVolumes.FreeEntries.Add(EntryIndex);
+	WorldVolumes.NumLive--;
+	DEC_DWORD_STAT(STAT_AshPlayerVolumesRegistered);
+}
+
+bool FAshPlayerVolumes::IsCapsuleInside(const FEntry & Entry, const FVector & CapsuleLoc, const float Radius, const float HalfHeight) const
+{
+	const FVector local = Entry.BoxToWorld.InverseTransformPositionNoScale(CapsuleLoc);
+
+	return FMath::Abs(local.X) <= Entry.Extent.X + Radius && FMath::Abs(local.Y) <= Entry.Extent.Y + Radius && FMath::Abs(local.Z) <= Entry.Extent.Z + HalfHeight;
+}
+
+void FAshPlayerVolumes::Update(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshPlayerVolumesUpdate);
+
+	auto worldVolumes = Worlds.Find(FObjectKey(World));
+	if (!worldVolumes)
+		return;
+
+	TArray<int32, TInlineAllocator<16>> nowInside;
+
+	for (auto it = World->GetPlayerControllerIterator(); it; ++it)
+	{
+		auto player = it->IsValid() ? Cast<AAshForestCharacter>((*it)->GetPawn()) : NULL;
+		if (!player)
+			continue;
+
+		auto capsule = player->GetCapsuleComponent();
+		const FVector capsuleLoc = capsule->GetComponentLocation();
+		const float radius = capsule->GetScaledCapsuleRadius();
+		const float halfHeight = capsule->GetScaledCapsuleHalfHeight();
+
+		CurrentStamp++;
+		nowInside.Reset();
+
+		int32 numCandidates = 0;
+
+		const FIntPoint minCell = GetCell(capsuleLoc - FVector(radius));
+		const FIntPoint maxCell = GetCell(capsuleLoc + FVector(radius));
+
+		for (int32 x = minCell.X; x <= maxCell.X; x++)
+		{
+			for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+			{
+				auto cell = worldVolumes->Cells.Find(FIntPoint(x, y));
+				if (!cell)
+					continue;
+
+				for (int32 entryIndex : *cell)
+				{
+					auto& entry = worldVolumes->Entries[entryIndex];
+
+					//AS: Boxes spanning several cells only get tested once per player
+					if (entry.QueryStamp == CurrentStamp)
+						continue;
+
+					entry.QueryStamp = CurrentStamp;
+					numCandidates++;
+
+					if (IsCapsuleInside(entry, capsuleLoc, radius, halfHeight))
+						nowInside.Add(entryIndex);
+				}
+			}
+		}
+
+		TotalTests += numCandidates;
+		PeakCandidates = FMath::Max(PeakCandidates, numCandidates);
+		INC_DWORD_STAT_BY(STAT_AshPlayerVolumeTests, numCandidates);
+
+		auto& wasInside = worldVolumes->Inside.FindOrAdd(player);
+
+		//AS: Exits before enters, so leaving one focus trigger for an adjacent one ends on the new trigger
+		for (int32 i = wasInside.Num() - 1; i >= 0; i--)
+		{
+			const int32 entryIndex = wasInside[i];
+
+			if (nowInside.Contains(entryIndex))
+				continue;
+
+			wasInside.RemoveAtSwap(i, 1, false);
+
+			TotalExits++;
+			worldVolumes->Entries[entryIndex].Listener->OnPlayerExitVolume(player);
+		}
+
+		for (int32 entryIndex : nowInside)
+		{
+			if (wasInside.Contains(entryIndex))
+				continue;
+
+			wasInside.Add(entryIndex);
+
+			TotalEnters++;
+			worldVolumes->Entries[entryIndex].Listener->OnPlayerEnterVolume(player);
+		}
+	}
+
+	//AS: Players that went away (respawned pawn, logged out) just drop their state, nothing to exit from
+	for (auto it = worldVolumes->Inside.CreateIterator(); it; ++it)
+	{
+		if (!it.Key().IsValid())
+			it.RemoveCurrent();
+	}
+}
+
+void FAshPlayerVolumes::LogStats() const
+{
+	int32 numVolumes = 0;
+	int32 numCells = 0;
+
+	for (const auto& pair : Worlds)
+	{
+		numVolumes += pair.Value.NumLive;
+		numCells += pair.Value.Cells.Num();
+	}
+
+	UE_LOG(LogAshForest, Log, TEXT("Player volumes: %d registered in %d cells (%d worlds), %llu capsule tests (peak %d per player per frame), %llu enters, %llu exits"),
+		numVolumes, numCells, Worlds.Num(), TotalTests, PeakCandidates, TotalEnters, TotalExits);
+}
+
+void FAshPlayerVolumes::ResetStats()
+{
+	TotalEnters = 0;
+	TotalExits = 0;
+	TotalTests = 0;
+	PeakCandidates = 0;
+}
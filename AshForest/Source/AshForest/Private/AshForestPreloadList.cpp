@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestPreloadList.h"
+
+FPrimaryAssetId UAshForestPreloadList::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(TEXT("AshForestPreloadList"), GetFName());
+}
+
+void UAshForestPreloadList::GatherAssetPaths(TArray<FSoftObjectPath> & OutPaths) const
+{
+	for (const auto& currClass : Classes)
+	{
+		if (!currClass.IsNull())
+			OutPaths.AddUnique(currClass.ToSoftObjectPath());
+	}
+
+	for (const auto& currAsset : Assets)
+	{
+		if (!currAsset.IsNull())
+			OutPaths.AddUnique(currAsset.ToSoftObjectPath());
+	}
+}
@@ -3,12 +3,46 @@
 #include "AshForestProjectile.h"
 #include "Components/CapsuleComponent.h"
 #include "TargetableInterface.h"
+#include "AshForestDamageQueue.h"
+#include "AshForestJobQueue.h"
 #include "Kismet/GameplayStatics.h"
 #include "AshForestCharacter.h"
+#include "AshForestMemory.h"
+#include "AshForest.h"
+#include "Engine/AssetManager.h"
+#include "Particles/ParticleSystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Spawns Sent"), STAT_AshProjectileSpawnsSent, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Deflect Events Applied"), STAT_AshProjectileDeflectsApplied, STATGROUP_AshForest);
+
+//AS: Position samples are taken at this rate, 16 of them cover ~.5s of rewind
+static const float ProjectileHistoryInterval = 1.f / 30.f;
+
+//AS: A spawn that arrives later than this isn't fast forwarded any further, the copy just starts behind
+static const float MaxSpawnFastForward = .5f;
+
+static uint16 GNextProjectileNetId = 1;
+static uint32 GProjectileSpawnsSent = 0;
+static uint32 GProjectileSimulatedSpawns = 0;
+static uint32 GProjectileDeflectsApplied = 0;
+static uint32 GProjectileDeflectsDropped = 0;
+
+static FAutoConsoleCommand AshForestProjectileNetStatsCmd(
+	TEXT("AshForest.ProjectileNetStats"),
+	TEXT("Prints projectile spawn params sent/simulated and deflection events applied/dropped"),
+	FConsoleCommandDelegate::CreateStatic([]()
+	{
+		AAshForestProjectile::LogNetStats();
+	}));
 
 // Sets default values
 AAshForestProjectile::AAshForestProjectile()
 {
+	ASH_LLM_SCOPE(PROJECTILES);
+
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -25,6 +59,12 @@ AAshForestProjectile::AAshForestProjectile()
 	ProjMoveComp = CreateDefaultSubobject<UProjectileMovementComponent>("ProjMovementComp");
 
 	ProjectileDamage = 20.f;
+
+	//AS: Spawn params and deflection events are all that goes over the wire, see AAshForestCreature::MulticastFireProjectile
+	bReplicates = false;
+	bIsAuthoritativeCopy = true;
+	NetProjectileId = 0;
+	LastDeflectEventId = 0;
 }
 
 // Called when the game starts or when spawned
@@ -32,6 +72,9 @@ void AAshForestProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	//AS: Normally resident through the preload list, the handle just keeps it that way while we're alive
+	if (!ExplosionVFX.IsNull())
+		ExplosionVFXHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ExplosionVFX.ToSoftObjectPath());
 }
 
 void AAshForestProjectile::InitProjectile(APawn* FromInstigator)
@@ -41,6 +84,131 @@ void AAshForestProjectile::InitProjectile(APawn* FromInstigator)
 	Instigator = FromInstigator;
 }
 
+AAshForestProjectile* AAshForestProjectile::SpawnFromParams(UWorld* World, UClass* ProjectileClass, APawn* FromInstigator, FAshProjectileSpawnParams & Params)
+{
+	if (!World || !ProjectileClass || !FromInstigator)
+		return NULL;
+
+	ASH_LLM_SCOPE(PROJECTILES);
+
+	const bool bAuthoritative = World->GetNetMode() != NM_Client;
+	const FTransform spawnTrans(Params.Direction.Rotation(), Params.Origin, FVector(1.f));
+
+	auto projectile = World->SpawnActorDeferred<AAshForestProjectile>(ProjectileClass, spawnTrans, (AActor*)FromInstigator, FromInstigator, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!projectile)
+		return NULL;
+
+	projectile->InitProjectile(FromInstigator);
+	projectile->bIsAuthoritativeCopy = bAuthoritative;
+
+	if (bAuthoritative)
+	{
+		Params.ProjectileId = GNextProjectileNetId++;
+
+		//AS: 0 means "no id"
+		if (GNextProjectileNetId == 0)
+			GNextProjectileNetId = 1;
+
+		if (World->GetNetMode() != NM_Standalone)
+		{
+			Params.ServerSpawnTime = World->GetTimeSeconds();
+			GProjectileSpawnsSent++;
+			INC_DWORD_STAT(STAT_AshProjectileSpawnsSent);
+		}
+	}
+	else
+		GProjectileSimulatedSpawns++;
+
+	projectile->NetProjectileId = Params.ProjectileId;
+	projectile->FinishSpawning(spawnTrans, true);
+
+	if (!projectile->IsValidLowLevel())
+		return NULL;
+
+	//AS: Reset to fix any directional errors caused by adjusting the spawn location
+	projectile->SetActorTransform(spawnTrans);
+
+	//AS: Projectiles fly straight at a fixed speed, so catching the simulated copy up is a single step along the spawn direction
+	if (!bAuthoritative)
+	{
+		auto gameState = World->GetGameState();
+		const float lateBy = gameState ? FMath::Clamp(gameState->GetServerWorldTimeSeconds() - Params.ServerSpawnTime, 0.f, MaxSpawnFastForward) : 0.f;
+
+		if (lateBy > 0.f)
+			projectile->SetActorLocation(Params.Origin + (FVector(Params.Direction) * projectile->GetProjectileMovement()->Velocity.Size() * lateBy), true);
+	}
+
+	return projectile;
+}
+
+AAshForestProjectile* AAshForestProjectile::FindByNetId(UWorld* World, const uint16 ProjectileId)
+{
+	if (!World || ProjectileId == 0)
+		return NULL;
+
+	//AS: Only a handful of projectiles are ever alive, a lookup table per world isn't worth keeping in sync
+	for (TActorIterator<AAshForestProjectile> it(World); it; ++it)
+	{
+		if (it->NetProjectileId == ProjectileId && !it->IsPendingKill())
+			return *it;
+	}
+
+	return NULL;
+}
+
+void AAshForestProjectile::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//AS: Only the server copy needs history, and only when there are clients to validate
+	if (!bIsAuthoritativeCopy || GetNetMode() == NM_Standalone)
+		return;
+
+	PositionHistory.Record(GetWorld()->GetTimeSeconds(), GetActorLocation(), ProjectileHistoryInterval);
+}
+
+FVector AAshForestProjectile::GetRewoundLocation(const float ServerTime) const
+{
+	FVector location;
+	return PositionHistory.GetAtTime(ServerTime, location) ? location : GetActorLocation();
+}
+
+FAshProjectileDeflectEvent AAshForestProjectile::MakeDeflectEvent(APawn* Deflector)
+{
+	FAshProjectileDeflectEvent deflectEvent;
+	deflectEvent.ProjectileId = NetProjectileId;
+	deflectEvent.EventId = ++LastDeflectEventId;
+	deflectEvent.Location = GetActorLocation();
+	deflectEvent.Velocity = GetProjectileMovement()->Velocity;
+	deflectEvent.Deflector = Deflector;
+
+	return deflectEvent;
+}
+
+void AAshForestProjectile::ApplyDeflectEvent(const FAshProjectileDeflectEvent & Event)
+{
+	//AS: Wrapping compare, an event is new if it's at most half the id range ahead of the last one
+	if ((int8)(Event.EventId - LastDeflectEventId) <= 0)
+	{
+		GProjectileDeflectsDropped++;
+		return;
+	}
+
+	LastDeflectEventId = Event.EventId;
+
+	SetActorLocation(Event.Location);
+	OnDeflected(Event.Deflector, Event.Velocity);
+
+	GProjectileDeflectsApplied++;
+	INC_DWORD_STAT(STAT_AshProjectileDeflectsApplied);
+}
+
+void AAshForestProjectile::LogNetStats()
+{
+	UE_LOG(LogAshForest, Log, TEXT("Projectile net: %u spawns sent, %u simulated on this client, %u deflect events applied, %u dropped as stale"),
+		GProjectileSpawnsSent, GProjectileSimulatedSpawns, GProjectileDeflectsApplied, GProjectileDeflectsDropped);
+}
+
 bool AAshForestProjectile::IgnoreProjectileHit_Implementation(const FHitResult & ForHit)
 {
 	return ForHit.Actor == NULL || ForHit.Actor == this || ForHit.Actor == Instigator;
@@ -48,7 +216,24 @@ bool AAshForestProjectile::IgnoreProjectileHit_Implementation(const FHitResult &
 
 void AAshForestProjectile::OnProjectileExplode_Implementation(const FHitResult & ExplodeFromHit)
 {
-	if (ExplosionVFX) UGameplayStatics::SpawnEmitterAtLocation(this, ExplosionVFX, GetActorLocation(), GetActorRotation(), true);
+	if (auto explosionVFX = ExplosionVFX.Get())
+	{
+		//AS: The world is the context since we're destroyed below, the emitter only needs the spot we exploded at
+		UWorld* world = GetWorld();
+		TWeakObjectPtr<UParticleSystem> vfx = explosionVFX;
+		const FVector spawnLoc = GetActorLocation();
+		const FRotator spawnRot = GetActorRotation();
+
+		FAshJobQueue::Get().Post(world, TEXT("ProjectileExplosionVFX"), EAshJobPriority::EAshJob_NORMAL, .05f, [world, vfx, spawnLoc, spawnRot]()
+		{
+			ASH_LLM_SCOPE(VFX);
+
+			if (vfx.IsValid())
+				UGameplayStatics::SpawnEmitterAtLocation(world, vfx.Get(), spawnLoc, spawnRot, true);
+		});
+	}
+	else if (!ExplosionVFX.IsNull())
+		UE_LOG(LogAshForest, Verbose, TEXT("%s exploded before %s finished loading, add it to the map's preload list"), *GetName(), *ExplosionVFX.ToString());
 	
 	Destroy();
 }
@@ -72,7 +257,10 @@ void AAshForestProjectile::OnProjectileHit(UPrimitiveComponent * HitComponent, A
 	{
 		if (hitPlayer->GetCurrentAshMoveState() == EAshCustomMoveState::EAshMove_DASHING)
 		{
-			hitPlayer->DeflectProjectile(this);
+			//AS: Simulated copies only predict deflections by the local player, everyone else's come in as events
+			if (bIsAuthoritativeCopy || hitPlayer->IsLocallyControlled())
+				hitPlayer->DeflectProjectile(this);
+
 			return;
 		}
 	}
@@ -80,8 +268,9 @@ void AAshForestProjectile::OnProjectileHit(UPrimitiveComponent * HitComponent, A
 	if (IgnoreProjectileHit(Hit))
 		return;
 
-	if (OtherActor->GetClass()->ImplementsInterface(UTargetableInterface::StaticClass()))
-		ITargetableInterface::Execute_TakeDamage(OtherActor, this, ProjectileDamage, Hit);
+	//AS: Simulated copies still explode for the VFX, damage is the server copy's job
+	if (bIsAuthoritativeCopy)
+		FAshDamageQueue::Get().Enqueue(OtherActor, this, ProjectileDamage, Hit);
 
 	OnProjectileExplode(Hit);
 }
\ No newline at end of file
@@ -0,0 +1,536 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestSaveSystem.h"
+#include "AshForest.h"
+#include "AshForestCharacter.h"
+#include "AshForestCheckpoint.h"
+#include "AshForestGameMode.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <stdio.h>
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Save Snapshot"), STAT_AshSaveSnapshot, STATGROUP_AshForest);
+DECLARE_CYCLE_STAT(TEXT("Save Apply Load"), STAT_AshSaveApply, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Save Snapshot (ms)"), STAT_AshSaveSnapshotMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Save Serialize (ms)"), STAT_AshSaveSerializeMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Save Compress (ms)"), STAT_AshSaveCompressMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Save Write (ms)"), STAT_AshSaveWriteMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Load Read (ms)"), STAT_AshLoadReadMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Load Decompress (ms)"), STAT_AshLoadDecompressMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Load Deserialize (ms)"), STAT_AshLoadDeserializeMs, STATGROUP_AshForest);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Load Apply (ms)"), STAT_AshLoadApplyMs, STATGROUP_AshForest);
+
+static const uint32 AshSaveMagic = 0x56534841; //AS: "AHSV"
+static const uint32 AshSaveVersion = 1;
+static const int32 AshSaveHeaderSize = 16;
+static const int32 AshSaveMaxUncompressedSize = 64 * 1024 * 1024;
+
+//AS: A loaded save whose checkpoint sublevel never shows up is dropped after this long
+static const double AshSaveApplyTimeout = 10.0;
+
+static TAutoConsoleVariable<int32> CVarAshSaveEnabled(
+	TEXT("ash.Save.Enabled"),
+	1,
+	TEXT("0 stops checkpoint progress from being saved or loaded"),
+	ECVF_Default);
+
+static FAutoConsoleCommand AshForestSaveStatsCmd(
+	TEXT("AshForest.SaveStats"),
+	TEXT("Prints save/load counts, sizes and the time spent in each stage of the last save and load. Pass 'reset' to clear"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		FAshSaveSystem::Get().LogStats();
+
+		if (Args.Contains(TEXT("reset")))
+			FAshSaveSystem::Get().ResetStats();
+	}));
+
+static FAutoConsoleCommandWithWorld AshForestSaveDeleteCmd(
+	TEXT("AshForest.SaveDelete"),
+	TEXT("Deletes the saved progress for the current map"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		FAshSaveSystem::Get().Flush();
+
+		const FString path = FAshSaveSystem::GetSavePath(FAshSaveSystem::GetMapName(World));
+		UE_LOG(LogAshForest, Log, TEXT("%s %s"), IFileManager::Get().Delete(*path, false, false, true) ? TEXT("Deleted") : TEXT("Couldn't delete"), *path);
+
+		//AS: Otherwise a leftover .tmp would be picked up as the save
+		IFileManager::Get().Delete(*(path + TEXT(".tmp")), false, false, true);
+	}));
+
+static FAutoConsoleCommandWithWorld AshForestSaveCheckCmd(
+	TEXT("AshForest.SaveCheck"),
+	TEXT("Scrambles every SaveGame bool/int of the snapshot actors, then restores them from a snapshot that went through a save file and back. Logs any value that didn't survive"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		FAshSaveSystem::VerifySaveRoundTrip(World);
+	}),
+	ECVF_Cheat);
+
+/** Checks the header against the file, fills in the sizes if it's a complete save */
+static bool ReadSaveHeader(const TArray<uint8> & FileData, int32 & OutUncompressedSize, int32 & OutCompressedSize)
+{
+	uint32 magic = 0;
+	uint32 version = 0;
+	OutUncompressedSize = 0;
+	OutCompressedSize = 0;
+
+	if (FileData.Num() >= AshSaveHeaderSize)
+	{
+		FMemory::Memcpy(&magic, FileData.GetData(), sizeof(uint32));
+		FMemory::Memcpy(&version, FileData.GetData() + 4, sizeof(uint32));
+		FMemory::Memcpy(&OutUncompressedSize, FileData.GetData() + 8, sizeof(int32));
+		FMemory::Memcpy(&OutCompressedSize, FileData.GetData() + 12, sizeof(int32));
+	}
+
+	return magic == AshSaveMagic && version == AshSaveVersion && OutCompressedSize == FileData.Num() - AshSaveHeaderSize
+		&& OutUncompressedSize > 0 && OutUncompressedSize <= AshSaveMaxUncompressedSize;
+}
+
+FArchive& operator<<(FArchive& Ar, FAshSaveData& Data)
+{
+	Ar << Data.MapName;
+	Ar << Data.CheckpointKey;
+	Ar << Data.CheckpointIndex;
+	Ar << Data.SmolMoniez;
+	Ar << Data.BigUnitMoniez;
+	Ar << Data.ActorKeys;
+	Ar << Data.Snapshot;
+	return Ar;
+}
+
+FAshSaveSystem & FAshSaveSystem::Get()
+{
+	static FAshSaveSystem instance;
+	return instance;
+}
+
+FAshSaveSystem::FAshSaveSystem()
+	: bLoadUnclaimed(false), ApplyWaitStartTime(0.0)
+{
+	ResetStats();
+}
+
+FString FAshSaveSystem::GetSavePath(const FString & MapName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / FString::Printf(TEXT("Ash_%s.ashsave"), *MapName);
+}
+
+FString FAshSaveSystem::GetMapName(UWorld* World)
+{
+	return World ? UWorld::RemovePIEPrefix(FPackageName::GetShortName(World->GetOutermost()->GetName())) : FString();
+}
+
+void FAshSaveSystem::RequestSave(UWorld* World)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshSaveSnapshot);
+	check(IsInGameThread());
+
+	if (!World || CVarAshSaveEnabled.GetValueOnGameThread() == 0)
+		return;
+
+	auto gameMode = World->GetAuthGameMode<AAshForestGameMode>();
+	auto player = Cast<AAshForestCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+
+	if (!gameMode || !player || !player->GetLatestCheckpoint())
+		return;
+
+	const double startTime = FPlatformTime::Seconds();
+
+	//AS: Plain copies only, the snapshot blob was already captured by the game mode
+	TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> data = MakeShareable(new FAshSaveData());
+	data->MapName = GetMapName(World);
+	data->CheckpointKey = FAshForestLevelSnapshot::GetActorKey(player->GetLatestCheckpoint());
+	data->CheckpointIndex = player->GetLatestCheckpointIndex();
+	data->SmolMoniez = player->CurrentSmolMoniez;
+	data->BigUnitMoniez = player->CurrentBigUnitMoniez;
+	data->Snapshot = gameMode->GetCheckpointSnapshot();
+	data->Snapshot.GetActorKeys(data->ActorKeys);
+
+	LastSnapshotMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+	SET_FLOAT_STAT(STAT_AshSaveSnapshotMs, LastSnapshotMs);
+
+	//AS: Only the newest progress matters, anything queued behind the save in flight is replaced
+	if (SaveInFlight.IsValid())
+	{
+		if (PendingSave.IsValid())
+			TotalCoalesced++;
+
+		PendingSave = data;
+		return;
+	}
+
+	StartSave(data);
+}
+
+void FAshSaveSystem::StartSave(TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> Data)
+{
+	TotalSaves++;
+
+	const FString path = GetSavePath(Data->MapName);
+
+	SaveInFlight = Async<FSaveResult>(EAsyncExecution::ThreadPool, [Data, path]()
+	{
+		return WriteSave(*Data, path);
+	});
+}
+
+void FAshSaveSystem::RecordSaveResult(const FSaveResult & Result)
+{
+	LastSave = Result;
+
+	if (!LastSave.bSuccess)
+		TotalFailed++;
+
+	SET_FLOAT_STAT(STAT_AshSaveSerializeMs, LastSave.SerializeMs);
+	SET_FLOAT_STAT(STAT_AshSaveCompressMs, LastSave.CompressMs);
+	SET_FLOAT_STAT(STAT_AshSaveWriteMs, LastSave.WriteMs);
+}
+
+bool FAshSaveSystem::ReplaceFile(const FString & To, const FString & From)
+{
+	const FString toPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*To);
+	const FString fromPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*From);
+
+#if PLATFORM_WINDOWS
+	return MoveFileExW(*fromPath, *toPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+	//AS: rename(2) swaps the directory entry in one step, there's never a moment without a save
+	return rename(TCHAR_TO_UTF8(*fromPath), TCHAR_TO_UTF8(*toPath)) == 0;
+#else
+	//AS: No atomic replace we know of here, ReadSave falls back to a complete .tmp if we die between the delete and the move
+	return IFileManager::Get().Move(*To, *From, true, true);
+#endif
+}
+
+FAshSaveSystem::FSaveResult FAshSaveSystem::WriteSave(FAshSaveData & Data, const FString & Path)
+{
+	FSaveResult result;
+	double stageStart = FPlatformTime::Seconds();
+
+	TArray<uint8> rawData;
+	FMemoryWriter writer(rawData, true);
+	writer << Data;
+
+	double now = FPlatformTime::Seconds();
+	result.SerializeMs = (now - stageStart) * 1000.0;
+	result.UncompressedBytes = rawData.Num();
+	stageStart = now;
+
+	int32 compressedSize = FCompression::CompressMemoryBound(NAME_Zlib, rawData.Num());
+
+	TArray<uint8> fileData;
+	fileData.SetNumUninitialized(AshSaveHeaderSize + compressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, fileData.GetData() + AshSaveHeaderSize, compressedSize, rawData.GetData(), rawData.Num()))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to compress save for %s"), *Data.MapName);
+		return result;
+	}
+
+	fileData.SetNum(AshSaveHeaderSize + compressedSize, false);
+
+	const int32 uncompressedSize = rawData.Num();
+	FMemory::Memcpy(fileData.GetData(), &AshSaveMagic, sizeof(uint32));
+	FMemory::Memcpy(fileData.GetData() + 4, &AshSaveVersion, sizeof(uint32));
+	FMemory::Memcpy(fileData.GetData() + 8, &uncompressedSize, sizeof(int32));
+	FMemory::Memcpy(fileData.GetData() + 12, &compressedSize, sizeof(int32));
+
+	now = FPlatformTime::Seconds();
+	result.CompressMs = (now - stageStart) * 1000.0;
+	result.CompressedBytes = fileData.Num();
+	stageStart = now;
+
+	//AS: Write beside the old save and swap it in, the previous save stays intact until the new one is complete
+	const FString tempPath = Path + TEXT(".tmp");
+
+	if (!FFileHelper::SaveArrayToFile(fileData, *tempPath) || !ReplaceFile(Path, tempPath))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to write save %s"), *Path);
+		return result;
+	}
+
+	result.WriteMs = (FPlatformTime::Seconds() - stageStart) * 1000.0;
+	result.bSuccess = true;
+	return result;
+}
+
+void FAshSaveSystem::BeginLoad(const FString & MapName)
+{
+	check(IsInGameThread());
+
+	LoadedSave.Reset();
+	LoadingMapName = FPackageName::GetShortName(MapName);
+	bLoadUnclaimed = true;
+
+	if (CVarAshSaveEnabled.GetValueOnGameThread() == 0)
+		return;
+
+	//AS: Our own save for this map may still be on its way to disk
+	Flush();
+
+	TotalLoads++;
+
+	const FString path = GetSavePath(LoadingMapName);
+
+	LoadInFlight = Async<FLoadResult>(EAsyncExecution::ThreadPool, [path]()
+	{
+		return ReadSave(path);
+	});
+}
+
+FAshSaveSystem::FLoadResult FAshSaveSystem::ReadSave(const FString & Path)
+{
+	FLoadResult result;
+	double stageStart = FPlatformTime::Seconds();
+
+	TArray<uint8> fileData;
+	int32 uncompressedSize = 0;
+	int32 compressedSize = 0;
+
+	const bool bHasFile = FFileHelper::LoadFileToArray(fileData, *Path, FILEREAD_Silent);
+
+	if (!bHasFile || !ReadSaveHeader(fileData, uncompressedSize, compressedSize))
+	{
+		if (bHasFile)
+			UE_LOG(LogAshForest, Warning, TEXT("Ignoring unreadable save %s"), *Path);
+
+		//AS: A complete .tmp means the last save was written but never swapped in
+		const FString tempPath = Path + TEXT(".tmp");
+		fileData.Reset();
+
+		if (!FFileHelper::LoadFileToArray(fileData, *tempPath, FILEREAD_Silent) || !ReadSaveHeader(fileData, uncompressedSize, compressedSize))
+			return result;
+
+		UE_LOG(LogAshForest, Log, TEXT("Recovered save from %s"), *tempPath);
+	}
+
+	double now = FPlatformTime::Seconds();
+	result.ReadMs = (now - stageStart) * 1000.0;
+	stageStart = now;
+
+	TArray<uint8> rawData;
+	rawData.SetNumUninitialized(uncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, rawData.GetData(), uncompressedSize, fileData.GetData() + AshSaveHeaderSize, compressedSize))
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to decompress save %s"), *Path);
+		return result;
+	}
+
+	now = FPlatformTime::Seconds();
+	result.DecompressMs = (now - stageStart) * 1000.0;
+	stageStart = now;
+
+	TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> data = MakeShareable(new FAshSaveData());
+	FMemoryReader reader(rawData, true);
+	reader << *data;
+
+	if (reader.IsError())
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Failed to read save %s"), *Path);
+		return result;
+	}
+
+	result.DeserializeMs = (FPlatformTime::Seconds() - stageStart) * 1000.0;
+	result.Data = data;
+	return result;
+}
+
+void FAshSaveSystem::Update(UWorld* World)
+{
+	if (!World || World->GetNetMode() == NM_Client)
+		return;
+
+	if (SaveInFlight.IsValid() && SaveInFlight.IsReady())
+	{
+		RecordSaveResult(SaveInFlight.Get());
+		SaveInFlight = TFuture<FSaveResult>();
+
+		if (PendingSave.IsValid())
+		{
+			StartSave(PendingSave);
+			PendingSave.Reset();
+		}
+	}
+
+	if (CVarAshSaveEnabled.GetValueOnGameThread() == 0)
+		return;
+
+	//AS: First tick of a new world. PIE worlds never go through PreLoadMap, so they start their own load here
+	if (LoadWorld.Get() != World)
+	{
+		const FString mapName = GetMapName(World);
+
+		if (!bLoadUnclaimed || LoadingMapName != mapName)
+			BeginLoad(mapName);
+
+		LoadWorld = World;
+		bLoadUnclaimed = false;
+		ApplyWaitStartTime = FPlatformTime::Seconds();
+	}
+
+	if (LoadInFlight.IsValid() && LoadInFlight.IsReady())
+	{
+		LastLoad = LoadInFlight.Get();
+		LoadInFlight = TFuture<FLoadResult>();
+
+		LoadedSave = LastLoad.Data;
+		LastLoad.Data.Reset();
+
+		SET_FLOAT_STAT(STAT_AshLoadReadMs, LastLoad.ReadMs);
+		SET_FLOAT_STAT(STAT_AshLoadDecompressMs, LastLoad.DecompressMs);
+		SET_FLOAT_STAT(STAT_AshLoadDeserializeMs, LastLoad.DeserializeMs);
+	}
+
+	if (!LoadedSave.IsValid())
+		return;
+
+	if (LoadedSave->MapName != GetMapName(World))
+	{
+		LoadedSave.Reset();
+		return;
+	}
+
+	if (ApplyLoad(World, *LoadedSave))
+	{
+		LoadedSave.Reset();
+	}
+	else if (FPlatformTime::Seconds() - ApplyWaitStartTime > AshSaveApplyTimeout)
+	{
+		UE_LOG(LogAshForest, Warning, TEXT("Dropping save for %s, checkpoint %s never loaded"), *LoadedSave->MapName, *LoadedSave->CheckpointKey);
+		LoadedSave.Reset();
+	}
+}
+
+bool FAshSaveSystem::ApplyLoad(UWorld* World, FAshSaveData & Data)
+{
+	auto gameMode = World->GetAuthGameMode<AAshForestGameMode>();
+	auto player = Cast<AAshForestCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+
+	if (!gameMode || !player)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_AshSaveApply);
+	const double startTime = FPlatformTime::Seconds();
+
+	AActor* checkpoint = NULL;
+
+	for (TActorIterator<AAshForestCheckpoint> it(World); it; ++it)
+	{
+		if (FAshForestLevelSnapshot::GetActorKey(*it) == Data.CheckpointKey)
+		{
+			checkpoint = *it;
+			break;
+		}
+	}
+
+	if (!checkpoint)
+		return false;
+
+	const int32 savedRecords = Data.ActorKeys.Num();
+	const int32 resolvedRecords = Data.Snapshot.ResolveActors(World, Data.ActorKeys);
+
+	//AS: The loaded snapshot becomes the retry state, then respawning at the checkpoint puts the level back to it
+	gameMode->GetCheckpointSnapshot() = MoveTemp(Data.Snapshot);
+	player->RestoreSavedProgress(checkpoint, Data.CheckpointIndex, Data.SmolMoniez, Data.BigUnitMoniez);
+
+	LastApplyMs = (FPlatformTime::Seconds() - startTime) * 1000.0;
+	SET_FLOAT_STAT(STAT_AshLoadApplyMs, LastApplyMs);
+
+	UE_LOG(LogAshForest, Log, TEXT("Loaded save for %s: checkpoint %d, %d/%d actors matched, applied in %.3fms"), *Data.MapName, Data.CheckpointIndex, resolvedRecords, savedRecords, LastApplyMs);
+	return true;
+}
+
+void FAshSaveSystem::Flush()
+{
+	check(IsInGameThread());
+
+	if (SaveInFlight.IsValid())
+	{
+		RecordSaveResult(SaveInFlight.Get());
+		SaveInFlight = TFuture<FSaveResult>();
+	}
+
+	//AS: The newest progress is the one queued behind it. Written right here, this also runs from ShutdownModule where workers may be gone
+	if (PendingSave.IsValid())
+	{
+		TotalSaves++;
+		RecordSaveResult(WriteSave(*PendingSave, GetSavePath(PendingSave->MapName)));
+		PendingSave.Reset();
+	}
+}
+
+int32 FAshSaveSystem::VerifySaveRoundTrip(UWorld* World)
+{
+	const FString path = FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("Ash_SaveCheck.ashsave");
+	bool bWentThroughFile = false;
+
+	const int32 failedCount = FAshForestLevelSnapshot::VerifyRoundTrip(World, [World, &path, &bWentThroughFile](FAshForestLevelSnapshot& Snapshot)
+	{
+		FAshSaveData data;
+		data.MapName = GetMapName(World);
+		data.Snapshot = Snapshot;
+		Snapshot.GetActorKeys(data.ActorKeys);
+
+		//AS: Whatever happens the original snapshot mustn't be read back, that would hide a broken save
+		Snapshot.Reset();
+
+		//AS: The worker side of a real save and load, run inline
+		const bool bWritten = WriteSave(data, path).bSuccess;
+		FLoadResult loaded = bWritten ? ReadSave(path) : FLoadResult();
+		IFileManager::Get().Delete(*path, false, false, true);
+
+		if (!loaded.Data.IsValid())
+			return;
+
+		loaded.Data->Snapshot.ResolveActors(World, loaded.Data->ActorKeys);
+		Snapshot = MoveTemp(loaded.Data->Snapshot);
+		bWentThroughFile = true;
+	});
+
+	if (!bWentThroughFile)
+		UE_LOG(LogAshForest, Warning, TEXT("Save round trip: couldn't write or read back %s"), *path);
+
+	return failedCount;
+}
+
+void FAshSaveSystem::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Saves: %llu started, %llu coalesced, %llu failed, %s in flight, %s pending"), TotalSaves, TotalCoalesced, TotalFailed,
+		SaveInFlight.IsValid() ? TEXT("one") : TEXT("none"), PendingSave.IsValid() ? TEXT("one") : TEXT("none"));
+	UE_LOG(LogAshForest, Log, TEXT("  last save: %d -> %d bytes, snapshot %.3fms, serialize %.3fms, compress %.3fms, write %.3fms"), LastSave.UncompressedBytes, LastSave.CompressedBytes,
+		LastSnapshotMs, LastSave.SerializeMs, LastSave.CompressMs, LastSave.WriteMs);
+	UE_LOG(LogAshForest, Log, TEXT("Loads: %llu started (%s), last: read %.3fms, decompress %.3fms, deserialize %.3fms, apply %.3fms"), TotalLoads, *LoadingMapName,
+		LastLoad.ReadMs, LastLoad.DecompressMs, LastLoad.DeserializeMs, LastApplyMs);
+}
+
+void FAshSaveSystem::ResetStats()
+{
+	TotalSaves = 0;
+	TotalCoalesced = 0;
+	TotalFailed = 0;
+	TotalLoads = 0;
+	LastSnapshotMs = 0.0;
+	LastApplyMs = 0.0;
+	LastSave = FSaveResult();
+	LastLoad = FLoadResult();
+}
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestScatter.h"
+#include "AshForest.h"
+#include "Async/Async.h"
+#include "Components/BoxComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/CollisionProfile.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Scatter Tick"), STAT_AshScatterTick, STATGROUP_AshForest);
+DECLARE_CYCLE_STAT(TEXT("Scatter Build Cell"), STAT_AshScatterBuildCell, STATGROUP_AshForest);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scatter Instances"), STAT_AshScatterInstances, STATGROUP_AshForest);
+
+static FAutoConsoleCommandWithWorld AshForestScatterStatsCmd(
+	TEXT("AshForest.ScatterStats"),
+	TEXT("Prints cells, instances and worst cell generation time of every scatter actor"),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		for (TActorIterator<AAshForestScatter> it(World); it; ++it)
+			it->LogScatterStats();
+	}));
+
+AAshForestScatter::AAshForestScatter()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.TickInterval = .1f;
+
+	ScatterBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("ScatterBounds"));
+	if (ScatterBounds)
+	{
+		RootComponent = ScatterBounds;
+		ScatterBounds->InitBoxExtent(FVector(10000.f, 10000.f, 2000.f));
+		ScatterBounds->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		ScatterBounds->SetGenerateOverlapEvents(false);
+	}
+
+	Seed = 1337;
+	CellSize = 4000.f;
+	StreamInRadius = 12000.f;
+	StreamOutRadius = 15000.f;
+	MaxTracesPerFrame = 256;
+	GroundChannel = ECC_WorldStatic;
+
+	TotalInstances = 0;
+	NumReadyCells = 0;
+	WorstCellMs = 0.0;
+}
+
+void AAshForestScatter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ScatterBox = ScatterBounds->Bounds.GetBox();
+	ComponentPool.SetNum(Layers.Num());
+}
+
+void AAshForestScatter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//AS: Generation only reads its own copies, but the futures must not outlive us
+	for (auto& pair : Cells)
+	{
+		if (pair.Value->Generation.IsValid())
+			pair.Value->Generation.Wait();
+	}
+
+	Cells.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FBox2D AAshForestScatter::GetCellBox(const FIntPoint & Coord) const
+{
+	const FVector2D min(Coord.X * CellSize, Coord.Y * CellSize);
+	return FBox2D(min, min + FVector2D(CellSize, CellSize));
+}
+
+void AAshForestScatter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_AshScatterTick);
+
+	UpdateStreaming();
+
+	int32 traceBudget = MaxTracesPerFrame;
+
+	for (auto& pair : Cells)
+	{
+		if (pair.Value->State != EAshScatterCellState::EAshCell_READY)
+			TickCell(*pair.Value, traceBudget);
+	}
+}
+
+void AAshForestScatter::UpdateStreaming()
+{
+	//AS: Every player the world has a controller for, that's all of them on the server (their collision matters there) and the local ones on a client
+	ViewerLocations.Reset();
+
+	for (auto it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		auto controller = it->Get();
+		if (controller && controller->GetPawn())
+			ViewerLocations.Add(FVector2D(controller->GetPawn()->GetActorLocation()));
+	}
+
+	if (ViewerLocations.Num() <= 0)
+		return;
+
+	for (auto it = Cells.CreateIterator(); it; ++it)
+	{
+		const FBox2D cellBox = GetCellBox(it.Key());
+		bool bKeep = false;
+
+		for (const auto& viewer2D : ViewerLocations)
+		{
+			if (cellBox.ComputeSquaredDistanceToPoint(viewer2D) <= FMath::Square(StreamOutRadius))
+			{
+				bKeep = true;
+				break;
+			}
+		}
+
+		if (!bKeep)
+		{
+			ReleaseCell(*it.Value());
+			it.RemoveCurrent();
+		}
+	}
+
+	for (const auto& viewer2D : ViewerLocations)
+	{
+		const FIntPoint minCoord(FMath::FloorToInt(FMath::Max(viewer2D.X - StreamInRadius, ScatterBox.Min.X) / CellSize), FMath::FloorToInt(FMath::Max(viewer2D.Y - StreamInRadius, ScatterBox.Min.Y) / CellSize));
+		const FIntPoint maxCoord(FMath::FloorToInt(FMath::Min(viewer2D.X + StreamInRadius, ScatterBox.Max.X) / CellSize), FMath::FloorToInt(FMath::Min(viewer2D.Y + StreamInRadius, ScatterBox.Max.Y) / CellSize));
+
+		for (int32 x = minCoord.X; x <= maxCoord.X; x++)
+		{
+			for (int32 y = minCoord.Y; y <= maxCoord.Y; y++)
+			{
+				const FIntPoint coord(x, y);
+
+				if (!Cells.Contains(coord) && GetCellBox(coord).ComputeSquaredDistanceToPoint(viewer2D) <= FMath::Square(StreamInRadius))
+					StartCell(coord);
+			}
+		}
+	}
+}
+
+TArray<FAshScatterPoint> AAshForestScatter::GeneratePoints(const FBox2D CellBox, const FIntPoint Coord, const int32 InSeed, const TArray<FAshScatterLayer> & InLayers)
+{
+	TArray<FAshScatterPoint> points;
+	const float cellArea = CellBox.GetArea();
+
+	for (int32 layerIndex = 0; layerIndex < InLayers.Num(); layerIndex++)
+	{
+		const auto& layer = InLayers[layerIndex];
+
+		//AS: Seeded per cell and layer, so a cell comes back identical every time it streams in
+		FRandomStream random(HashCombine(HashCombine(GetTypeHash(InSeed), GetTypeHash(Coord)), GetTypeHash(layerIndex)));
+
+		const int32 count = FMath::Min(FMath::RoundToInt(layer.Density * cellArea / (1000.f * 1000.f)), layer.MaxInstancesPerCell);
+
+		for (int32 i = 0; i < count; i++)
+		{
+			FAshScatterPoint point;
+			point.Location = FVector2D(random.FRandRange(CellBox.Min.X, CellBox.Max.X), random.FRandRange(CellBox.Min.Y, CellBox.Max.Y));
+			point.Yaw = random.FRandRange(0.f, 360.f);
+			point.Scale = random.FRandRange(layer.MinScale, layer.MaxScale);
+			point.LayerIndex = layerIndex;
+			point.GroundLocation = FVector::ZeroVector;
+			point.GroundNormal = FVector::UpVector;
+			point.bOnGround = false;
+			points.Add(point);
+		}
+	}
+
+	return points;
+}
+
+void AAshForestScatter::StartCell(const FIntPoint & Coord)
+{
+	TSharedPtr<FCell> cell = MakeShareable(new FCell());
+	cell->Coord = Coord;
+	cell->GroundTraceDelegate.BindUObject(this, &AAshForestScatter::OnGroundTraceDone, Coord);
+	cell->State = EAshScatterCellState::EAshCell_GENERATING;
+	cell->NextTraceIndex = 0;
+	cell->NumTracesDone = 0;
+	cell->GenerateStartTime = FPlatformTime::Seconds();
+
+	const FBox2D cellBox = GetCellBox(Coord);
+	const int32 seed = Seed;
+	const TArray<FAshScatterLayer> layers = Layers;
+
+	cell->Generation = Async<TArray<FAshScatterPoint>>(EAsyncExecution::ThreadPool, [cellBox, Coord, seed, layers]()
+	{
+		return GeneratePoints(cellBox, Coord, seed, layers);
+	});
+
+	Cells.Add(Coord, cell);
+}
+
+void AAshForestScatter::TickCell(FCell & Cell, int32 & TraceBudget)
+{
+	if (Cell.State == EAshScatterCellState::EAshCell_GENERATING)
+	{
+		if (!Cell.Generation.IsReady())
+			return;
+
+		Cell.Points = Cell.Generation.Get();
+		Cell.Generation = TFuture<TArray<FAshScatterPoint>>();
+
+		//AS: Points outside the bounds box (cells on its edge), and on a dedicated server points nothing can collide with, are dropped before they cost a trace
+		const bool bCollisionOnly = GetNetMode() == NM_DedicatedServer;
+
+		Cell.Points.RemoveAllSwap([this, bCollisionOnly](const FAshScatterPoint& point)
+		{
+			if (bCollisionOnly && !Layers[point.LayerIndex].bCollision)
+				return true;
+
+			return point.Location.X < ScatterBox.Min.X || point.Location.X > ScatterBox.Max.X || point.Location.Y < ScatterBox.Min.Y || point.Location.Y > ScatterBox.Max.Y;
+		});
+
+		Cell.State = EAshScatterCellState::EAshCell_TRACING;
+	}
+
+	if (Cell.State != EAshScatterCellState::EAshCell_TRACING)
+		return;
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(AshScatterGround), false, this);
+
+	//AS: Issue what the frame's budget allows, results are picked up on later ticks
+	while (Cell.NextTraceIndex < Cell.Points.Num() && TraceBudget > 0)
+	{
+		const auto& point = Cell.Points[Cell.NextTraceIndex];
+		const FVector start(point.Location, ScatterBox.Max.Z);
+		const FVector end(point.Location, ScatterBox.Min.Z);
+
+		//AS: The point index rides along as user data, the cell's coord is bound into its delegate
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, start, end, GroundChannel, queryParams, FCollisionResponseParams::DefaultResponseParam, &Cell.GroundTraceDelegate, (uint32)Cell.NextTraceIndex);
+		Cell.NextTraceIndex++;
+		TraceBudget--;
+	}
+
+	if (Cell.NumTracesDone >= Cell.Points.Num())
+		BuildCell(Cell);
+}
+
+void AAshForestScatter::OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Data, FIntPoint Coord)
+{
+	//AS: The cell may have streamed out while the trace was in flight
+	auto cell = Cells.Find(Coord);
+	if (!cell || (*cell)->State != EAshScatterCellState::EAshCell_TRACING || !(*cell)->Points.IsValidIndex((int32)Data.UserData))
+		return;
+
+	auto& point = (*cell)->Points[(int32)Data.UserData];
+
+	if (Data.OutHits.Num() > 0 && Data.OutHits[0].bBlockingHit)
+	{
+		point.GroundLocation = Data.OutHits[0].ImpactPoint;
+		point.GroundNormal = Data.OutHits[0].ImpactNormal;
+		point.bOnGround = true;
+	}
+
+	(*cell)->NumTracesDone++;
+}
+
+UHierarchicalInstancedStaticMeshComponent* AAshForestScatter::GetComponent(const int32 LayerIndex)
+{
+	auto& pool = ComponentPool[LayerIndex];
+	if (pool.Num() > 0)
+		return pool.Pop(false);
+
+	const auto& layer = Layers[LayerIndex];
+
+	auto hism = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	hism->SetStaticMesh(layer.Mesh);
+	//AS: Only ever built at runtime, so there's no built lighting for Static to use
+	hism->SetMobility(EComponentMobility::Movable);
+	hism->SetCollisionEnabled(layer.bCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+	hism->SetGenerateOverlapEvents(false);
+	hism->SetCullDistances(layer.CullStartDistance, layer.CullEndDistance);
+	hism->SetupAttachment(GetRootComponent());
+	hism->SetAbsolute(true, true, true);
+	hism->RegisterComponent();
+
+	AllComponents.Add(hism);
+	return hism;
+}
+
+void AAshForestScatter::BuildCell(FCell & Cell)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AshScatterBuildCell);
+
+	TArray<TArray<FTransform>> layerTransforms;
+	layerTransforms.SetNum(Layers.Num());
+
+	for (const auto& point : Cell.Points)
+	{
+		const auto& layer = Layers[point.LayerIndex];
+
+		if (!point.bOnGround || point.GroundNormal.Z < FMath::Cos(FMath::DegreesToRadians(layer.MaxSlopeDegrees)))
+			continue;
+
+		FQuat rotation = FRotator(0.f, point.Yaw, 0.f).Quaternion();
+		if (layer.bAlignToGround)
+			rotation = FQuat::FindBetweenNormals(FVector::UpVector, point.GroundNormal) * rotation;
+
+		layerTransforms[point.LayerIndex].Add(FTransform(rotation, point.GroundLocation, FVector(point.Scale)));
+	}
+
+	for (int32 layerIndex = 0; layerIndex < Layers.Num(); layerIndex++)
+	{
+		if (layerTransforms[layerIndex].Num() <= 0 || !Layers[layerIndex].Mesh)
+			continue;
+
+		auto hism = GetComponent(layerIndex);
+
+		for (const auto& transform : layerTransforms[layerIndex])
+			hism->AddInstanceWorldSpace(transform);
+
+		TotalInstances += layerTransforms[layerIndex].Num();
+		INC_DWORD_STAT_BY(STAT_AshScatterInstances, layerTransforms[layerIndex].Num());
+
+		FCellComponent cellComponent;
+		cellComponent.LayerIndex = layerIndex;
+		cellComponent.Component = hism;
+		Cell.Components.Add(cellComponent);
+	}
+
+	Cell.Points.Empty();
+	Cell.State = EAshScatterCellState::EAshCell_READY;
+	NumReadyCells++;
+
+	WorstCellMs = FMath::Max(WorstCellMs, (FPlatformTime::Seconds() - Cell.GenerateStartTime) * 1000.0);
+}
+
+void AAshForestScatter::ReleaseCell(FCell & Cell)
+{
+	//AS: Still generating, the worker only touches its own copies so it's safe to just stop caring about the result
+	if (Cell.State != EAshScatterCellState::EAshCell_READY)
+		return;
+
+	//AS: Layers can share a mesh with different collision/culling, so components go back by the layer they were made for
+	for (const auto& cellComponent : Cell.Components)
+	{
+		auto hism = cellComponent.Component;
+
+		TotalInstances -= hism->GetInstanceCount();
+		DEC_DWORD_STAT_BY(STAT_AshScatterInstances, hism->GetInstanceCount());
+
+		hism->ClearInstances();
+
+		if (ComponentPool.IsValidIndex(cellComponent.LayerIndex))
+			ComponentPool[cellComponent.LayerIndex].Add(hism);
+	}
+
+	Cell.Components.Reset();
+	NumReadyCells--;
+}
+
+void AAshForestScatter::LogScatterStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("%s: %d cells (%d ready), %d instances, worst cell %.1fms from request to built"), *GetName(), Cells.Num(), NumReadyCells, TotalInstances, WorstCellMs);
+
+	for (int32 i = 0; i < ComponentPool.Num(); i++)
+		UE_LOG(LogAshForest, Log, TEXT("  layer %d (%s): %d pooled components"), i, Layers[i].Mesh ? *Layers[i].Mesh->GetName() : TEXT("no mesh"), ComponentPool[i].Num());
+}
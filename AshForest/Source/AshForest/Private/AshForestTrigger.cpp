@@ -2,10 +2,18 @@
 
 #include "AshForestTrigger.h"
 #include "ActivateableInterface.h"
+#include "AshForestInterfaceDispatch.h"
+#include "AshForestJobQueue.h"
+#include "DamageableCharacter.h"
+#include "AshForestMemory.h"
+#include "AshForestNetPolicy.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 AAshForestTrigger::AAshForestTrigger()
 {
+	ASH_LLM_SCOPE(TRIGGERS);
+
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = false;
 
@@ -20,6 +28,9 @@ AAshForestTrigger::AAshForestTrigger()
 
 	bDamagedDisablesTrigger = true;
 	TriggerType = EAshForestTriggerType::EAshTrigger_ON_DASH;
+
+	bReplicates = true;
+	FAshNetPolicy::InitStaticActor(this);
 }
 
 // Called when the game starts or when spawned
@@ -29,6 +40,8 @@ void AAshForestTrigger::BeginPlay()
 	
 	bTriggerEnabled = true;
 
+	FAshNetPolicy::ApplyLevelRelevancy(this);
+
 	if (TriggeredActivatesActors.Num() <= 0)
 		return;
 
@@ -42,10 +55,27 @@ void AAshForestTrigger::BeginPlay()
 				continue;
 
 			currActor->OnDestroyed.AddDynamic(this, &AAshForestTrigger::OnActorDestruction);
+
+			//AS: Characters that retire on death never get destroyed
+			if (auto damageable = Cast<ADamageableCharacter>(currActor))
+				damageable->OnRetired.AddDynamic(this, &AAshForestTrigger::OnActorDestruction);
 		}
 	}
 }
 
+void AAshForestTrigger::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AAshForestTrigger, bTriggerEnabled);
+}
+
+bool AAshForestTrigger::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	FAshNetPolicy::NoteConsidered(this);
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
 void AAshForestTrigger::OnActorDestruction(AActor* DestroyedActor)
 {
 	if (!DestroyedActor || TriggeredActivatesActors.Num() <= 0)
@@ -56,16 +86,20 @@ void AAshForestTrigger::OnActorDestruction(AActor* DestroyedActor)
 	if (CurrentTriggeredByActors.Num() > 0)
 		return;
 
-	for (auto currActor : TriggeredActivatesActors)
+	//AS: Usually the last kill of a fight, which is already a busy frame
+	FAshJobQueue::Get().Post(this, TEXT("TriggerFanOut"), EAshJobPriority::EAshJob_NORMAL, .1f, [this]()
 	{
-		if (currActor && currActor->GetClass()->ImplementsInterface(UActivateableInterface::StaticClass()) && IActivateableInterface::Execute_AllowsActivationState(currActor, this, true))
-			IActivateableInterface::Execute_Activate(currActor, this);
-	}
+		for (auto currActor : TriggeredActivatesActors)
+		{
+			if (currActor && FAshInterfaceDispatch::AllowsActivationState(currActor, this, true))
+				IActivateableInterface::Execute_Activate(currActor, this);
+		}
+	});
 }
 
 bool AAshForestTrigger::GetTargetableComponents_Implementation(TArray<USceneComponent*> & TargetableComps)
 {
-	TargetableComps.Empty();
+	TargetableComps.Reset();
 
 	if (TargetableComp != NULL)
 	{
@@ -98,12 +132,15 @@ void AAshForestTrigger::TakeDamage_Implementation(const AActor* DamageCauser, co
 
 	for (auto currActor : TriggeredActivatesActors)
 	{
-		if (!currActor || !currActor->GetClass()->ImplementsInterface(UActivateableInterface::StaticClass()) || !IActivateableInterface::Execute_AllowsActivationState(currActor, this, true))
+		if (!currActor || !FAshInterfaceDispatch::AllowsActivationState(currActor, this, true))
 			continue;
 
 		IActivateableInterface::Execute_Activate(currActor, this);
 	}
 
 	if (bDamagedDisablesTrigger)
+	{
+		FAshNetPolicy::Flush(this);
 		bTriggerEnabled = false;
+	}
 }
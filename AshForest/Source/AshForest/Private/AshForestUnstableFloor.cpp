@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestUnstableFloor.h"
+#include "AshForest.h"
+#include "AshForestCharacter.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Unstable Floors Update"), STAT_AshUnstableFloorsUpdate, STATGROUP_AshForest);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Unstable Floor Active Tiles"), STAT_AshUnstableFloorActiveTiles, STATGROUP_AshForest);
+
+static FAutoConsoleCommand AshForestUnstableFloorStatsCmd(
+	TEXT("AshForest.UnstableFloorStats"),
+	TEXT("Prints registered unstable floors, floors with active tiles and total collapses"),
+	FConsoleCommandDelegate::CreateStatic([]()
+	{
+		FAshUnstableFloors::Get().LogStats();
+	}));
+
+AAshForestUnstableFloor::AAshForestUnstableFloor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	TileComp = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("TileComp"));
+	if (TileComp)
+	{
+		RootComponent = TileComp;
+
+		//AS: The player's floor result says which tile is stood on, no contact needs reporting
+		TileComp->SetNotifyRigidBodyCollision(false);
+		TileComp->SetGenerateOverlapEvents(false);
+		TileComp->SetMobility(EComponentMobility::Movable);
+	}
+
+	CollapseDelay = 1.f;
+	RespawnDelay = 5.f;
+	CrumbleShakeAmount = 3.f;
+	CollapsedOffset = FVector(0.f, 0.f, -5000.f);
+
+	DebrisPoolSize = 4;
+	DebrisLifetime = 2.f;
+	NextDebrisIndex = 0;
+	NumActiveDebris = 0;
+}
+
+void AAshForestUnstableFloor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 numTiles = TileComp->GetInstanceCount();
+	Tiles.SetNum(numTiles);
+	TileRestTransforms.SetNum(numTiles);
+
+	for (int32 i = 0; i < numTiles; i++)
+		TileComp->GetInstanceTransform(i, TileRestTransforms[i], false);
+
+	if (DebrisClass)
+	{
+		FActorSpawnParameters spawnParams;
+		spawnParams.Owner = this;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		for (int32 i = 0; i < DebrisPoolSize; i++)
+		{
+			auto debris = GetWorld()->SpawnActor<AActor>(DebrisClass, GetActorLocation() + CollapsedOffset, FRotator::ZeroRotator, spawnParams);
+			if (!debris)
+				continue;
+
+			debris->SetActorHiddenInGame(true);
+			debris->SetActorEnableCollision(false);
+			DebrisPool.Add(debris);
+		}
+
+		DebrisTimeLeft.SetNumZeroed(DebrisPool.Num());
+	}
+
+	FAshUnstableFloors::Get().Register(this);
+}
+
+void AAshForestUnstableFloor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FAshUnstableFloors::Get().Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAshForestUnstableFloor::SetTileTransform(const int32 TileIndex, const FTransform & LocalTransform)
+{
+	//AS: Render state is marked dirty once per floor at the end of the update, not per tile
+	TileComp->UpdateInstanceTransform(TileIndex, LocalTransform, false, false, true);
+}
+
+void AAshForestUnstableFloor::NotifyStoodOn(const int32 TileIndex)
+{
+	if (!Tiles.IsValidIndex(TileIndex) || Tiles[TileIndex].State != EAshFloorTileState::EAshTile_STABLE)
+		return;
+
+	Tiles[TileIndex].State = EAshFloorTileState::EAshTile_CRUMBLING;
+	Tiles[TileIndex].TimeLeft = CollapseDelay;
+	ActiveTiles.Add(TileIndex);
+}
+
+void AAshForestUnstableFloor::CollapseTile(const int32 TileIndex)
+{
+	auto& tile = Tiles[TileIndex];
+	tile.State = EAshFloorTileState::EAshTile_COLLAPSED;
+	tile.TimeLeft = RespawnDelay;
+
+	auto parkedTransform = TileRestTransforms[TileIndex];
+	parkedTransform.AddToTranslation(CollapsedOffset);
+	SetTileTransform(TileIndex, parkedTransform);
+
+	SpawnDebris(TileIndex);
+
+	FAshUnstableFloors::Get().TotalCollapses++;
+	OnTileCollapsed(TileIndex, GetActorTransform().TransformPosition(TileRestTransforms[TileIndex].GetLocation()));
+}
+
+void AAshForestUnstableFloor::RestoreTile(const int32 TileIndex)
+{
+	Tiles[TileIndex].State = EAshFloorTileState::EAshTile_STABLE;
+	Tiles[TileIndex].TimeLeft = 0.f;
+
+	SetTileTransform(TileIndex, TileRestTransforms[TileIndex]);
+}
+
+void AAshForestUnstableFloor::SpawnDebris(const int32 TileIndex)
+{
+	if (DebrisPool.Num() <= 0)
+		return;
+
+	//AS: Round robin, when every piece is out the oldest one gets reused
+	const int32 debrisIndex = NextDebrisIndex;
+	NextDebrisIndex = (NextDebrisIndex + 1) % DebrisPool.Num();
+
+	auto debris = DebrisPool[debrisIndex];
+	if (!debris)
+		return;
+
+	if (DebrisTimeLeft[debrisIndex] <= 0.f)
+		NumActiveDebris++;
+
+	DebrisTimeLeft[debrisIndex] = DebrisLifetime;
+
+	const FTransform tileWorld = TileRestTransforms[TileIndex] * GetActorTransform();
+	debris->SetActorLocationAndRotation(tileWorld.GetLocation(), tileWorld.GetRotation(), false, NULL, ETeleportType::TeleportPhysics);
+	debris->SetActorHiddenInGame(false);
+	debris->SetActorEnableCollision(true);
+}
+
+bool AAshForestUnstableFloor::UpdateTiles(const float DeltaTime)
+{
+	if (ActiveTiles.Num() > 0)
+	{
+		for (int32 i = ActiveTiles.Num() - 1; i >= 0; i--)
+		{
+			const int32 tileIndex = ActiveTiles[i];
+			auto& tile = Tiles[tileIndex];
+
+			tile.TimeLeft -= DeltaTime;
+
+			if (tile.State == EAshFloorTileState::EAshTile_CRUMBLING)
+			{
+				if (tile.TimeLeft <= 0.f)
+				{
+					CollapseTile(tileIndex);
+
+					if (RespawnDelay <= 0.f)
+						ActiveTiles.RemoveAtSwap(i, 1, false);
+				}
+				else
+				{
+					auto shakenTransform = TileRestTransforms[tileIndex];
+					shakenTransform.AddToTranslation(FMath::VRand() * CrumbleShakeAmount);
+					SetTileTransform(tileIndex, shakenTransform);
+				}
+			}
+			else if (tile.State == EAshFloorTileState::EAshTile_COLLAPSED && tile.TimeLeft <= 0.f)
+			{
+				RestoreTile(tileIndex);
+				ActiveTiles.RemoveAtSwap(i, 1, false);
+			}
+		}
+
+		TileComp->MarkRenderStateDirty();
+		INC_DWORD_STAT_BY(STAT_AshUnstableFloorActiveTiles, ActiveTiles.Num());
+	}
+
+	for (int32 i = 0; i < DebrisPool.Num() && NumActiveDebris > 0; i++)
+	{
+		if (DebrisTimeLeft[i] <= 0.f)
+			continue;
+
+		DebrisTimeLeft[i] -= DeltaTime;
+
+		if (DebrisTimeLeft[i] <= 0.f)
+		{
+			NumActiveDebris--;
+
+			if (DebrisPool[i])
+			{
+				DebrisPool[i]->SetActorHiddenInGame(true);
+				DebrisPool[i]->SetActorEnableCollision(false);
+				DebrisPool[i]->SetActorLocation(GetActorLocation() + CollapsedOffset, false, NULL, ETeleportType::TeleportPhysics);
+			}
+		}
+	}
+
+	return HasActiveTiles();
+}
+
+void AAshForestUnstableFloor::ResetAllTiles()
+{
+	//AS: Tiles that collapsed for good aren't in ActiveTiles anymore, so go through all of them
+	for (int32 i = 0; i < Tiles.Num(); i++)
+	{
+		if (Tiles[i].State != EAshFloorTileState::EAshTile_STABLE)
+			RestoreTile(i);
+	}
+
+	ActiveTiles.Reset();
+	TileComp->MarkRenderStateDirty();
+}
+
+FAshUnstableFloors & FAshUnstableFloors::Get()
+{
+	static FAshUnstableFloors instance;
+	return instance;
+}
+
+FAshUnstableFloors::FAshUnstableFloors()
+	: TotalCollapses(0), NumRegistered(0)
+{
+}
+
+void FAshUnstableFloors::Register(AAshForestUnstableFloor* Floor)
+{
+	NumRegistered++;
+}
+
+void FAshUnstableFloors::Unregister(AAshForestUnstableFloor* Floor)
+{
+	NumRegistered--;
+	ActiveFloors.RemoveSwap(Floor);
+}
+
+void FAshUnstableFloors::Update(UWorld* World, const float DeltaSeconds)
+{
+	if (NumRegistered <= 0)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_AshUnstableFloorsUpdate);
+
+	//AS: The floor the CMC already found for each player, for instanced components the hit item is the instance index
+	for (auto it = World->GetPlayerControllerIterator(); it; ++it)
+	{
+		auto player = it->IsValid() ? Cast<AAshForestCharacter>((*it)->GetPawn()) : NULL;
+		if (!player)
+			continue;
+
+		const auto& floor = player->GetCharacterMovement()->CurrentFloor;
+		if (!floor.bBlockingHit || !player->GetCharacterMovement()->IsMovingOnGround())
+			continue;
+
+		auto floorComp = floor.HitResult.Component.Get();
+		auto unstableFloor = floorComp ? Cast<AAshForestUnstableFloor>(floorComp->GetOwner()) : NULL;
+
+		if (!unstableFloor || floorComp != unstableFloor->GetTileComponent())
+			continue;
+
+		unstableFloor->NotifyStoodOn(floor.HitResult.Item);
+		ActiveFloors.AddUnique(unstableFloor);
+	}
+
+	for (int32 i = ActiveFloors.Num() - 1; i >= 0; i--)
+	{
+		auto floor = ActiveFloors[i].Get();
+
+		if (floor && floor->GetWorld() != World)
+			continue;
+
+		if (!floor || !floor->UpdateTiles(DeltaSeconds))
+			ActiveFloors.RemoveAtSwap(i, 1, false);
+	}
+}
+
+void FAshUnstableFloors::LogStats() const
+{
+	UE_LOG(LogAshForest, Log, TEXT("Unstable floors: %d registered, %d with active tiles, %llu tiles collapsed"), NumRegistered, ActiveFloors.Num(), TotalCollapses);
+}
@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AshForestUserWidget.h"
+#include "Components/InvalidationBox.h"
+#include "AshForestCharacter.h"
+
+void UAshForestUserWidget::MarkContentChanged()
+{
+	if (InvalidationRoot)
+		InvalidationRoot->InvalidateCache();
+}
+
+AAshForestCharacter* UAshForestUserWidget::GetOwningAshCharacter() const
+{
+	return Cast<AAshForestCharacter>(GetOwningPlayerPawn());
+}
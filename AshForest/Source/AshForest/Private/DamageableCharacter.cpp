@@ -1,9 +1,14 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "DamageableCharacter.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 
 // Sets default values
-ADamageableCharacter::ADamageableCharacter()
+ADamageableCharacter::ADamageableCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -15,6 +20,7 @@ ADamageableCharacter::ADamageableCharacter()
 		TargetableComp->SetupAttachment(GetRootComponent());
 
 	MaxHealth = 100.f;
+	bRetireOnDeath = false;
 }
 
 // Called when the game starts or when spawned
@@ -22,7 +28,16 @@ void ADamageableCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	CurrentHealth = MaxHealth;
+	SetCurrentHealth(MaxHealth);
+}
+
+void ADamageableCharacter::SetCurrentHealth(const float NewHealth)
+{
+	if (CurrentHealth == NewHealth)
+		return;
+
+	CurrentHealth = NewHealth;
+	OnHealthChanged.Broadcast(this, CurrentHealth, MaxHealth);
 }
 
 void ADamageableCharacter::FellOutOfWorld(const class UDamageType& dmgType)
@@ -32,7 +47,7 @@ void ADamageableCharacter::FellOutOfWorld(const class UDamageType& dmgType)
 
 bool ADamageableCharacter::GetTargetableComponents_Implementation(TArray<USceneComponent*> & TargetableComps)
 {
-	TargetableComps.Empty();
+	TargetableComps.Reset();
 
 	if (TargetableComp != NULL)
 	{
@@ -45,12 +60,12 @@ bool ADamageableCharacter::GetTargetableComponents_Implementation(TArray<USceneC
 
 bool ADamageableCharacter::CanBeTargeted_Implementation(const AActor* ByActor)
 {
-	return true;
+	return !bIsRetired;
 }
 
 bool ADamageableCharacter::CanBeDamaged_Implementation(const AActor* DamageCauser, const FHitResult & DamageHitEvent)
 {
-	return true;
+	return !bIsRetired;
 }
 
 
@@ -61,10 +76,10 @@ bool ADamageableCharacter::IgnoresCollisionWithDamager_Implementation(const AAct
 
 void ADamageableCharacter::TakeDamage_Implementation(const AActor* DamageCauser, const float & DamageAmount, const FHitResult & DamageHitEvent)
 {
-	if (!DamageCauser || IsPendingKill())
+	if (!DamageCauser || IsPendingKill() || bIsRetired)
 		return;
 
-	CurrentHealth -= DamageAmount;
+	SetCurrentHealth(CurrentHealth - DamageAmount);
 
 	if (CurrentHealth <= 0.f)
 		TargetableDie(DamageCauser);
@@ -73,5 +88,53 @@ void ADamageableCharacter::TakeDamage_Implementation(const AActor* DamageCauser,
 void ADamageableCharacter::TargetableDie(const AActor* Murderer)
 {
 	ITargetableInterface::Execute_OnTargetableDeath(this, Murderer);
-	Destroy();
+
+	if (bRetireOnDeath)
+		Retire();
+	else
+		Destroy();
+}
+
+void ADamageableCharacter::Retire()
+{
+	if (bIsRetired)
+		return;
+
+	bIsRetired = true;
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+
+	if (auto aiController = Cast<AAIController>(GetController()))
+	{
+		if (aiController->BrainComponent)
+			aiController->BrainComponent->StopLogic(TEXT("Retired"));
+	}
+
+	OnRetired.Broadcast(this);
+}
+
+void ADamageableCharacter::Revive()
+{
+	if (!bIsRetired)
+		return;
+
+	bIsRetired = false;
+	SetCurrentHealth(MaxHealth);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	if (auto aiController = Cast<AAIController>(GetController()))
+	{
+		if (aiController->BrainComponent)
+			aiController->BrainComponent->RestartLogic();
+	}
 }
@@ -2,11 +2,17 @@
 
 #include "FocusPointTrigger.h"
 #include "AshForestCharacter.h"
+#include "AshForestMemory.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
 
 AFocusPointTrigger::AFocusPointTrigger()
 {
-	OnActorBeginOverlap.AddDynamic(this, &AFocusPointTrigger::OnOverlapBegin);
-	OnActorEndOverlap.AddDynamic(this, &AFocusPointTrigger::OnOverlapEnd);
+	ASH_LLM_SCOPE(TRIGGERS);
+
+	//AS: Only the player matters, FAshPlayerVolumes tests their capsule against us instead of every pawn and projectile overlapping us
+	GetCollisionComponent()->SetGenerateOverlapEvents(false);
+	GetCollisionComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 
 	FocusPointActor = nullptr;
 
@@ -19,14 +25,27 @@ AFocusPointTrigger::AFocusPointTrigger()
 	FocusTargetFOV_InterpSpeed = -1.f;
 }
 
-void AFocusPointTrigger::OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor)
+void AFocusPointTrigger::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FAshPlayerVolumes::Get().Register(this, Cast<UBoxComponent>(GetCollisionComponent()), this);
+}
+
+void AFocusPointTrigger::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FAshPlayerVolumes::Get().Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AFocusPointTrigger::OnPlayerEnterVolume(AAshForestCharacter* Player)
 {
-	if (OtherActor && OtherActor != this && OtherActor->IsA(AAshForestCharacter::StaticClass()))
-		((AAshForestCharacter*)OtherActor)->SetFocusPointTrigger(this);
+	Player->SetFocusPointTrigger(this);
 }
 
-void AFocusPointTrigger::OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor)
+void AFocusPointTrigger::OnPlayerExitVolume(AAshForestCharacter* Player)
 {
-	if (bOnlyAllowFocusingWithinTrigger && OtherActor && OtherActor != this && OtherActor->IsA(AAshForestCharacter::StaticClass()))
-		((AAshForestCharacter*)OtherActor)->SetFocusPointTrigger(nullptr);
+	if (bOnlyAllowFocusingWithinTrigger)
+		Player->SetFocusPointTrigger(nullptr);
 }
\ No newline at end of file
@@ -14,6 +14,10 @@ class ASHFOREST_API AAshForestActivateableActor : public AActor, public IActivat
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 		USceneComponent* RootComp;
+
+	/** The mover component added in Blueprint, if any. Opens on Activate and closes on Deactivate, replacing the Blueprint's own Timeline */
+	UPROPERTY(Transient, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"), Category = "Activation")
+		class UAshForestMoverComponent* Mover;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -23,7 +27,30 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	/** Kept by the native Activate/Deactivate, Blueprint overrides should call the parent so checkpoint snapshots see the change */
+	UPROPERTY(BlueprintReadOnly, SaveGame, ReplicatedUsing = OnRep_IsActivated, Category = "Activation")
+		bool bIsActivated;
+
+	UFUNCTION()
+		void OnRep_IsActivated();
+
 public:	
+	/** Called after a checkpoint restore changed bIsActivated, so doors etc. can snap to their state without playing transitions */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Activation")
+		void OnActivationStateRestored(const bool bActivated);
+
+	/** Clients: the server changed bIsActivated. Snaps through OnActivationStateRestored unless overridden to play the transition */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Activation")
+		void OnActivationStateReplicated(const bool bActivated);
+
+	UFUNCTION(BlueprintPure, Category = "Activation") FORCEINLINE
+		bool IsActivated() const { return bIsActivated; };
+
+	FORCEINLINE class UAshForestMoverComponent* GetMover() const { return Mover; }
+
 		bool AllowsActivationState_Implementation(const AActor* ByActivator, const bool NewActivationState);
 		void Activate_Implementation(const AActor* Activator);
 		void Deactivate_Implementation(const AActor* Deactivator);
@@ -4,8 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "DamageableCharacter.h"
+#include "AshForestLockOnKernel.h"
+#include "AshForestLockOnVisibility.h"
+#include "AshForestLockOnRing.h"
+#include "AshForestCharacterMovement.h"
+#include "AshForestRewindHistory.h"
 #include "AshForestCharacter.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDashChargesChangedSignature, int32, CurrentCharges, int32, MaxCharges);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLockOnTargetChangedSignature, USceneComponent*, NewTarget, USceneComponent*, PreviousTarget);
+
 UENUM(BlueprintType)
 namespace EAshCustomMoveState
 {
@@ -18,6 +26,27 @@ namespace EAshCustomMoveState
 	};
 }
 
+namespace EAshInputAction
+{
+	enum Type
+	{
+		EAshInput_DASH,
+		EAshInput_LOCK_ON,
+		EAshInput_SWITCH_TARGET,
+		EAshInput_MAX
+	};
+}
+
+/** A press waiting to be acted on, with the stick direction as it was when the button went down */
+struct FAshBufferedAction
+{
+	EAshInputAction::Type Action;
+	double PressTime;
+	uint64 PressFrame;
+	FVector MoveInputDir;
+	int32 Dir;
+};
+
 USTRUCT(Blueprintable)
 struct FInitialCharMovementVars
 {
@@ -38,6 +67,9 @@ class AAshForestCharacter : public ADamageableCharacter
 {
 	GENERATED_BODY()
 
+	//AS: Starts server side dashes for the owning client's predicted ones
+	friend class UAshForestCharacterMovement;
+
 	/** Camera boom positioning the camera behind the character */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class USpringArmComponent* CameraBoom;
@@ -49,7 +81,7 @@ class AAshForestCharacter : public ADamageableCharacter
 	FInitialCharMovementVars MyInitialMovementVars;
 
 public:
-	AAshForestCharacter();
+	AAshForestCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
@@ -60,6 +92,7 @@ public:
 	float BaseLookUpRate;
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 	
 	virtual void Jump() override;
@@ -68,6 +101,12 @@ public:
 
 	virtual void TargetableDie(const AActor* Murderer) override;
 
+	virtual void PawnClientRestart() override;
+
+	virtual void UnPossessed() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	void MoveForward(float Value);
@@ -84,9 +123,15 @@ protected:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// End of APawn interface
 
+	/** Forces every ash.Debug.* visualization category on while set and this character is in play (ignored in Shipping) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
 		bool bDebugAshMovement;
 
+	/** Whether this character currently holds a force-all request on the debug draw */
+	bool bForcingDebugDraw;
+
+	void UpdateDebugDrawOverride();
+
 	UPROPERTY(BlueprintReadOnly, Transient, Category = "Ash Movement")
 		TEnumAsByte<EAshCustomMoveState::Type> AshMoveState_Current;
 
@@ -99,6 +144,51 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Ash Movement")
 		void OnAshCustomMoveStateChanged();
 
+	/** Move state for simulated proxies, two bits worth of EAshCustomMoveState */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_ReplicatedMoveState)
+		uint8 ReplicatedMoveState;
+
+	/** Server's dash charges (low nibble) and dashes while falling (high nibble) for the owning client to reconcile against */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_ReplicatedDashState)
+		uint8 ReplicatedDashState;
+
+	UFUNCTION()
+		void OnRep_ReplicatedMoveState();
+
+	UFUNCTION()
+		void OnRep_ReplicatedDashState();
+
+	void UpdateReplicatedMoveState();
+
+//AS: =========================================================================
+//AS: Input ==================================================================
+
+	/** Presses that can't be acted on yet (dash cooldown, switch interval) keep being retried for this long */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input")
+		float InputBufferWindow;
+
+	TArray<FAshBufferedAction, TInlineAllocator<4>> BufferedActions;
+
+	/** Press handlers run during the controller's input processing, before this pawn and its movement tick, so actions are tried right away */
+	void BufferAction(const EAshInputAction::Type Action, const int32 Dir = 0);
+	void ProcessBufferedActions();
+
+	/** The local controller we tick after, so its input lands in our Tick and movement the same frame. NULL when not locally controlled */
+	TWeakObjectPtr<AController> InputTickController;
+	void SetInputTickController(AController* NewController);
+
+	/** This frame's MoveForward/MoveRight axes in world space. GetLastMovementInputVector is still last frame's during action callbacks */
+	FVector SampleMoveInputDirection() const;
+
+	/** ash.InputLatency: press time/frame of the dash being measured, reported once the movement component changes velocity */
+	double LatencyPressTime;
+	uint64 LatencyPressFrame;
+	FVector LatencyPressVelocity;
+	bool bMeasuringInputLatency;
+
+	UFUNCTION()
+		void OnMovementUpdated_MeasureLatency(float DeltaSeconds, FVector OldLocation, FVector OldVelocity);
+
 //AS: =========================================================================
 //AS: Dashing ================================================================
 
@@ -178,10 +268,11 @@ protected:
 		void OnDashPressed();
 
 	UFUNCTION(BlueprintCallable, Category = "Dash")
-		void OnDashReleased();
+		void TryDash();
 
+	/** Dashes along Dir (the look direction if zero) if a dash can start now */
 	UFUNCTION(BlueprintCallable, Category = "Dash")
-		void TryDash();
+		bool TryDashInDirection(FVector Dir);
 
 	UFUNCTION(BlueprintCallable, Category = "Dash")
 		bool CanDash(const bool bIsForStart = false) const;
@@ -324,6 +415,24 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lock On")
 		float AllowSwitchLockOnTargetInterval;
 
+	/** Line of sight results for lock-on candidates are reused for up to this long */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lock On")
+		float LockOnVisibility_MaxAge;
+
+	/** ...or until the candidate or the view point has moved further than this */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lock On")
+		float LockOnVisibility_MoveTolerance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lock On")
+		int32 LockOnVisibility_RefreshPerFrame;
+
+	/** How often the angular ordering of nearby targetables re-queries which targetables are nearby, positions update every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lock On")
+		float LockOnRing_RefreshInterval;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Lock On")
+		float LastLockOnRingRefreshTime;
+
 	UPROPERTY(BlueprintReadOnly, Transient, Category = "Lock On")
 		TWeakObjectPtr<USceneComponent> LockOnTarget_Current;
 
@@ -337,19 +446,34 @@ protected:
 		bool bCanSwitchLockOnTarget;
 
 	UPROPERTY(BlueprintReadOnly, Transient, Category = "Lock On")
-		bool bWantsToLockOn;
+		float LastSwitchLockOnTargetTime;
 
-	UPROPERTY(BlueprintReadOnly, Transient, Category = "Lock On")
-		int32 WantsToSwitchLockOnTargetDir;
+	/** Candidate positions for the batched angle tests, kept around so lock-on queries don't reallocate */
+	FAshLockOnBatch LockOnBatch;
+	TArray<USceneComponent*> LockOnBatchTargets;
+	TArray<FVector> LockOnBatchLocations;
 
-	UPROPERTY(BlueprintReadOnly, Transient, Category = "Lock On")
-		float LastSwitchLockOnTargetTime;
+	FAshLockOnVisibilityCache LockOnVisibility;
+	FAshLockOnRing LockOnRing;
 
-	UFUNCTION(BlueprintCallable, Category = "Lock On")
-		void OnLockOnPressed();
+	/** Query state reused every frame so steady state dashing, climbing and targeting don't touch the heap */
+	FCollisionQueryParams SelfQueryParams;
+	FCollisionObjectQueryParams LockOnObjectParams;
+	TArray<FHitResult> DashHits;
+	TArray<FOverlapResult> LockOnOverlaps;
+	TArray<USceneComponent*> LockOnScratchTargets;
+	TArray<USceneComponent*> TargetableCompsScratch;
+
+	/** Single targetable component of Actor if it can currently be targeted by us, NULL otherwise */
+	USceneComponent* GetLockOnCandidateComponent(AActor* Actor);
+
+	void RefreshLockOnRing();
+
+	/** Walks the angular ordering away from From (Dir 1 is right), returns the first targetable visible candidate, optionally only inside the lock-on cone around From */
+	USceneComponent* FindLockOnRingNeighbor(USceneComponent* From, const int32 Dir, const bool bLimitToCone, float* OutKey = NULL);
 
 	UFUNCTION(BlueprintCallable, Category = "Lock On")
-		void OnLockOnReleased();
+		void OnLockOnPressed();
 
 	UFUNCTION(BlueprintCallable, Category = "Lock On")
 		void OnLockOnSwitchInput(float Dir);
@@ -378,6 +502,10 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Lock On")
 		void SwitchLockOnTarget_Right();
 
+	/** Next target clockwise around the player, wrapping around, regardless of the lock-on cone */
+	UFUNCTION(BlueprintCallable, Category = "Lock On")
+		void CycleLockOnTarget();
+
 	UFUNCTION(BlueprintNativeEvent, Category = "Lock On")
 		void OnLockOnTargetUpdated();
 
@@ -508,7 +636,41 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 		void DeflectProjectile(AActor* HitProjectile);
 
+	/** How far back (seconds) the server rewinds a projectile to validate a deflection the owning client predicted */
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+		float MaxDeflectRewindTime;
+
+	/** Slack on top of the two collision radii when checking a rewound deflection, covers sampling and interpolation error */
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+		float DeflectRewindTolerance;
+
+	/** Owning client: it deflected its simulated copy of ProjectileId at ClientServerTime (its estimate of the server's clock) */
+	UFUNCTION(Server, Reliable, WithValidation)
+		void ServerDeflectProjectile(uint16 ProjectileId, float ClientServerTime);
+
+	UFUNCTION(NetMulticast, Reliable)
+		void MulticastProjectileDeflected(const FAshProjectileDeflectEvent & DeflectEvent);
+
 protected:
+	struct FRewindSample
+	{
+		FVector Location;
+
+		/** End of the dash sweep (Location when not dashing), the sweep is what deflects projectiles ahead of us */
+		FVector SweepEnd;
+
+		friend FRewindSample AshLerpRewindSample(const FRewindSample & A, const FRewindSample & B, const float Alpha)
+		{
+			return { FMath::Lerp(A.Location, B.Location, Alpha), FMath::Lerp(A.SweepEnd, B.SweepEnd, Alpha) };
+		}
+	};
+
+	/** Server side, recent positions and dash sweeps used to rewind us to the time a client saw a deflection */
+	TAshRewindHistory<FRewindSample> RewindHistory;
+
+	void RecordRewindSample();
+	void GetRewoundDashSweep(const float ServerTime, FVector & OutStart, FVector & OutEnd) const;
+
 //AS: =========================================================================
 //AS: Respawning ==============================================================
 
@@ -531,15 +693,43 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Respawning")
 		void OnTouchCheckpoint(AActor* Checkpoint);
 
+	UFUNCTION(BlueprintPure, Category = "Respawning") FORCEINLINE
+		int32 GetLatestCheckpointIndex() const { return LatestCheckpointIndex; };
+
+	FORCEINLINE AActor* GetLatestCheckpoint() const { return LatestCheckpoint; }
+
+	/** Loaded progress: respawns at Checkpoint with the saved money, without counting it as a newly reached checkpoint */
+	void RestoreSavedProgress(AActor* Checkpoint, const int32 CheckpointIndex, const int32 SmolMoniez, const int32 BigUnitMoniez);
+
 //AS: =========================================================================
 //AS: Cash Moniez ==============================================================
 
-	UPROPERTY(BlueprintReadWrite, Transient, Category = "Rewards")
+	/** Collecting is server only, so the counters replicate to the owning client */
+	UPROPERTY(BlueprintReadWrite, Transient, SaveGame, Replicated, Category = "Rewards")
 		int32 CurrentSmolMoniez;
 
-	UPROPERTY(BlueprintReadWrite, Transient, Category = "Rewards")
+	UPROPERTY(BlueprintReadWrite, Transient, SaveGame, Replicated, Category = "Rewards")
 		int32 CurrentBigUnitMoniez;
 
+//AS: =========================================================================
+//AS: HUD Events ==============================================================
+
+	/** Fired after a dash spends a charge, a charge reloads, or charges are reset */
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+		FOnDashChargesChangedSignature OnDashChargesChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+		FOnLockOnTargetChangedSignature OnLockOnTargetChanged;
+
+	UFUNCTION(BlueprintPure, Category = "Dash") FORCEINLINE
+		int32 GetDashCharges() const { return DashCharges_Current; };
+
+	UFUNCTION(BlueprintPure, Category = "Dash") FORCEINLINE
+		int32 GetMaxDashCharges() const { return DashCharges_MAX; };
+
+	UFUNCTION(BlueprintPure, Category = "Lock On") FORCEINLINE
+		USceneComponent* GetLockOnTarget() const { return LockOnTarget_Current.Get(); };
+
 //AS: =========================================================================
 //AS: =========================================================================
 
@@ -552,9 +742,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Ash Movement") FORCEINLINE
 		TEnumAsByte<EAshCustomMoveState::Type> GetCurrentAshMoveState() const { return AshMoveState_Current; };
 
+	UFUNCTION(BlueprintPure, Category = "Ash Movement") FORCEINLINE
+		bool IsWallRunning() const { return bIsWallRunning; };
+
+	FORCEINLINE float GetLastDashStartTime() const { return LastDashStartTime; }
+
+	/** The movement component is always a UAshForestCharacterMovement, set up in the constructor */
+	FORCEINLINE UAshForestCharacterMovement* GetAshMovement() const { return (UAshForestCharacterMovement*)GetCharacterMovement(); }
+
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 		void OnKilledEnemy(AActor* KilledEnemy);
 
+	/** Lock-on reselection for kills deferred by OnKilledEnemy while the damage queue was resolving */
+	void ResolveKilledEnemies();
+
+private:
+	TWeakObjectPtr<USceneComponent> PendingKilledTarget;
+	bool bHasPendingKilledTarget;
+
 	
 };
 
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "AshForestCharacterMovement.generated.h"
+
+class AAshForestCharacter;
+
+/**
+ * Predicts the custom move state (dash/climb) with the regular saved move pipeline.
+ * A dash start rides on FLAG_Custom_0 and its direction on the move's (already quantized) acceleration, the current move state
+ * takes two more flag bits, so a dashing or climbing move costs no extra bandwidth over a normal one.
+ * While in a custom state the velocity set by the character is re-applied before every (re)played move instead of being forced
+ * from outside, so server corrections replay cleanly. The same goes for everything else the character changes about movement:
+ * dash gravity/speed and the wall jump air lock are worked out from saved state, the dash times out per move, and one-shot
+ * velocity/location changes (dash exit, wall jumps, ledge pull-ups) are queued here and made at the start of the next move.
+ * Test with several PIE clients plus "Net PktLag=100" / "Net PktLoss=5" and watch "stat net" and AshForest.NetMoveStats.
+ */
+UCLASS()
+class ASHFOREST_API UAshForestCharacterMovement : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAshForestCharacterMovement();
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void UpdateCharacterStateAfterMovement(float DeltaSeconds) override;
+	virtual void CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration) override;
+	virtual FVector ConstrainInputAcceleration(const FVector& InputAcceleration) const override;
+	virtual void OnClientCorrectionReceived(class FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase,
+		FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+	virtual float GetGravityZ() const override;
+	virtual float GetMaxSpeed() const override;
+	virtual FVector GetAirControl(float DeltaTime, float TickAirControl, const FVector& FallAcceleration) override;
+
+	/** Mirrors the owner's EAshCustomMoveState, saved and restored per move so replays see the state the move was made in */
+	uint8 AshMoveState;
+
+	/** Velocity the owner wants while dashing/climbing */
+	FVector CustomStateVelocity;
+
+	/** Set by the owning client when it starts a dash, sent with the next move and cleared once that move is made */
+	uint8 bDashStartPending : 1;
+
+	/** Counted down per move, the dash ends on the move that uses it up on both the client and the server */
+	float DashTimeRemaining;
+
+	/** After a wall jump there's no falling friction (and no air control for a climbing jump) until this runs out or we land */
+	float AirLockTimeRemaining;
+	uint8 bAirLockNoAirControl : 1;
+
+	/** One-shot changes asked for by the owner between moves, made at the start of the next move and saved with it */
+	FVector PendingVelocity;
+	FVector PendingLocation;
+	uint8 bHasPendingVelocity : 1;
+	uint8 bHasPendingLocation : 1;
+	uint8 bSweepPendingLocation : 1;
+
+	void SetAshMoveState(const uint8 NewMoveState);
+	void SetCustomStateVelocity(const FVector & NewVelocity);
+	void StartDashTimer(const float Duration);
+	void StartAirLock(const float Duration, const bool bNoAirControl);
+	void SetPendingVelocity(const FVector & NewVelocity);
+	void SetPendingLocation(const FVector & NewLocation, const bool bSweep = false);
+
+	FORCEINLINE bool IsInCustomState() const { return AshMoveState != 0; }
+
+	/** True while a move that started a dash hasn't been acknowledged by the server, replicated dash state is stale until then */
+	bool HasUnacknowledgedDashMoves() const;
+
+	static void LogNetStats();
+
+protected:
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	AAshForestCharacter* GetAshOwner() const;
+
+	void ApplyPendingChanges();
+
+	/** Server side, the move state the client says it was in for the move being made */
+	uint8 ClientAshMoveState;
+};
+
+class ASHFOREST_API FSavedMove_AshForest : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	uint8 SavedAshMoveState;
+	uint8 bSavedDashStart : 1;
+	FVector SavedCustomStateVelocity;
+	float SavedDashTimeRemaining;
+	float SavedAirLockTimeRemaining;
+	uint8 bSavedAirLockNoAirControl : 1;
+	FVector SavedPendingVelocity;
+	FVector SavedPendingLocation;
+	uint8 bSavedHasPendingVelocity : 1;
+	uint8 bSavedHasPendingLocation : 1;
+	uint8 bSavedSweepPendingLocation : 1;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character & ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+};
+
+class ASHFOREST_API FNetworkPredictionData_Client_AshForest : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_AshForest(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{}
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
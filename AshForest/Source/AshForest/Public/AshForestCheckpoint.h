@@ -4,13 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Engine/TriggerBox.h"
+#include "AshForestPlayerVolumes.h"
 #include "AshForestCheckpoint.generated.h"
 
 /**
  * 
  */
 UCLASS()
-class ASHFOREST_API AAshForestCheckpoint : public ATriggerBox
+class ASHFOREST_API AAshForestCheckpoint : public ATriggerBox, public IAshPlayerVolumeListener
 {
 	GENERATED_BODY()
 
@@ -35,9 +36,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Checkpoint") FORCEINLINE
 		FTransform GetRespawnTransform() const { return RespawnPoint ? RespawnPoint->GetActorTransform() : GetActorTransform(); };
 
-	UFUNCTION()
-		void OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor);
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	UFUNCTION()
-		void OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor);
+	virtual void OnPlayerEnterVolume(AAshForestCharacter* Player) override;
+	virtual void OnPlayerExitVolume(AAshForestCharacter* Player) override;
 };
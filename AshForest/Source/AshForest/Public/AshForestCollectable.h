@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AshForestCollectable.generated.h"
+
+class USphereComponent;
+class AAshForestCharacter;
+
+/**
+ * Native base for BP_Collectable. Picking it up hides it instead of destroying it so checkpoint restores can put it back.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestCollectable : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Category = "Collectable", VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+		USphereComponent* PickupComp;
+
+public:
+	// Sets default values for this actor's properties
+	AAshForestCollectable();
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collectable")
+		int32 SmolMoniezValue;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collectable")
+		int32 BigUnitMoniezValue;
+
+	UPROPERTY(BlueprintReadOnly, Transient, SaveGame, ReplicatedUsing = RefreshCollectedState, Category = "Collectable")
+		bool bCollected;
+
+	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	UFUNCTION(BlueprintNativeEvent, Category = "Collectable")
+		void OnCollected(AAshForestCharacter* ByCharacter);
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "Collectable")
+		bool Collect(AAshForestCharacter* ByCharacter);
+
+	/** Re-applies visibility and collision for the current bCollected, after it was changed by a checkpoint restore */
+	UFUNCTION(BlueprintCallable, Category = "Collectable")
+		void RefreshCollectedState();
+
+	UFUNCTION(BlueprintPure, Category = "Collectable") FORCEINLINE
+		bool IsCollected() const { return bCollected; };
+
+	UFUNCTION()
+		void OnPickupOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
+};
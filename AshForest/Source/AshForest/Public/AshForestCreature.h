@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "DamageableCharacter.h"
 #include "AIController.h"
+#include "Engine/StreamableManager.h"
 #include "AshForestProjectile.h"
 #include "AshForestCreature.generated.h"
 
@@ -14,7 +15,7 @@ class ASHFOREST_API AAshForestCreature : public ADamageableCharacter
 	GENERATED_BODY()
 
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
-		TSubclassOf<AAshForestProjectile> AttackProjectileClass;
+		TSoftClassPtr<AAshForestProjectile> AttackProjectileClass;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
 		float AttackInterval_MIN;
@@ -36,12 +37,16 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Combat")
 		AAshForestProjectile* LastFiredProjectile;
 
+	/** Keeps the projectile class resident for as long as this creature is around */
+	TSharedPtr<FStreamableHandle> AttackProjectileHandle;
+
 public:
 	// Sets default values for this character's properties
 	AAshForestCreature();
 
 protected:
 	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
 
 public:	
 
@@ -57,4 +62,8 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 		void AttackTarget(const AActor* ForTarget);
+
+	/** Clients spawn their own simulated copy of the server's projectile from these, the projectile actor itself isn't replicated */
+	UFUNCTION(NetMulticast, Reliable)
+		void MulticastFireProjectile(const FAshProjectileSpawnParams & Params);
 };
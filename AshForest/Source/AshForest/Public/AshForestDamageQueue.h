@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+class AActor;
+class UWorld;
+class AAshForestCharacter;
+
+/**
+ * Damage dealt during the frame is queued here and applied in one pass after every actor (and its movement) has ticked,
+ * so nothing dies in the middle of a caller's hit loop. Hits from the same causer on the same target within a frame are
+ * merged into one TakeDamage call, and lock-on reselection after kills runs once at the end of the pass.
+ * Game thread only.
+ */
+class ASHFOREST_API FAshDamageQueue
+{
+public:
+	static FAshDamageQueue & Get();
+
+	void Enqueue(AActor* Target, const AActor* DamageCauser, const float DamageAmount, const FHitResult & DamageHitEvent);
+
+	/** Applies everything queued for World, called from the module after the world's actors have ticked */
+	void Resolve(UWorld* World);
+
+	FORCEINLINE bool IsResolving() const { return bResolving; }
+
+	/** Character gets ResolveKilledEnemies() once the current pass is over */
+	void AddKillListener(AAshForestCharacter* Character);
+
+	void LogStats() const;
+	void ResetStats();
+
+private:
+	FAshDamageQueue();
+
+	struct FRecord
+	{
+		TWeakObjectPtr<UWorld> World;
+		TWeakObjectPtr<AActor> Target;
+		TWeakObjectPtr<const AActor> Causer;
+		float Amount;
+		FHitResult Hit;
+	};
+
+	TArray<FRecord> Pending;
+	TArray<FRecord> Resolving;
+	TArray<TWeakObjectPtr<AAshForestCharacter>, TInlineAllocator<2>> KillListeners;
+	bool bResolving;
+
+	uint64 TotalQueued;
+	uint64 TotalApplied;
+	uint64 TotalCoalesced;
+	uint64 TotalDropped;
+	uint64 TotalDeaths;
+	int32 PeakBatch;
+	double WorstResolveMs;
+};
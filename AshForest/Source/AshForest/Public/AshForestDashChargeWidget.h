@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AshForestUserWidget.h"
+#include "AshForestDashChargeWidget.generated.h"
+
+/**
+ * Native base for DashChargeWidget, updated from AAshForestCharacter::OnDashChargesChanged
+ */
+UCLASS()
+class ASHFOREST_API UAshForestDashChargeWidget : public UAshForestUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "HUD")
+		int32 DisplayedCharges;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "HUD")
+		int32 DisplayedMaxCharges;
+
+	TWeakObjectPtr<AAshForestCharacter> BoundCharacter;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "HUD")
+		void OnDashChargesUpdated(const int32 CurrentCharges, const int32 MaxCharges);
+
+	UFUNCTION()
+		void HandleDashChargesChanged(int32 CurrentCharges, int32 MaxCharges);
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//AS: Debug visualization is compiled out of Shipping and Test builds entirely
+#define ASH_DEBUG_DRAW_ENABLED !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+class UWorld;
+
+namespace EAshDebugCategory
+{
+	enum Type
+	{
+		EAshDebug_DASH,
+		EAshDebug_CLIMB,
+		EAshDebug_LEDGE,
+		EAshDebug_LOCKON,
+		EAshDebug_CAMERA,
+		EAshDebug_MAX
+	};
+}
+
+#if ASH_DEBUG_DRAW_ENABLED
+
+extern ASHFOREST_API int32 GAshDebugDrawCategories[EAshDebugCategory::EAshDebug_MAX];
+extern ASHFOREST_API bool GAshDebugDrawForceAll;
+
+/**
+ * Records debug primitives into a fixed-size ring buffer instead of the persistent line batcher.
+ * Everything recorded is drawn as single-frame primitives from FAshDebugDraw::Render, which the module calls once per world tick.
+ * Use the ASH_DEBUG_* macros below rather than calling this directly so the calls disappear in Shipping.
+ */
+class ASHFOREST_API FAshDebugDraw
+{
+public:
+	static FORCEINLINE bool IsCategoryEnabled(const EAshDebugCategory::Type Category) { return GAshDebugDrawForceAll || GAshDebugDrawCategories[Category] != 0; }
+
+	/** Counted so several requesters (e.g. characters with bDebugAshMovement) can come and go, every category is on while any is held */
+	static void PushForceAllCategories();
+	static void PopForceAllCategories();
+
+	static void Line(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Start, const FVector & End, const FColor & Color, const float LifeTime = 0.f, const float Thickness = 0.f);
+	static void Sphere(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Center, const float Radius, const FColor & Color, const float LifeTime = 0.f, const float Thickness = 0.f);
+	static void Capsule(const UWorld* World, const EAshDebugCategory::Type Category, const FVector & Center, const float HalfHeight, const float Radius, const FQuat & Rotation, const FColor & Color, const float LifeTime = 0.f, const float Thickness = 0.f);
+	static void Message(const EAshDebugCategory::Type Category, FString && Text, const FColor & Color, const float LifeTime = 3.f);
+
+	/** Draws every live primitive that belongs to World and ages them by DeltaTime */
+	static void Render(UWorld* World, const float DeltaTime);
+
+	/** Drops everything recorded for World (or everything, if World is null) */
+	static void Clear(const UWorld* World = NULL);
+};
+
+#define ASH_DEBUG_ENABLED(Category) FAshDebugDraw::IsCategoryEnabled(EAshDebugCategory::EAshDebug_##Category)
+#define ASH_DEBUG_LINE(Category, World, ...) do { if (ASH_DEBUG_ENABLED(Category)) FAshDebugDraw::Line(World, EAshDebugCategory::EAshDebug_##Category, __VA_ARGS__); } while (0)
+#define ASH_DEBUG_SPHERE(Category, World, ...) do { if (ASH_DEBUG_ENABLED(Category)) FAshDebugDraw::Sphere(World, EAshDebugCategory::EAshDebug_##Category, __VA_ARGS__); } while (0)
+#define ASH_DEBUG_CAPSULE(Category, World, ...) do { if (ASH_DEBUG_ENABLED(Category)) FAshDebugDraw::Capsule(World, EAshDebugCategory::EAshDebug_##Category, __VA_ARGS__); } while (0)
+#define ASH_DEBUG_MESSAGE(Category, Color, Format, ...) do { if (ASH_DEBUG_ENABLED(Category)) FAshDebugDraw::Message(EAshDebugCategory::EAshDebug_##Category, FString::Printf(Format, ##__VA_ARGS__), Color); } while (0)
+
+#else
+
+#define ASH_DEBUG_ENABLED(Category) false
+#define ASH_DEBUG_LINE(Category, World, ...) do { } while (0)
+#define ASH_DEBUG_SPHERE(Category, World, ...) do { } while (0)
+#define ASH_DEBUG_CAPSULE(Category, World, ...) do { } while (0)
+#define ASH_DEBUG_MESSAGE(Category, Color, Format, ...) do { } while (0)
+
+#endif
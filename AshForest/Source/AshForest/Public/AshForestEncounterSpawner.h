@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AshForestEncounterSpawner.generated.h"
+
+class AAshForestCreature;
+
+/**
+ * Owns a pool of creatures (each possessed by its AI controller) built up front a few per frame, hidden and retired.
+ * Waves revive pooled creatures at the spawn points instead of spawning them, and creatures that die go back to the pool.
+ * Pool building and activation are both time-sliced against FrameBudgetMs.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestEncounterSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAshForestEncounterSpawner();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Encounter")
+		TSubclassOf<AAshForestCreature> CreatureClass;
+
+	/** Creatures built before the first wave */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Encounter")
+		int32 PoolSize;
+
+	/** Waves that need more creatures than are free build extra ones (still time-sliced) instead of dropping them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Encounter")
+		bool bAllowPoolGrowth;
+
+	/** Relative to the spawner, used round robin. The spawner's own transform if empty */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Encounter", meta = (MakeEditWidget = true))
+		TArray<FTransform> SpawnPoints;
+
+	/** Time per frame the spawner may spend building or activating creatures. At least one step always runs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Encounter")
+		float FrameBudgetMs;
+
+	/** Where pooled creatures wait, relative to the spawner */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Encounter", meta = (MakeEditWidget = true))
+		FVector PoolParkingOffset;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Encounter")
+		TArray<AAshForestCreature*> FreeCreatures;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Encounter")
+		TArray<AAshForestCreature*> ActiveCreatures;
+
+	int32 PendingPrewarm;
+	int32 PendingActivations;
+	int32 NextSpawnPointIndex;
+	double WorstStepMs;
+
+	AAshForestCreature* SpawnPooledCreature();
+	void ActivateCreature(AAshForestCreature* Creature);
+	FTransform GetNextSpawnTransform();
+
+	UFUNCTION()
+		void OnCreatureRetired(AActor* RetiredActor);
+
+	/** Only for creature classes that don't retire on death, they simply leave the pool */
+	UFUNCTION()
+		void OnCreatureDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Encounter")
+		void OnCreatureActivated(AAshForestCreature* Creature);
+
+public:
+
+	/** Queues Count creatures to be activated over the next frames */
+	UFUNCTION(BlueprintCallable, Category = "Encounter")
+		void SpawnWave(const int32 Count);
+
+	/** Retires every active creature, which puts them back in the pool */
+	UFUNCTION(BlueprintCallable, Category = "Encounter")
+		void ReturnAllToPool();
+
+	UFUNCTION(BlueprintPure, Category = "Encounter") FORCEINLINE
+		int32 GetNumActive() const { return ActiveCreatures.Num(); };
+
+	UFUNCTION(BlueprintPure, Category = "Encounter") FORCEINLINE
+		int32 GetNumPooled() const { return FreeCreatures.Num(); };
+
+	UFUNCTION(BlueprintPure, Category = "Encounter") FORCEINLINE
+		bool IsWaveComplete() const { return PendingActivations <= 0 && ActiveCreatures.Num() <= 0; };
+
+	UFUNCTION(BlueprintCallable, Category = "Encounter")
+		void LogEncounterStats() const;
+};
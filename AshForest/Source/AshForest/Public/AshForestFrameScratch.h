@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * Linear game thread arena that is thrown away at the end of every frame. Pages come from the engine's page pool,
+ * so once the busiest frame has been seen nothing here touches the heap.
+ * Anything allocated from it (including TArrays using TAshScratchAllocator) must not outlive the frame.
+ */
+class ASHFOREST_API FAshFrameScratch
+{
+public:
+	static FAshFrameScratch & Get();
+
+	FORCEINLINE void* Alloc(const int32 NumBytes, const int32 Alignment)
+	{
+		checkSlow(IsInGameThread());
+		return Stack.PushBytes(NumBytes, Alignment);
+	}
+
+	/** Called once per frame from the module, releases everything allocated this frame */
+	void EndFrame();
+
+	void LogStats() const;
+
+private:
+	FAshFrameScratch();
+	~FAshFrameScratch();
+
+	FMemStackBase Stack;
+	TTypeCompatibleBytes<FMemMark> FrameMark;
+
+	int32 LastFrameBytes;
+	int32 PeakFrameBytes;
+	uint32 NumGrowthFrames;
+	uint64 LastGrowthFrame;
+};
+
+/** TArray allocator backed by FAshFrameScratch, mirrors TMemStackAllocator. Reserve up front, growing leaves the old block behind until the frame ends */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TAshScratchAllocator
+{
+public:
+	typedef int32 SizeType;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType
+	{
+	public:
+		ForElementType()
+			: Data(nullptr)
+		{}
+
+		FORCEINLINE void MoveToEmpty(ForElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			Data = Other.Data;
+			Other.Data = nullptr;
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			void* oldData = Data;
+
+			if (NumElements)
+			{
+				Data = (ElementType*)FAshFrameScratch::Get().Alloc((int32)(NumElements * NumBytesPerElement), FMath::Max(Alignment, (uint32)alignof(ElementType)));
+
+				if (oldData && PreviousNumElements)
+					FMemory::Memcpy(Data, oldData, FMath::Min<int32>(NumElements, PreviousNumElements) * NumBytesPerElement);
+			}
+			else
+			{
+				Data = nullptr;
+			}
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		FORCEINLINE bool HasAllocation() const
+		{
+			return !!Data;
+		}
+
+	private:
+		ForElementType(const ForElementType&);
+		ForElementType& operator=(const ForElementType&);
+
+		ElementType* Data;
+	};
+
+	typedef ForElementType<FScriptContainerElement> ForAnyElementType;
+};
+
+template <uint32 Alignment>
+struct TAllocatorTraits<TAshScratchAllocator<Alignment>> : TAllocatorTraitsBase<TAshScratchAllocator<Alignment>>
+{
+	enum { SupportsMove = true };
+};
@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/ActorComponent.h"
+#include "AshForestCharacter.h"
+#include "AshForestGhost.generated.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class USkeletalMeshComponent;
+
+/** One fixed rate sample of a recorded run. Position is in whole cm, yaw in 1/65536ths of a turn */
+struct FAshGhostSample
+{
+	FIntVector Position;
+	uint16 Yaw;
+	uint8 MoveState;
+	bool bWallRunning;
+	bool bDashed;
+
+	FAshGhostSample()
+		: Position(0, 0, 0), Yaw(0), MoveState(0), bWallRunning(false), bDashed(false)
+	{}
+};
+
+/**
+ * Delta coder shared by the recorder and the playback stream. Positions are stored as the change in velocity since the last
+ * sample (zero for most of a run) and yaw as a wrapped delta, both as zigzag varints behind a flags byte.
+ */
+struct FAshGhostCodec
+{
+	FIntVector Position;
+	FIntVector Velocity;
+	uint16 Yaw;
+	bool bHasKey;
+
+	FAshGhostCodec() { Reset(); }
+
+	void Reset();
+	void Encode(const FAshGhostSample& Sample, TArray<uint8> & Out);
+
+	/** Advances Cursor past the sample, returns false if the data ran out or is corrupt */
+	bool Decode(const uint8* Data, const int64 Size, int64 & Cursor, FAshGhostSample & OutSample);
+
+	static const uint32 Magic = 0x47485341; //AS: "ASHG"
+	static const uint16 Version = 1;
+	static const int32 HeaderSize = 16;
+};
+
+/** Read side of a .ghost file. The file is memory mapped where the platform allows it, otherwise loaded whole */
+class ASHFOREST_API FAshGhostStream
+{
+public:
+	FAshGhostStream();
+	~FAshGhostStream();
+
+	bool Open(const FString & FileName);
+	void Close();
+
+	/** Back to the first sample */
+	void Rewind();
+	bool ReadNext(FAshGhostSample & OutSample);
+
+	FORCEINLINE bool IsOpen() const { return Data != NULL; }
+	FORCEINLINE int32 GetSampleRate() const { return SampleRate; }
+	FORCEINLINE int32 GetNumSamples() const { return NumSamples; }
+	FORCEINLINE int64 GetSize() const { return Size; }
+	FORCEINLINE bool IsMapped() const { return MappedRegion != NULL; }
+
+private:
+	IMappedFileHandle* MappedHandle;
+	IMappedFileRegion* MappedRegion;
+	TArray<uint8> LoadedData;
+
+	const uint8* Data;
+	int64 Size;
+	int64 Cursor;
+	int32 SampleRate;
+	int32 NumSamples;
+	FAshGhostCodec Codec;
+};
+
+/**
+ * Records its AAshForestCharacter owner at a fixed rate into an in-memory ghost stream (a few KB per minute) and writes
+ * it to Saved/Ghosts/<Name>.ghost when recording stops. Added on demand by AshForest.GhostRecord.
+ */
+UCLASS(ClassGroup = (AshForest), meta = (BlueprintSpawnableComponent))
+class ASHFOREST_API UAshForestGhostRecorder : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAshForestGhostRecorder();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+		int32 SampleRate;
+
+	/** Recording stops and saves by itself after this long */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+		float MaxRecordingSeconds;
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+		void StartRecording(const FString & GhostName);
+
+	/** Returns the path written, empty if nothing was recorded or bSave is false */
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+		FString StopRecording(const bool bSave = true);
+
+	UFUNCTION(BlueprintPure, Category = "Ghost") FORCEINLINE
+		bool IsRecording() const { return bRecording; };
+
+	static FString GetGhostPath(const FString & GhostName);
+
+	void LogStats() const;
+
+private:
+	void WriteSample(const AAshForestCharacter* Character);
+
+	FString RecordingName;
+	TArray<uint8> Buffer;
+	FAshGhostCodec Codec;
+	int32 NumSamples;
+	float SampleAccumulator;
+	float LastDashStartTime;
+	bool bRecording;
+};
+
+/**
+ * Plays a recorded ghost back. No collision, no movement component and a single tick that interpolates between two
+ * decoded samples, so several can run next to the player. MoveState/bIsWallRunning/Speed are there for the anim Blueprint.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestGhost : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAshForestGhost();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Ghost")
+		USceneComponent* Root;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Ghost")
+		USkeletalMeshComponent* Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+		float PlaybackRate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+		bool bLoop;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Ghost")
+		TEnumAsByte<EAshCustomMoveState::Type> MoveState;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Ghost")
+		bool bIsWallRunning;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Ghost")
+		float Speed;
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost")
+		bool StartPlayback(const FString & InGhostName);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost", meta = (WorldContext = "WorldContextObject"))
+		static AAshForestGhost* SpawnGhost(const UObject* WorldContextObject, const FString & InGhostName, TSubclassOf<AAshForestGhost> GhostClass);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Ghost")
+		void OnGhostDash();
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Ghost")
+		void OnPlaybackFinished();
+
+	void LogStats() const;
+
+protected:
+	void Restart();
+	bool AdvanceTo(const int32 SampleIndex);
+	void ApplySamples(const float Alpha);
+
+	FAshGhostStream Stream;
+	FAshGhostSample PrevSample;
+	FAshGhostSample NextSample;
+	FString GhostName;
+	int32 NextSampleIndex;
+	float PlaybackTime;
+	bool bPlaying;
+};
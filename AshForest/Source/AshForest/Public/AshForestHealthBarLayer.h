@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AshForestUserWidget.h"
+#include "AshForestHealthBarLayer.generated.h"
+
+class UCanvasPanel;
+class UCanvasPanelSlot;
+class UAshForestHealthWidget;
+class ADamageableCharacter;
+
+/**
+ * Lives in PlayerHUD and replaces per-creature health bar widget components. Owns a fixed pool of health bars and
+ * hands them out each frame to the closest creatures that are on screen and either damaged or locked on to,
+ * projecting all of them with a single view-projection matrix.
+ */
+UCLASS()
+class ASHFOREST_API UAshForestHealthBarLayer : public UAshForestUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UAshForestHealthBarLayer(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD", meta = (BindWidget))
+		UCanvasPanel* BarCanvas;
+
+	/** CreatureHealthWidget, or anything else derived from UAshForestHealthWidget */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+		TSubclassOf<UAshForestHealthWidget> HealthBarClass;
+
+	/** Size of the pool, and so the most bars that can be on screen at once */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+		int32 MaxBars;
+
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+		float MaxBarDistance;
+
+	/** World space offset above the top of the character's capsule */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+		float BarHeightOffset;
+
+	/** Characters not rendered within this many seconds don't get a bar */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+		float VisibleTolerance;
+
+	struct FBarCandidate
+	{
+		ADamageableCharacter* Character;
+		FVector WorldLocation;
+		float DistSq;
+		bool bLockedOn;
+	};
+
+	UPROPERTY(Transient)
+		TArray<UAshForestHealthWidget*> BarPool;
+
+	TArray<UCanvasPanelSlot*> BarSlots;
+	bool bBarPoolRequested;
+	TArray<FBarCandidate> Candidates;
+
+	void GatherCandidates();
+	void AssignBars(const FMatrix & ViewProjection, const FIntRect & ViewRect, const float ViewportScale);
+};
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AshForestUserWidget.h"
+#include "AshForestHealthWidget.generated.h"
+
+class ADamageableCharacter;
+
+/**
+ * Native base for the PlayerHUD health bar and CreatureHealthWidget, updated from ADamageableCharacter::OnHealthChanged.
+ * Tracks the owning pawn unless SetHealthSource is given another character.
+ */
+UCLASS()
+class ASHFOREST_API UAshForestHealthWidget : public UAshForestUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "HUD")
+		void SetHealthSource(ADamageableCharacter* NewSource);
+
+	UFUNCTION(BlueprintPure, Category = "HUD") FORCEINLINE
+		ADamageableCharacter* GetHealthSource() const { return HealthSource.Get(); };
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	/** When set, the widget binds to the owning player's pawn on construct */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "HUD")
+		bool bTrackOwningPawn;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "HUD")
+		float DisplayedHealth;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "HUD")
+		float DisplayedMaxHealth;
+
+	TWeakObjectPtr<ADamageableCharacter> HealthSource;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "HUD")
+		void OnHealthUpdated(const float CurrentHealth, const float MaxHealth, const float HealthPercent);
+
+	UFUNCTION()
+		void HandleHealthChanged(ADamageableCharacter* Character, float NewHealth, float MaxHealth);
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UClass;
+class USceneComponent;
+struct FHitResult;
+
+namespace EAshInterfaceEvent
+{
+	enum Type
+	{
+		EAshEvent_GET_TARGETABLE_COMPONENTS,
+		EAshEvent_CAN_BE_TARGETED,
+		EAshEvent_CAN_BE_DAMAGED,
+		EAshEvent_IGNORES_COLLISION,
+		EAshEvent_TAKE_DAMAGE,
+		EAshEvent_ALLOWS_ACTIVATION_STATE,
+		EAshEvent_MAX
+	};
+}
+
+/** What a class supports, worked out once per UClass */
+struct FAshClassCapabilities
+{
+	bool bTargetable;
+	bool bActivateable;
+
+	/** Offsets from the object to its native interface pointers, INDEX_NONE when the interface is only implemented in Blueprint */
+	int32 TargetableOffset;
+	int32 ActivateableOffset;
+
+	/** Bit per EAshInterfaceEvent that a Blueprint in the hierarchy overrides */
+	uint32 ScriptOverrideMask;
+
+	FAshClassCapabilities()
+		: bTargetable(false), bActivateable(false), TargetableOffset(INDEX_NONE), ActivateableOffset(INDEX_NONE), ScriptOverrideMask(0)
+	{}
+};
+
+/**
+ * Cached replacement for ImplementsInterface + ITargetableInterface/IActivateableInterface::Execute_* in hot paths.
+ * Events no Blueprint overrides call the native _Implementation virtually instead of going through ProcessEvent.
+ * Game thread only.
+ */
+class ASHFOREST_API FAshInterfaceDispatch
+{
+public:
+	static const FAshClassCapabilities & GetCapabilities(const UClass* Class);
+
+	static bool IsTargetable(const AActor* Actor);
+	static bool IsActivateable(const AActor* Actor);
+
+	static bool GetTargetableComponents(AActor* Actor, TArray<USceneComponent*> & TargetableComps);
+	static bool CanBeTargeted(AActor* Actor, const AActor* ByActor);
+	static bool CanBeDamaged(AActor* Actor, const AActor* DamageCauser, const FHitResult & DamageHitEvent);
+	static bool IgnoresCollisionWithDamager(AActor* Actor, const AActor* DamageCauser, const FHitResult & DamageHitEvent);
+	static void TakeDamage(AActor* Actor, const AActor* DamageCauser, const float DamageAmount, const FHitResult & DamageHitEvent);
+	static bool AllowsActivationState(AActor* Actor, const AActor* ByActivator, const bool NewActivationState);
+
+	/** Drops every cached class. Called when a world initializes (PIE start, map load) and when the editor replaces recompiled Blueprint classes */
+	static void ClearCache();
+
+	static void LogStats();
+	static void ResetStats();
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+namespace EAshJobPriority
+{
+	enum Type
+	{
+		EAshJob_HIGH,
+		EAshJob_NORMAL,
+		EAshJob_LOW,
+		EAshJob_MAX
+	};
+}
+
+/**
+ * Deferred gameplay work that doesn't have to happen in the frame that caused it. Drained once per world tick after the
+ * damage queue, highest priority first, until ash.JobBudgetMs is used up; jobs past their deadline always run.
+ * A job is dropped if its context object is gone by the time it would run. Game thread only.
+ */
+class ASHFOREST_API FAshJobQueue
+{
+public:
+	static FAshJobQueue & Get();
+
+	/** Deadline is seconds from now after which the job runs regardless of the budget, 0 for none */
+	void Post(const UObject* Context, const TCHAR* Name, const EAshJobPriority::Type Priority, const float Deadline, TFunction<void()> && Job);
+
+	void Drain(UWorld* World);
+
+	int32 GetNumPending() const;
+
+	void LogStats() const;
+	void ResetStats();
+
+private:
+	FAshJobQueue();
+
+	struct FJob
+	{
+		TWeakObjectPtr<const UObject> Context;
+		TWeakObjectPtr<UWorld> World;
+		const TCHAR* Name;
+		TFunction<void()> Work;
+		double PostTime;
+		double DeadlineTime;
+		uint64 PostFrame;
+	};
+
+	/** FIFO per priority, Head is the first job that hasn't run yet */
+	struct FLane
+	{
+		TArray<FJob> Jobs;
+		int32 Head;
+
+		FLane() : Head(0) {}
+
+		FORCEINLINE int32 Num() const { return Jobs.Num() - Head; }
+		void Compact();
+	};
+
+	FLane Lanes[EAshJobPriority::EAshJob_MAX];
+
+	bool RunJob(FJob & Job, UWorld* World, const double Now);
+
+	uint64 TotalPosted;
+	uint64 TotalRun;
+	uint64 TotalDropped;
+	uint64 TotalForcedByDeadline;
+	double TotalLatencyMs;
+	double WorstLatencyMs;
+	uint64 WorstLatencyFrames;
+	int32 PeakDepth;
+};
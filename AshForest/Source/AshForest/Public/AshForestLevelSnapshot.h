@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "Templates/Function.h"
+
+class AActor;
+class UWorld;
+
+/**
+ * In-memory copy of the retry relevant state of a level: every SaveGame property of damageable characters, triggers,
+ * activateable actors and collectables, serialized back to back into one blob. Restoring writes the blob back into the
+ * same actors in place, revives retired creatures and clears live projectiles, so a checkpoint retry never reloads the map.
+ */
+class ASHFOREST_API FAshForestLevelSnapshot
+{
+public:
+	static bool IsSnapshotActor(const AActor* Actor);
+
+	/** Level short name plus actor name. Stable across runs and PIE for placed actors, which is all a snapshot keeps */
+	static FString GetActorKey(const AActor* Actor);
+
+	void Capture(UWorld* World);
+
+	/** Returns the number of actors that were restored */
+	int32 Restore(UWorld* World);
+
+	void Reset();
+
+	/**
+	 * Debug check behind AshForest.SnapshotCheck: every SaveGame bool/int of the captured actors has to survive a capture and read back.
+	 * Transport, if set, gets the snapshot in between and may replace it (AshForest.SaveCheck sends it through a save file). Returns the number that didn't survive
+	 */
+	static int32 VerifyRoundTrip(UWorld* World, const TFunction<void(FAshForestLevelSnapshot&)> & Transport = TFunction<void(FAshForestLevelSnapshot&)>());
+
+	/** One key per record, empty for actors that have been destroyed since the capture */
+	void GetActorKeys(TArray<FString> & OutKeys) const;
+
+	/** For a snapshot read back from disk: points the records at the actors matching Keys, records with no match are dropped */
+	int32 ResolveActors(UWorld* World, const TArray<FString> & Keys);
+
+	/** Records and blob only, the actors are matched up again with ResolveActors. Doesn't touch any UObject */
+	friend ASHFOREST_API FArchive& operator<<(FArchive& Ar, FAshForestLevelSnapshot& Snapshot);
+
+	FORCEINLINE bool IsValid() const { return Records.Num() > 0; }
+	FORCEINLINE int32 GetNumRecords() const { return Records.Num(); }
+	FORCEINLINE int32 GetBlobSize() const { return Blob.Num(); }
+
+private:
+	struct FActorRecord
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FTransform Transform;
+		int32 Offset;
+		int32 Size;
+		bool bRetired;
+	};
+
+	TArray<FActorRecord> Records;
+	TArray<uint8> Blob;
+};
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AshForestLevelStreamer.generated.h"
+
+class ULevelStreaming;
+class AAshForestCharacter;
+
+USTRUCT(BlueprintType)
+struct FAshStreamingSegment
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Short package name of the streaming sublevel, e.g. AshPrison_CriticalPath_A */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		FName LevelName;
+
+	/** The segment becomes the current one once the player's latest checkpoint index reaches this */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		int32 FirstCheckpointIndex;
+
+	/** World space area covered by the segment, used to predict where the player's velocity is taking them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		FBox Bounds;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		float EstimatedMemoryMB;
+
+	/** Backdrop levels (Distance, MountainRange) that should never be unloaded */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		bool bAlwaysLoaded;
+
+	UPROPERTY(Transient)
+		ULevelStreaming* StreamingLevel;
+
+	float LoadRequestTime;
+	float LateSinceTime;
+	bool bLoadRequested;
+
+	FAshStreamingSegment()
+		: FirstCheckpointIndex(-1), Bounds(ForceInit), EstimatedMemoryMB(64.f), bAlwaysLoaded(false), StreamingLevel(NULL)
+		, LoadRequestTime(-1.f), LateSinceTime(-1.f), bLoadRequested(false)
+	{}
+};
+
+/**
+ * Placed once in a persistent map. Streams the critical path sublevels in ahead of the player using the latest checkpoint,
+ * the player's velocity and the segment ordering, keeps the previous segment warm for respawns and unloads behind the player
+ * when the loaded set goes over MemoryBudgetMB.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestLevelStreamer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAshForestLevelStreamer();
+
+	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+
+	/** Critical path order, first segment first */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Streaming")
+		TArray<FAshStreamingSegment> Segments;
+
+	/** How far ahead (in seconds of current velocity) to look for segments the player is about to enter */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		float VelocityLookAheadTime;
+
+	/** Segment bounds are expanded by this much when testing the predicted path */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		float PredictionPadding;
+
+	/** Number of segments past the current one along the critical path that are always requested */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		int32 SegmentsAhead;
+
+	/** Number of segments behind the current one kept loaded so respawns never wait on a load */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		int32 SegmentsBehind;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		float MemoryBudgetMB;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+		float UpdateInterval;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Streaming|Telemetry")
+		int32 CurrentSegmentIndex;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Streaming|Telemetry")
+		int32 LateLoadCount;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Streaming|Telemetry")
+		float TotalLateLoadSeconds;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Streaming|Telemetry")
+		float WorstLateLoadSeconds;
+
+	UFUNCTION(BlueprintCallable, Category = "Streaming")
+		void UpdateStreaming();
+
+	UFUNCTION(BlueprintPure, Category = "Streaming")
+		bool IsSegmentReady(const int32 SegmentIndex) const;
+
+	int32 FindCurrentSegment(const AAshForestCharacter* Player) const;
+	void GatherNeededSegments(const AAshForestCharacter* Player, TBitArray<> & OutNeeded) const;
+	void RequestLoad(FAshStreamingSegment & Segment);
+	void RequestUnload(FAshStreamingSegment & Segment);
+	void UpdateLateLoadTelemetry(const AAshForestCharacter* Player, const TBitArray<> & Needed);
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Streaming")
+		void LogStreamingStats() const;
+};
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Lock-on candidate positions in SoA form (planar X/Y only, lock-on is yaw based), padded to the SIMD width.
+ * Evaluate fills Key/Side for every candidate against one origin and reference direction.
+ */
+struct ASHFOREST_API FAshLockOnBatch
+{
+	TArray<float, TAlignedHeapAllocator<16>> PosX;
+	TArray<float, TAlignedHeapAllocator<16>> PosY;
+
+	/** Signed squared cosine of the angle between the reference direction and the candidate, see FAshLockOnKernel::CosineKey */
+	TArray<float, TAlignedHeapAllocator<16>> Key;
+
+	/** Z of Reference x ToCandidate, > 0 is to the right of the reference direction */
+	TArray<float, TAlignedHeapAllocator<16>> Side;
+
+	int32 Num;
+
+	FAshLockOnBatch() : Num(0) {}
+
+	void Reset();
+	int32 Add(const FVector & Location);
+
+	FORCEINLINE int32 GetPaddedNum() const { return PosX.Num(); }
+};
+
+/**
+ * Batched lock-on scoring without acos: candidates are compared through CosineKey(cos(angle)), which is monotonic in the
+ * angle, against thresholds converted once with the same function. Both the SIMD path and a scalar reference (the original
+ * acos based math) are kept so AshForest.LockOnKernelBench can check them against each other.
+ */
+class ASHFOREST_API FAshLockOnKernel
+{
+public:
+	/** cos * |cos|, keeps the ordering of cos (and so the reverse ordering of the angle) without a sqrt per candidate */
+	static FORCEINLINE float CosineKey(const float Cos) { return Cos * FMath::Abs(Cos); }
+
+	/** Threshold key for "angle <= MaxAngleDegrees" */
+	static float ConeKey(const float MaxAngleDegrees);
+
+	/** Unsigned angle in degrees back from a key, for debug output */
+	static float KeyToDegrees(const float Key);
+
+	/** Fills Batch.Key and Batch.Side. RefDir only needs to be planar and unit length */
+	static void Evaluate(FAshLockOnBatch & Batch, const FVector & Origin, const FVector & RefDir);
+
+	/** Index of the smallest angle with Key >= MinKey (first wins on ties), INDEX_NONE if none */
+	static int32 PickBestInCone(const FAshLockOnBatch & Batch, const float MinKey);
+
+	/** Closest candidate on each side of the reference direction, ignoring SkipIndex and anything dead ahead */
+	static void PickSwitchTargets(const FAshLockOnBatch & Batch, const int32 SkipIndex, int32 & OutBestLeft, int32 & OutBestRight);
+
+	//AS: Scalar references, same math as the original per-candidate code
+	static int32 PickBestInCone_Scalar(const TArray<FVector> & Locations, const FVector & Origin, const FVector & RefDir, const float MaxAngleDegrees);
+	static void PickSwitchTargets_Scalar(const TArray<FVector> & Locations, const FVector & Origin, const FVector & RefDir, const int32 SkipIndex, int32 & OutBestLeft, int32 & OutBestRight);
+};
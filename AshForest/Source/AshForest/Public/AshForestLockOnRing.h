@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USceneComponent;
+
+/**
+ * Lock-on targets kept sorted by their planar angle around the player. Membership is rebuilt occasionally, positions every frame;
+ * since targets barely move between frames the re-sort is an insertion sort over an almost sorted array.
+ * Increasing index is clockwise seen from above, i.e. to the right.
+ */
+class ASHFOREST_API FAshLockOnRing
+{
+public:
+	struct FEntry
+	{
+		TWeakObjectPtr<USceneComponent> Target;
+		FVector Location;
+		float Angle;
+	};
+
+	/** Monotonic stand-in for atan2 over [0, 4), cheap enough to recompute for every entry every frame */
+	static float PseudoAngle(const FVector & Dir);
+
+	void Rebuild(TArrayView<USceneComponent* const> Targets, const FVector & Origin);
+	void Update(const FVector & Origin);
+	void Reset();
+
+	/** Binary search on the target's angle, INDEX_NONE if it isn't in the ring */
+	int32 Find(const USceneComponent* Target) const;
+
+	FORCEINLINE int32 Num() const { return Entries.Num(); }
+	FORCEINLINE const FEntry & GetWrapped(const int32 Index) const { return Entries[((Index % Entries.Num()) + Entries.Num()) % Entries.Num()]; }
+	FORCEINLINE const FVector & GetOrigin() const { return Origin; }
+
+private:
+	TArray<FEntry> Entries;
+	FVector Origin;
+
+	void SortEntries();
+};
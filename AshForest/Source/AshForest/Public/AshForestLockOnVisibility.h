@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+
+class UWorld;
+class USceneComponent;
+
+/**
+ * Per-character line of sight cache for lock-on candidates. A result is reused until the target or the view point moves
+ * further than MoveTolerance or it gets older than MaxAge; RefreshStale re-traces a few of the oldest entries each frame so
+ * most lookups while locked on never trace at all.
+ */
+class ASHFOREST_API FAshLockOnVisibilityCache
+{
+public:
+	FAshLockOnVisibilityCache();
+
+	float MaxAge;
+	float MoveTolerance;
+	int32 RefreshPerFrame;
+
+	/** Cached result if still valid, otherwise traces ECC_Camera from ViewLoc and stores the result */
+	bool IsVisible(UWorld* World, USceneComponent* Target, const FVector & TargetLoc, const FVector & ViewLoc, const FCollisionQueryParams & Params);
+
+	/** Re-traces up to RefreshPerFrame entries that are about to go stale and drops entries for targets that are gone */
+	void RefreshStale(UWorld* World, const FVector & ViewLoc, const FCollisionQueryParams & Params);
+
+	void Reset();
+
+	FORCEINLINE int32 GetNumEntries() const { return Entries.Num(); }
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<USceneComponent> Target;
+		FVector TargetLoc;
+		FVector ViewLoc;
+		float TraceTime;
+		float LastUsedTime;
+		bool bVisible;
+	};
+
+	TArray<FEntry> Entries;
+
+	bool Trace(UWorld* World, USceneComponent* Target, const FVector & TargetLoc, const FVector & ViewLoc, const FCollisionQueryParams & Params) const;
+	bool IsFresh(const FEntry & Entry, const FVector & TargetLoc, const FVector & ViewLoc, const float Now) const;
+};
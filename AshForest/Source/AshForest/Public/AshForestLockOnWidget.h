@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AshForestUserWidget.h"
+#include "AshForestLockOnWidget.generated.h"
+
+/**
+ * Native base for LockOnWidget, updated from AAshForestCharacter::OnLockOnTargetChanged
+ */
+UCLASS()
+class ASHFOREST_API UAshForestLockOnWidget : public UAshForestUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "HUD")
+		TWeakObjectPtr<USceneComponent> DisplayedTarget;
+
+	TWeakObjectPtr<AAshForestCharacter> BoundCharacter;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "HUD")
+		void OnLockOnTargetDisplayed(USceneComponent* NewTarget, USceneComponent* PreviousTarget);
+
+	UFUNCTION()
+		void HandleLockOnTargetChanged(USceneComponent* NewTarget, USceneComponent* PreviousTarget);
+};
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "AshForestMemory.generated.h"
+
+//AS: Project LLM tags live in the ProjectTagStart..ProjectTagEnd range reserved by the engine
+namespace EAshForestLLMTag
+{
+	enum Type
+	{
+		EAshLLM_CHARACTERS = 150,
+		EAshLLM_CREATURES,
+		EAshLLM_PROJECTILES,
+		EAshLLM_VFX,
+		EAshLLM_TRIGGERS,
+		EAshLLM_COLLECTABLES,
+		EAshLLM_MAX
+	};
+}
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+#define ASH_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)EAshForestLLMTag::EAshLLM_##Tag)
+#else
+#define ASH_LLM_SCOPE(Tag)
+#endif
+
+USTRUCT(BlueprintType)
+struct FAshSublevelMemReport
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		FString LevelName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		bool bIsVisible;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 ActorCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 ComponentCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 CharacterCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 CreatureCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 ProjectileCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 ParticleComponentCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 TriggerCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		int32 CollectableCount;
+
+	/** Property memory of every actor and component plus their exclusive resource size (int64 isn't Blueprint exposable) */
+	UPROPERTY(BlueprintReadOnly, Category = "Memory")
+		float EstimatedKB;
+
+	int64 EstimatedBytes;
+
+	FAshSublevelMemReport()
+		: bIsVisible(false), ActorCount(0), ComponentCount(0), CharacterCount(0), CreatureCount(0), ProjectileCount(0)
+		, ParticleComponentCount(0), TriggerCount(0), CollectableCount(0), EstimatedKB(0.f), EstimatedBytes(0)
+	{}
+};
+
+/**
+ * LLM tag registration plus a per-sublevel breakdown of what the loaded AshPrison_* / AshRuins_* levels cost.
+ * The report is exposed to Blueprint/automation and through the AshForest.MemReport console command.
+ */
+UCLASS()
+class ASHFOREST_API UAshForestMemoryLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	static void RegisterLLMTags();
+
+	/** Fills OutReports with one entry per loaded level (persistent level first) */
+	UFUNCTION(BlueprintCallable, Category = "Memory", meta = (WorldContext = "WorldContextObject"))
+		static void GetSublevelMemoryReport(const UObject* WorldContextObject, TArray<FAshSublevelMemReport> & OutReports);
+
+	/** Logs the report and optionally writes it as a CSV under Saved/Profiling/AshForest, returns the CSV path if one was written */
+	UFUNCTION(BlueprintCallable, Category = "Memory", meta = (WorldContext = "WorldContextObject"))
+		static FString PrintSublevelMemoryReport(const UObject* WorldContextObject, const bool bWriteCSV = false);
+};
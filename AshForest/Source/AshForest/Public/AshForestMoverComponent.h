@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineBaseTypes.h"
+#include "UObject/ObjectKey.h"
+#include "AshForestMoverComponent.generated.h"
+
+class UCurveFloat;
+class UAshForestMoverComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMoverFinishedSignature, UAshForestMoverComponent*, Mover, bool, bOpen);
+
+/** One per world, updates every mover that is in motion. Only enabled while at least one is */
+USTRUCT()
+struct FAshMoverTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	TWeakObjectPtr<UWorld> World;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAshMoverTickFunction> : public TStructOpsTypeTraitsBase2<FAshMoverTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Moves a component of its actor (the root by default) between its placed transform and an open offset, shaped by MoveCurve.
+ * Moves are kinematic (no sweep, no teleport) so anything standing on it is carried along. The component itself never ticks,
+ * FAshMovers updates all moving movers of a world in one pre-physics tick function that is disabled while they're all at rest.
+ */
+UCLASS(ClassGroup = (AshForest), meta = (BlueprintSpawnableComponent))
+class ASHFOREST_API UAshForestMoverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAshForestMoverComponent();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Component to move, the actor's root if None */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover")
+		FName MovedComponentName;
+
+	/** Relative to the placed transform */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover", meta = (MakeEditWidget = true))
+		FVector OpenOffset;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover")
+		FRotator OpenRotation;
+
+	/** Maps normalized move time (0-1) to how open it is (0-1). Linear if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover")
+		UCurveFloat* MoveCurve;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover")
+		float MoveDuration;
+
+	/** AAshForestActivateableActor opens this on Activate and closes it on Deactivate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover")
+		bool bDriveFromActivation;
+
+	UPROPERTY(BlueprintAssignable, Category = "Mover")
+		FOnMoverFinishedSignature OnMoveFinished;
+
+	UFUNCTION(BlueprintCallable, Category = "Mover")
+		void Open();
+
+	UFUNCTION(BlueprintCallable, Category = "Mover")
+		void Close();
+
+	/** Jumps straight to open or closed without moving through the way, e.g. after a checkpoint restore */
+	UFUNCTION(BlueprintCallable, Category = "Mover")
+		void SnapTo(const bool bOpen);
+
+	UFUNCTION(BlueprintPure, Category = "Mover") FORCEINLINE
+		bool IsMoving() const { return bIsMoving; };
+
+	UFUNCTION(BlueprintPure, Category = "Mover") FORCEINLINE
+		float GetMoveTime() const { return MoveTime; };
+
+	/** Advances the move, returns false once it has arrived */
+	bool UpdateMove(const float DeltaTime);
+
+protected:
+
+	UPROPERTY(Transient)
+		USceneComponent* MovedComponent;
+
+	FTransform ClosedRelativeTransform;
+
+	/** Normalized 0 (closed) to 1 (open) */
+	float MoveTime;
+	bool bTargetOpen;
+	bool bIsMoving;
+
+	void StartMove(const bool bOpen);
+	void ApplyMoveTime();
+};
+
+/** Tracks movers per world and owns the world's FAshMoverTickFunction. Game thread only */
+class ASHFOREST_API FAshMovers
+{
+public:
+	static FAshMovers & Get();
+
+	void Register(UAshForestMoverComponent* Mover);
+	void Unregister(UAshForestMoverComponent* Mover);
+
+	/** Wakes the world's tick function up if it was asleep */
+	void StartMoving(UAshForestMoverComponent* Mover);
+
+	/** Rider ticks after the world's movers, e.g. a locally controlled character's movement so it stands on where a mover is this frame */
+	void AddRider(UActorComponent* Rider);
+	void RemoveRider(UActorComponent* Rider);
+
+	void TickMovers(UWorld* World, const float DeltaTime);
+
+	void LogStats() const;
+
+private:
+	FAshMovers();
+
+	struct FWorldMovers
+	{
+		TUniquePtr<FAshMoverTickFunction> TickFunction;
+		TArray<TWeakObjectPtr<UAshForestMoverComponent>> Moving;
+		TArray<TWeakObjectPtr<UActorComponent>> Riders;
+		int32 NumRegistered;
+
+		FWorldMovers()
+			: NumRegistered(0)
+		{}
+	};
+
+	TMap<FObjectKey, FWorldMovers> Worlds;
+
+	uint64 TotalMoves;
+	int32 PeakMoving;
+};
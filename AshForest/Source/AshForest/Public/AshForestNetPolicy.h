@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class AController;
+
+/**
+ * Replication policy for the level's mostly static gameplay actors (triggers, activateables, collectables).
+ * They start DORM_Initial and only replicate when a state change flushes them. Actors placed in *_Distance sublevels get a
+ * cull distance from ash.Net.DistanceLevelCullDistance instead of the default one.
+ * Game thread only.
+ */
+class ASHFOREST_API FAshNetPolicy
+{
+public:
+	/** Constructor defaults (the actor sets bReplicates itself): initially dormant, slow update rate for the rare moments it is awake */
+	static void InitStaticActor(AActor* Actor);
+
+	/** BeginPlay: relevancy for the actor's sublevel */
+	static void ApplyLevelRelevancy(AActor* Actor);
+
+	/** Call before changing replicated state on a dormant actor */
+	static void Flush(AActor* Actor);
+
+	/** Called from IsNetRelevantFor overrides, feeds the per net tick "considered" stat */
+	static void NoteConsidered(const AActor* Actor);
+
+	static void LogStats(UWorld* World);
+	static void ResetStats();
+};
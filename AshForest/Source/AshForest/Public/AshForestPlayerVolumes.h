@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AActor;
+class UWorld;
+class UBoxComponent;
+class AAshForestCharacter;
+
+/** Native side of a volume only the player cares about, implemented next to the actor's UObject base */
+class ASHFOREST_API IAshPlayerVolumeListener
+{
+public:
+	virtual ~IAshPlayerVolumeListener() {}
+
+	virtual void OnPlayerEnterVolume(AAshForestCharacter* Player) = 0;
+	virtual void OnPlayerExitVolume(AAshForestCharacter* Player) = 0;
+};
+
+/**
+ * Player-only replacement for overlap events on static trigger volumes (focus points, checkpoints).
+ * Volumes register their box once at BeginPlay into a per-world 2D grid, and once per frame (after actors have ticked) each player
+ * character's capsule is tested against the volumes in the cells it touches. Enter/exit are sent to IAshPlayerVolumeListener,
+ * so the volumes themselves don't need to generate overlaps at all.
+ * Boxes are tested in their own space against the capsule's upright bounds, exact for the yaw-only boxes levels use.
+ * Game thread only, volumes mustn't move after registering.
+ */
+class ASHFOREST_API FAshPlayerVolumes
+{
+public:
+	static FAshPlayerVolumes & Get();
+
+	void Register(AActor* Volume, UBoxComponent* Box, IAshPlayerVolumeListener* Listener);
+
+	/** Sends exits for any player still inside */
+	void Unregister(AActor* Volume);
+
+	/** Called from the module after the world's actors (and their movement) have ticked */
+	void Update(UWorld* World);
+
+	void LogStats() const;
+	void ResetStats();
+
+private:
+	FAshPlayerVolumes();
+
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Volume;
+		IAshPlayerVolumeListener* Listener;
+		FTransform BoxToWorld;
+		FVector Extent;
+		FBox Bounds;
+		uint32 QueryStamp;
+	};
+
+	struct FWorldVolumes
+	{
+		TArray<FEntry> Entries;
+		TArray<int32> FreeEntries;
+		TMap<FIntPoint, TArray<int32>> Cells;
+
+		/** Entries each player is currently inside */
+		TMap<TWeakObjectPtr<AAshForestCharacter>, TArray<int32>> Inside;
+
+		int32 NumLive;
+
+		FWorldVolumes()
+			: NumLive(0)
+		{}
+	};
+
+	FIntPoint GetCell(const FVector & Location) const;
+	bool IsCapsuleInside(const FEntry & Entry, const FVector & CapsuleLoc, const float Radius, const float HalfHeight) const;
+	void RemoveEntry(FWorldVolumes & WorldVolumes, const int32 EntryIndex);
+
+	TMap<FObjectKey, FWorldVolumes> Worlds;
+
+	float CellSize;
+	uint32 CurrentStamp;
+
+	uint64 TotalEnters;
+	uint64 TotalExits;
+	uint64 TotalTests;
+	int32 PeakCandidates;
+};
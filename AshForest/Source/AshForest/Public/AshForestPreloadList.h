@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AshForestPreloadList.generated.h"
+
+/**
+ * Assets a map needs before the first playable frame (player pawn, creature projectiles, hit/explosion VFX...).
+ * The game mode streams everything listed here in asynchronously during the map transition, so gameplay code can keep
+ * soft references and still find them resident the first time they are used.
+ */
+UCLASS(BlueprintType)
+class ASHFOREST_API UAshForestPreloadList : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Preloading")
+		TArray<TSoftClassPtr<UObject>> Classes;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Preloading")
+		TArray<TSoftObjectPtr<UObject>> Assets;
+
+	void GatherAssetPaths(TArray<FSoftObjectPath> & OutPaths) const;
+};
@@ -6,10 +6,68 @@
 #include "GameFramework/Actor.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/StreamableManager.h"
+#include "AshForestRewindHistory.h"
 #include "AshForestProjectile.generated.h"
 
 class UCapsuleComponent;
 
+/** Everything a client needs to simulate a fireball itself, multicast by the firing creature instead of replicating the actor */
+USTRUCT()
+struct FAshProjectileSpawnParams
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+		FVector_NetQuantize10 Origin;
+
+	UPROPERTY()
+		FVector_NetQuantizeNormal Direction;
+
+	/** Server world time at spawn, clients fast forward their copy by however late the spawn arrived */
+	UPROPERTY()
+		float ServerSpawnTime;
+
+	UPROPERTY()
+		uint16 ProjectileId;
+
+	FAshProjectileSpawnParams()
+		: Origin(ForceInitToZero), Direction(ForceInitToZero), ServerSpawnTime(0.f), ProjectileId(0)
+	{}
+};
+
+/** Authoritative result of a deflection, applied on top of whatever the client simulated or predicted */
+USTRUCT()
+struct FAshProjectileDeflectEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+		uint16 ProjectileId;
+
+	/** Per projectile, so late or repeated events can be told apart from new ones */
+	UPROPERTY()
+		uint8 EventId;
+
+	UPROPERTY()
+		FVector_NetQuantize10 Location;
+
+	UPROPERTY()
+		FVector_NetQuantize10 Velocity;
+
+	UPROPERTY()
+		APawn* Deflector;
+
+	FAshProjectileDeflectEvent()
+		: ProjectileId(0), EventId(0), Location(ForceInitToZero), Velocity(ForceInitToZero), Deflector(NULL)
+	{}
+};
+
+/**
+ * Projectiles never replicate as actors. The server's copy is authoritative (damage, deflections), clients spawn their own
+ * simulated copy from FAshProjectileSpawnParams and only receive deflection events afterwards.
+ * Measure with several PIE clients, a network emulation profile (or Net PktLag/PktLoss), stat net and AshForest.ProjectileNetStats.
+ */
 UCLASS()
 class ASHFOREST_API AAshForestProjectile : public AActor
 {
@@ -31,6 +89,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Projectile)
 		void InitProjectile(APawn* FromInstigator);
 
+	virtual void Tick(float DeltaTime) override;
+
+	/** Spawns the authoritative copy on the server/standalone, or a simulated one on clients. Fills in the id on the server */
+	static AAshForestProjectile* SpawnFromParams(UWorld* World, UClass* ProjectileClass, APawn* FromInstigator, FAshProjectileSpawnParams & Params);
+
+	static AAshForestProjectile* FindByNetId(UWorld* World, const uint16 ProjectileId);
+
+	static void LogNetStats();
+
 protected:
 
 	// Called when the game starts or when spawned
@@ -40,7 +107,9 @@ protected:
 		float ProjectileDamage;
 
 	UPROPERTY(EditDefaultsOnly, Category = Projectile)
-		UParticleSystem* ExplosionVFX;
+		TSoftObjectPtr<UParticleSystem> ExplosionVFX;
+
+	TSharedPtr<FStreamableHandle> ExplosionVFXHandle;
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = Projectile)
 		bool IgnoreProjectileHit(const FHitResult & ForHit);
@@ -48,6 +117,16 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = Projectile)
 		void OnProjectileExplode(const FHitResult & ExplodeFromHit);
 
+	/** False for the copies clients simulate from spawn params, those never apply damage */
+	UPROPERTY(BlueprintReadOnly, Transient, Category = Projectile)
+		bool bIsAuthoritativeCopy;
+
+	uint16 NetProjectileId;
+	uint8 LastDeflectEventId;
+
+	/** Recent positions of the server copy, used to rewind to the time a client saw a deflection */
+	TAshRewindHistory<FVector> PositionHistory;
+
 public:	
 
 	UFUNCTION(BlueprintCallable, Category = Projectile) FORCEINLINE
@@ -59,6 +138,18 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category = Projectile)
 		void OnDeflected(AActor* DeflectedByActor, const FVector & DeflectedVelocity);
 
+	FORCEINLINE bool IsAuthoritativeCopy() const { return bIsAuthoritativeCopy; }
+	FORCEINLINE uint16 GetNetProjectileId() const { return NetProjectileId; }
+
+	/** Where the server copy was at the given server time, clamped to the recorded history */
+	FVector GetRewoundLocation(const float ServerTime) const;
+
+	/** Server: builds the event for a deflection that was just applied */
+	FAshProjectileDeflectEvent MakeDeflectEvent(APawn* Deflector);
+
+	/** Client: snaps the simulated copy to the server's deflection, events older than the last applied one are dropped */
+	void ApplyDeflectEvent(const FAshProjectileDeflectEvent & Event);
+
 	UFUNCTION()
 		void OnProjectileHit(UPrimitiveComponent * HitComponent, AActor * OtherActor, UPrimitiveComponent * OtherComp, FVector NormalImpulse, const FHitResult & Hit);
 };
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Interpolates two rewind samples, sample types FMath::Lerp can't handle provide their own overload */
+template<typename SampleType>
+FORCEINLINE SampleType AshLerpRewindSample(const SampleType & A, const SampleType & B, const float Alpha)
+{
+	return FMath::Lerp(A, B, Alpha);
+}
+
+/**
+ * Server side ring buffer of timestamped samples, used to rewind an actor to the time a client saw something happen.
+ * Samples are taken at most every Interval, once full the oldest one is overwritten.
+ */
+template<typename SampleType, int32 MaxSamples = 16>
+class TAshRewindHistory
+{
+public:
+	TAshRewindHistory()
+		: Head(0)
+	{}
+
+	/** Adds Sample unless the newest one is less than Interval old */
+	void Record(const float Time, const SampleType & Sample, const float Interval)
+	{
+		if (Samples.Num() > 0 && Time - Samples[GetNewestIndex()].Time < Interval)
+			return;
+
+		if (Samples.Num() < MaxSamples)
+		{
+			Samples.Add({ Time, Sample });
+			return;
+		}
+
+		Samples[Head] = { Time, Sample };
+		Head = (Head + 1) % MaxSamples;
+	}
+
+	/** Head is the oldest sample once the ring is full */
+	FORCEINLINE int32 GetOldestIndex() const { return Samples.Num() < MaxSamples ? 0 : Head; }
+	FORCEINLINE int32 GetNewestIndex() const { return (GetOldestIndex() + Samples.Num() - 1) % Samples.Num(); }
+	FORCEINLINE int32 Num() const { return Samples.Num(); }
+
+	/** Sample at Time, lerped between the two around it and clamped to the oldest. False if empty or Time is past the newest, the caller's current state is the better answer then */
+	bool GetAtTime(const float Time, SampleType & OutSample) const
+	{
+		const int32 numSamples = Samples.Num();
+		if (numSamples == 0)
+			return false;
+
+		const int32 oldestIndex = GetOldestIndex();
+
+		if (Time <= Samples[oldestIndex].Time)
+		{
+			OutSample = Samples[oldestIndex].Sample;
+			return true;
+		}
+
+		for (int32 i = 1; i < numSamples; i++)
+		{
+			const auto& prev = Samples[(oldestIndex + i - 1) % numSamples];
+			const auto& next = Samples[(oldestIndex + i) % numSamples];
+
+			if (Time <= next.Time)
+			{
+				OutSample = AshLerpRewindSample(prev.Sample, next.Sample, (Time - prev.Time) / FMath::Max(next.Time - prev.Time, KINDA_SMALL_NUMBER));
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	struct FTimedSample
+	{
+		float Time;
+		SampleType Sample;
+	};
+
+	TArray<FTimedSample, TInlineAllocator<MaxSamples>> Samples;
+	int32 Head;
+};
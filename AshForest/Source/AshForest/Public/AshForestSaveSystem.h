@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "AshForestLevelSnapshot.h"
+
+class UWorld;
+
+/** Everything a save holds. Filled in on the game thread, only ever read by one worker after that */
+struct FAshSaveData
+{
+	FString MapName;
+	FString CheckpointKey;
+	int32 CheckpointIndex;
+	int32 SmolMoniez;
+	int32 BigUnitMoniez;
+
+	/** One per snapshot record, see FAshForestLevelSnapshot::GetActorKey */
+	TArray<FString> ActorKeys;
+	FAshForestLevelSnapshot Snapshot;
+
+	FAshSaveData()
+		: CheckpointIndex(-1), SmolMoniez(0), BigUnitMoniez(0)
+	{}
+
+	friend FArchive& operator<<(FArchive& Ar, FAshSaveData& Data);
+};
+
+/**
+ * Persists checkpoint progress, money and the checkpoint level snapshot, one file per map under Saved/SaveGames.
+ * RequestSave only copies state on the game thread; serializing, compressing and writing happen on a worker and the
+ * file is written to a .tmp first and atomically renamed over the old one, so a crash mid-write never leaves a broken save.
+ * If the rename itself never happened, loading picks up a complete .tmp.
+ * Loading starts on PreLoadMap and is applied once the map has a player. Game thread only, Update runs every world tick.
+ */
+class ASHFOREST_API FAshSaveSystem
+{
+public:
+	static FAshSaveSystem & Get();
+
+	/** Copies the player's progress and the game mode's checkpoint snapshot, a save already in flight makes this one wait */
+	void RequestSave(UWorld* World);
+
+	/** Starts reading the save for MapName in the background */
+	void BeginLoad(const FString & MapName);
+
+	/** Collects finished saves and loads, and applies a loaded save to World once its player exists */
+	void Update(UWorld* World);
+
+	/** Blocks until the save in flight and any save queued behind it are on disk */
+	void Flush();
+
+	/** Debug check behind AshForest.SaveCheck: the snapshot round trip of FAshForestLevelSnapshot::VerifyRoundTrip, through a real save file. Returns the values that didn't survive */
+	static int32 VerifySaveRoundTrip(UWorld* World);
+
+	static FString GetSavePath(const FString & MapName);
+	static FString GetMapName(UWorld* World);
+
+	void LogStats() const;
+	void ResetStats();
+
+private:
+	FAshSaveSystem();
+
+	struct FSaveResult
+	{
+		bool bSuccess;
+		int32 UncompressedBytes;
+		int32 CompressedBytes;
+		double SerializeMs;
+		double CompressMs;
+		double WriteMs;
+
+		FSaveResult() : bSuccess(false), UncompressedBytes(0), CompressedBytes(0), SerializeMs(0.0), CompressMs(0.0), WriteMs(0.0) {}
+	};
+
+	struct FLoadResult
+	{
+		TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> Data;
+		double ReadMs;
+		double DecompressMs;
+		double DeserializeMs;
+
+		FLoadResult() : ReadMs(0.0), DecompressMs(0.0), DeserializeMs(0.0) {}
+	};
+
+	/** Worker side. Paths are worked out on the game thread and passed in */
+	static FSaveResult WriteSave(FAshSaveData & Data, const FString & Path);
+	static FLoadResult ReadSave(const FString & Path);
+
+	/** Renames From over To in one step, the old To stays whole until the new one replaces it */
+	static bool ReplaceFile(const FString & To, const FString & From);
+
+	void StartSave(TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> Data);
+
+	void RecordSaveResult(const FSaveResult & Result);
+
+	/** Returns false if the save's checkpoint isn't loaded yet */
+	bool ApplyLoad(UWorld* World, FAshSaveData & Data);
+
+	TFuture<FSaveResult> SaveInFlight;
+	TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> PendingSave;
+
+	TFuture<FLoadResult> LoadInFlight;
+	TSharedPtr<FAshSaveData, ESPMode::ThreadSafe> LoadedSave;
+	FString LoadingMapName;
+
+	/** The world the current load belongs to. A load started by PreLoadMap is unclaimed until that map's world first ticks */
+	TWeakObjectPtr<UWorld> LoadWorld;
+	bool bLoadUnclaimed;
+	double ApplyWaitStartTime;
+
+	uint64 TotalSaves;
+	uint64 TotalCoalesced;
+	uint64 TotalFailed;
+	uint64 TotalLoads;
+	double LastSnapshotMs;
+	double LastApplyMs;
+	FSaveResult LastSave;
+	FLoadResult LastLoad;
+};
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Async/Future.h"
+#include "WorldCollision.h"
+#include "AshForestScatter.generated.h"
+
+class UBoxComponent;
+class UStaticMesh;
+class UHierarchicalInstancedStaticMeshComponent;
+
+USTRUCT(BlueprintType)
+struct FAshScatterLayer
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		UStaticMesh* Mesh;
+
+	/** Instances per 10m x 10m */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		float Density;
+
+	/** Hard cap per cell whatever the density says */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		int32 MaxInstancesPerCell;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		float MinScale;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		float MaxScale;
+
+	/** Ground steeper than this gets nothing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		float MaxSlopeDegrees;
+
+	/** Tilt instances to the ground normal (grass) instead of keeping them upright (trees) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		bool bAlignToGround;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		bool bCollision;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		int32 CullStartDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		int32 CullEndDistance;
+
+	FAshScatterLayer()
+		: Mesh(NULL), Density(1.f), MaxInstancesPerCell(256), MinScale(.8f), MaxScale(1.2f), MaxSlopeDegrees(35.f)
+		, bAlignToGround(false), bCollision(false), CullStartDistance(0), CullEndDistance(0)
+	{}
+};
+
+/** A candidate made on a worker thread, placed on the ground with an async trace afterwards */
+struct FAshScatterPoint
+{
+	FVector2D Location;
+	float Yaw;
+	float Scale;
+	int32 LayerIndex;
+
+	/** Filled in by the ground trace */
+	FVector GroundLocation;
+	FVector GroundNormal;
+	bool bOnGround;
+};
+
+namespace EAshScatterCellState
+{
+	enum Type
+	{
+		EAshCell_GENERATING,
+		EAshCell_TRACING,
+		EAshCell_READY,
+		EAshCell_MAX
+	};
+}
+
+/**
+ * Seeded runtime scatter of trees/grass inside ScatterBounds, instead of instances saved in the map.
+ * The area is split into square cells that stream in around every player: candidate points are made on a worker thread
+ * (same seed, same result), dropped onto the ground with async traces and added to one HISM per layer per cell.
+ * Cells beyond StreamOutRadius of all players give their components back to a per-layer pool.
+ * Dedicated servers only build the layers with collision.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestScatter : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Category = "Scatter", VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+		UBoxComponent* ScatterBounds;
+
+public:
+	AAshForestScatter();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		TArray<FAshScatterLayer> Layers;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		int32 Seed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+		float CellSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter|Streaming")
+		float StreamInRadius;
+
+	/** Larger than StreamInRadius so cells on the edge don't thrash */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter|Streaming")
+		float StreamOutRadius;
+
+	/** Ground traces issued per frame across all cells */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scatter|Streaming")
+		int32 MaxTracesPerFrame;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scatter|Streaming")
+		TEnumAsByte<ECollisionChannel> GroundChannel;
+
+	struct FCellComponent
+	{
+		int32 LayerIndex;
+		UHierarchicalInstancedStaticMeshComponent* Component;
+	};
+
+	struct FCell
+	{
+		FIntPoint Coord;
+		TEnumAsByte<EAshScatterCellState::Type> State;
+		TFuture<TArray<FAshScatterPoint>> Generation;
+		TArray<FAshScatterPoint> Points;
+		int32 NextTraceIndex;
+		int32 NumTracesDone;
+		TArray<FCellComponent, TInlineAllocator<4>> Components;
+		double GenerateStartTime;
+
+		/** Bound with Coord, so results go back to this cell even when a point sits on the border to the next one */
+		FTraceDelegate GroundTraceDelegate;
+	};
+
+	TMap<FIntPoint, TSharedPtr<FCell>> Cells;
+
+	/** Free components per layer */
+	TArray<TArray<UHierarchicalInstancedStaticMeshComponent*>> ComponentPool;
+
+	/** Keeps pooled and in-use components referenced */
+	UPROPERTY(Transient)
+		TArray<UHierarchicalInstancedStaticMeshComponent*> AllComponents;
+
+	FBox ScatterBox;
+
+	int32 TotalInstances;
+	int32 NumReadyCells;
+	double WorstCellMs;
+
+	/** Players' pawn locations, reused every tick */
+	TArray<FVector2D, TInlineAllocator<4>> ViewerLocations;
+
+	void UpdateStreaming();
+	void StartCell(const FIntPoint & Coord);
+	void ReleaseCell(FCell & Cell);
+	void TickCell(FCell & Cell, int32 & TraceBudget);
+	void BuildCell(FCell & Cell);
+	UHierarchicalInstancedStaticMeshComponent* GetComponent(const int32 LayerIndex);
+	FBox2D GetCellBox(const FIntPoint & Coord) const;
+
+	/** Async trace results only live for a frame, so they're copied into their point as soon as they come in */
+	void OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Data, FIntPoint Coord);
+
+	static TArray<FAshScatterPoint> GeneratePoints(const FBox2D CellBox, const FIntPoint Coord, const int32 InSeed, const TArray<FAshScatterLayer> & InLayers);
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Scatter")
+		void LogScatterStats() const;
+};
@@ -37,6 +37,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Lock On")
 		FName TargetableComponentName;
 
@@ -49,10 +52,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trigger")
 		TArray<AActor*> TriggeredByActorsDestruction;
 
-	UPROPERTY(BlueprintReadOnly, Transient, Category = "Trigger")
+	UPROPERTY(BlueprintReadOnly, Transient, SaveGame, Replicated, Category = "Trigger")
 		bool bTriggerEnabled;
 
-	UPROPERTY(BlueprintReadOnly, Transient, Category = "Trigger")
+	UPROPERTY(BlueprintReadOnly, Transient, SaveGame, Category = "Trigger")
 		TArray<AActor*> CurrentTriggeredByActors;
 
 	UFUNCTION(BlueprintCallable, Category = "Trigger")
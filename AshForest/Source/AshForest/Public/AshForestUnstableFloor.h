@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AshForestUnstableFloor.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+namespace EAshFloorTileState
+{
+	enum Type
+	{
+		EAshTile_STABLE,
+		EAshTile_CRUMBLING,
+		EAshTile_COLLAPSED,
+		EAshTile_MAX
+	};
+}
+
+struct FAshFloorTile
+{
+	TEnumAsByte<EAshFloorTileState::Type> State;
+	float TimeLeft;
+
+	FAshFloorTile()
+		: State(EAshFloorTileState::EAshTile_STABLE), TimeLeft(0.f)
+	{}
+};
+
+/**
+ * A section of collapsing floor, every tile is an instance of TileComp (e.g. 1M_Cube) instead of its own actor.
+ * Standing on a tile is read from the player's CMC floor result, so tiles raise no hit or overlap events. Tiles shake for
+ * CollapseDelay, drop out (parked below the floor) and optionally come back after RespawnDelay. Debris comes from a pool.
+ * Floors don't tick, FAshUnstableFloors updates every floor with crumbling or collapsed tiles in one pass per frame.
+ */
+UCLASS()
+class ASHFOREST_API AAshForestUnstableFloor : public AActor
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Category = "Unstable Floor", VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+		UInstancedStaticMeshComponent* TileComp;
+
+public:
+	AAshForestUnstableFloor();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+
+	/** Seconds between a tile first being stood on and it dropping out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unstable Floor")
+		float CollapseDelay;
+
+	/** Seconds a collapsed tile stays gone, never comes back if <= 0 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unstable Floor")
+		float RespawnDelay;
+
+	/** How far crumbling tiles jitter around their rest position */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unstable Floor")
+		float CrumbleShakeAmount;
+
+	/** Where collapsed tiles are parked, relative to their rest position */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Unstable Floor")
+		FVector CollapsedOffset;
+
+	/** Spawned hidden up front and moved to each collapsing tile, e.g. a physics chunk or particle Blueprint */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Unstable Floor|Debris")
+		TSubclassOf<AActor> DebrisClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Unstable Floor|Debris")
+		int32 DebrisPoolSize;
+
+	/** Seconds debris stays visible before going back to the pool */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Unstable Floor|Debris")
+		float DebrisLifetime;
+
+	UPROPERTY(Transient)
+		TArray<AActor*> DebrisPool;
+
+	TArray<float> DebrisTimeLeft;
+	int32 NextDebrisIndex;
+
+	TArray<FAshFloorTile> Tiles;
+	TArray<FTransform> TileRestTransforms;
+
+	/** Indices of tiles that aren't STABLE, the only ones the batched update looks at */
+	TArray<int32> ActiveTiles;
+	int32 NumActiveDebris;
+
+	void SetTileTransform(const int32 TileIndex, const FTransform & LocalTransform);
+	void CollapseTile(const int32 TileIndex);
+	void RestoreTile(const int32 TileIndex);
+	void SpawnDebris(const int32 TileIndex);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Unstable Floor")
+		void OnTileCollapsed(const int32 TileIndex, const FVector & TileLocation);
+
+public:
+
+	/** Starts the tile's collapse timer if it's stable */
+	void NotifyStoodOn(const int32 TileIndex);
+
+	/** Advances crumbling tiles and debris, returns false once nothing is left to update */
+	bool UpdateTiles(const float DeltaTime);
+
+	FORCEINLINE bool HasActiveTiles() const { return ActiveTiles.Num() > 0 || NumActiveDebris > 0; }
+	FORCEINLINE UInstancedStaticMeshComponent* GetTileComponent() const { return TileComp; }
+
+	/** Puts every tile back, e.g. after respawning at a checkpoint */
+	UFUNCTION(BlueprintCallable, Category = "Unstable Floor")
+		void ResetAllTiles();
+};
+
+/**
+ * Finds which unstable floor tile each player is standing on and updates all floors with active tiles, once per frame.
+ * Game thread only.
+ */
+class ASHFOREST_API FAshUnstableFloors
+{
+public:
+	static FAshUnstableFloors & Get();
+
+	void Register(AAshForestUnstableFloor* Floor);
+	void Unregister(AAshForestUnstableFloor* Floor);
+
+	/** Called from the module after the world's actors (and their movement) have ticked */
+	void Update(UWorld* World, const float DeltaSeconds);
+
+	void LogStats() const;
+
+	uint64 TotalCollapses;
+
+private:
+	FAshUnstableFloors();
+
+	TArray<TWeakObjectPtr<AAshForestUnstableFloor>> ActiveFloors;
+	int32 NumRegistered;
+};
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "AshForestUserWidget.generated.h"
+
+class UInvalidationBox;
+class AAshForestCharacter;
+
+/**
+ * Base for HUD widgets that are driven by gameplay events instead of per-frame property bindings.
+ * Wrap the widget's content in an InvalidationBox named InvalidationRoot and it is only repainted when MarkContentChanged is called.
+ */
+UCLASS()
+class ASHFOREST_API UAshForestUserWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD", meta = (BindWidgetOptional))
+		UInvalidationBox* InvalidationRoot;
+
+	UFUNCTION(BlueprintCallable, Category = "HUD")
+		void MarkContentChanged();
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+		AAshForestCharacter* GetOwningAshCharacter() const;
+};
@@ -7,6 +7,9 @@
 #include "TargetableInterface.h"
 #include "DamageableCharacter.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDamageableRetiredSignature, AActor*, RetiredActor);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnHealthChangedSignature, ADamageableCharacter*, Character, float, NewHealth, float, MaxHealth);
+
 UCLASS()
 class ASHFOREST_API ADamageableCharacter : public ACharacter, public ITargetableInterface
 {
@@ -17,7 +20,7 @@ class ASHFOREST_API ADamageableCharacter : public ACharacter, public ITargetable
 
 public:
 	// Sets default values for this character's properties
-	ADamageableCharacter();
+	ADamageableCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	virtual void FellOutOfWorld(const class UDamageType& dmgType) override;
 
@@ -31,11 +34,44 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Health")
 		float MaxHealth;
 
-	UPROPERTY(BlueprintReadOnly, Category = "Health")
+	UPROPERTY(BlueprintReadOnly, SaveGame, Category = "Health")
 		float CurrentHealth;
 
+	/** Dying hides and disables this character instead of destroying it, so checkpoint restores and pools can bring it back */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Health")
+		bool bRetireOnDeath;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Health")
+		bool bIsRetired;
+
+	/** All health writes go through here so OnHealthChanged only fires on actual changes */
+	UFUNCTION(BlueprintCallable, Category = "Health")
+		void SetCurrentHealth(const float NewHealth);
+
 public:	
 
+	/** Fired when a character with bRetireOnDeath dies, in place of OnDestroyed */
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+		FOnDamageableRetiredSignature OnRetired;
+
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+		FOnHealthChangedSignature OnHealthChanged;
+
+	UFUNCTION(BlueprintPure, Category = "Health") FORCEINLINE
+		float GetCurrentHealth() const { return CurrentHealth; };
+
+	UFUNCTION(BlueprintPure, Category = "Health") FORCEINLINE
+		float GetMaxHealth() const { return MaxHealth; };
+
+	UFUNCTION(BlueprintCallable, Category = "Health")
+		virtual void Retire();
+
+	UFUNCTION(BlueprintCallable, Category = "Health")
+		virtual void Revive();
+
+	UFUNCTION(BlueprintPure, Category = "Health") FORCEINLINE
+		bool IsRetired() const { return bIsRetired; };
+
 //AS: ITargetable Interface START ======================================================================================================================
 	virtual bool GetTargetableComponents_Implementation(TArray<USceneComponent*> & TargetableComps) override;
 	virtual bool CanBeTargeted_Implementation(const AActor* ByActor) override;
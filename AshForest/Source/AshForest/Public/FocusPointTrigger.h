@@ -2,10 +2,11 @@
 
 #include "CoreMinimal.h"
 #include "Engine/TriggerBox.h"
+#include "AshForestPlayerVolumes.h"
 #include "FocusPointTrigger.generated.h"
 
 UCLASS()
-class ASHFOREST_API AFocusPointTrigger : public ATriggerBox
+class ASHFOREST_API AFocusPointTrigger : public ATriggerBox, public IAshPlayerVolumeListener
 {
 	GENERATED_BODY()
 
@@ -39,9 +40,9 @@ public:
 	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "Focusable")
 	bool bOnlyAllowFocusingWithinTrigger;
 
-	UFUNCTION()
-	void OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor);
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	UFUNCTION()
-	void OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor);
+	virtual void OnPlayerEnterVolume(AAshForestCharacter* Player) override;
+	virtual void OnPlayerExitVolume(AAshForestCharacter* Player) override;
 };